@@ -16,8 +16,11 @@
 
 //#define LOG_NDEBUG 0
 #define LOG_TAG "SimpleC2Component"
+#define ATRACE_TAG ATRACE_TAG_VIDEO
 #include <log/log.h>
+#include <utils/Trace.h>
 
+#include <android-base/stringprintf.h>
 #include <android/hardware_buffer.h>
 #include <cutils/properties.h>
 #include <media/stagefright/foundation/AMessage.h>
@@ -26,6 +29,8 @@
 #include <inttypes.h>
 #include <libyuv.h>
 
+#include <algorithm>
+
 #include <C2Config.h>
 #include <C2Debug.h>
 #include <C2PlatformSupport.h>
@@ -33,6 +38,8 @@
 #include <Codec2CommonUtils.h>
 #include <SimpleC2Component.h>
 
+#include "SimpleC2RowConversion.h"
+
 namespace android {
 
 // libyuv version required for I410ToAB30Matrix and I210ToAB30Matrix.
@@ -51,98 +58,52 @@ void convertYUV420Planar8ToYV12(uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, con
                                 size_t srcUStride, size_t srcVStride, size_t dstYStride,
                                 size_t dstUStride, size_t dstVStride, uint32_t width,
                                 uint32_t height, bool isMonochrome) {
-    for (size_t i = 0; i < height; ++i) {
-        memcpy(dstY, srcY, width);
-        srcY += srcYStride;
-        dstY += dstYStride;
-    }
-
-    if (isMonochrome) {
-        // Fill with neutral U/V values.
-        for (size_t i = 0; i < (height + 1) / 2; ++i) {
-            memset(dstV, kNeutralUVBitDepth8, (width + 1) / 2);
-            memset(dstU, kNeutralUVBitDepth8, (width + 1) / 2);
-            dstV += dstVStride;
-            dstU += dstUStride;
+    ForEachRowRange(width, height, 2, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            memcpy(dstY + i * dstYStride, srcY + i * srcYStride, width);
         }
-        return;
-    }
-
-    for (size_t i = 0; i < (height + 1) / 2; ++i) {
-        memcpy(dstV, srcV, (width + 1) / 2);
-        srcV += srcVStride;
-        dstV += dstVStride;
-    }
 
-    for (size_t i = 0; i < (height + 1) / 2; ++i) {
-        memcpy(dstU, srcU, (width + 1) / 2);
-        srcU += srcUStride;
-        dstU += dstUStride;
-    }
+        for (size_t i = begin / 2; i < (end + 1) / 2; ++i) {
+            if (isMonochrome) {
+                // Fill with neutral U/V values.
+                memset(dstV + i * dstVStride, kNeutralUVBitDepth8, (width + 1) / 2);
+                memset(dstU + i * dstUStride, kNeutralUVBitDepth8, (width + 1) / 2);
+            } else {
+                memcpy(dstV + i * dstVStride, srcV + i * srcVStride, (width + 1) / 2);
+                memcpy(dstU + i * dstUStride, srcU + i * srcUStride, (width + 1) / 2);
+            }
+        }
+    });
 }
 
 void convertYUV420Planar16ToY410(uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
                                  const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
                                  size_t srcVStride, size_t dstStride, size_t width, size_t height) {
+    const RowConverters &converters = GetRowConverters();
     // Converting two lines at a time, slightly faster
-    for (size_t y = 0; y < height; y += 2) {
-        uint32_t *dstTop = (uint32_t *)dst;
-        uint32_t *dstBot = (uint32_t *)(dst + dstStride);
-        uint16_t *ySrcTop = (uint16_t *)srcY;
-        uint16_t *ySrcBot = (uint16_t *)(srcY + srcYStride);
-        uint16_t *uSrc = (uint16_t *)srcU;
-        uint16_t *vSrc = (uint16_t *)srcV;
-
-        uint32_t u01, v01, y01, y23, y45, y67, uv0, uv1;
-        size_t x = 0;
-        for (; x < width - 3; x += 4) {
-            u01 = *((uint32_t *)uSrc);
-            uSrc += 2;
-            v01 = *((uint32_t *)vSrc);
-            vSrc += 2;
-
-            y01 = *((uint32_t *)ySrcTop);
-            ySrcTop += 2;
-            y23 = *((uint32_t *)ySrcTop);
-            ySrcTop += 2;
-            y45 = *((uint32_t *)ySrcBot);
-            ySrcBot += 2;
-            y67 = *((uint32_t *)ySrcBot);
-            ySrcBot += 2;
-
-            uv0 = (u01 & 0x3FF) | ((v01 & 0x3FF) << 20);
-            uv1 = (u01 >> 16) | ((v01 >> 16) << 20);
-
-            *dstTop++ = 3 << 30 | ((y01 & 0x3FF) << 10) | uv0;
-            *dstTop++ = 3 << 30 | ((y01 >> 16) << 10) | uv0;
-            *dstTop++ = 3 << 30 | ((y23 & 0x3FF) << 10) | uv1;
-            *dstTop++ = 3 << 30 | ((y23 >> 16) << 10) | uv1;
-
-            *dstBot++ = 3 << 30 | ((y45 & 0x3FF) << 10) | uv0;
-            *dstBot++ = 3 << 30 | ((y45 >> 16) << 10) | uv0;
-            *dstBot++ = 3 << 30 | ((y67 & 0x3FF) << 10) | uv1;
-            *dstBot++ = 3 << 30 | ((y67 >> 16) << 10) | uv1;
-        }
-
-        // There should be at most 2 more pixels to process. Note that we don't
-        // need to consider odd case as the buffer is always aligned to even.
-        if (x < width) {
-            u01 = *uSrc;
-            v01 = *vSrc;
-            y01 = *((uint32_t *)ySrcTop);
-            y45 = *((uint32_t *)ySrcBot);
-            uv0 = (u01 & 0x3FF) | ((v01 & 0x3FF) << 20);
-            *dstTop++ = ((y01 & 0x3FF) << 10) | uv0;
-            *dstTop++ = ((y01 >> 16) << 10) | uv0;
-            *dstBot++ = ((y45 & 0x3FF) << 10) | uv0;
-            *dstBot++ = ((y45 >> 16) << 10) | uv0;
+    ForEachRowRange(width, height, 2, [=, &converters](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y += 2) {
+            uint32_t *dstTop = dst + y * dstStride;
+            uint32_t *dstBot = dstTop + dstStride;
+            const uint16_t *ySrcTop = srcY + y * srcYStride;
+            const uint16_t *ySrcBot = ySrcTop + srcYStride;
+            const uint16_t *uSrc = srcU + y / 2 * srcUStride;
+            const uint16_t *vSrc = srcV + y / 2 * srcVStride;
+
+            size_t x = width & ~(size_t)3;
+            converters.rowPairToY410(dstTop, dstBot, ySrcTop, ySrcBot, uSrc, vSrc, x);
+
+            // There should be at most 2 more pixels to process. Note that we don't
+            // need to consider odd case as the buffer is always aligned to even.
+            if (x < width) {
+                uint32_t uv0 = (uSrc[x / 2] & 0x3FF) | ((vSrc[x / 2] & 0x3FF) << 20);
+                dstTop[x] = ((ySrcTop[x] & 0x3FF) << 10) | uv0;
+                dstTop[x + 1] = ((uint32_t)ySrcTop[x + 1] << 10) | uv0;
+                dstBot[x] = ((ySrcBot[x] & 0x3FF) << 10) | uv0;
+                dstBot[x + 1] = ((uint32_t)ySrcBot[x + 1] << 10) | uv0;
+            }
         }
-
-        srcY += srcYStride * 2;
-        srcU += srcUStride;
-        srcV += srcVStride;
-        dst += dstStride * 2;
-    }
+    });
 }
 
 namespace {
@@ -198,12 +159,6 @@ static C2ColorAspectsStruct FillMissingColorAspects(
     return _aspects;
 }
 
-// matrix conversion coefficients
-// (see media/libstagefright/colorconverter/ColorConverter.cpp for more details)
-struct Coeffs {
-    int32_t _y, _r_v, _g_u, _g_v, _b_u, _c16;
-};
-
 static const struct Coeffs GetCoeffsForAspects(const C2ColorAspectsStruct &aspects) {
     bool isFullRange = aspects.range == C2Color::RANGE_FULL;
 
@@ -257,86 +212,18 @@ void convertYUV420Planar16ToRGBA1010102(
 
     struct Coeffs coeffs = GetCoeffsForAspects(_aspects);
 
-    int32_t _y = coeffs._y;
-    int32_t _b_u = coeffs._b_u;
-    int32_t _neg_g_u = -coeffs._g_u;
-    int32_t _neg_g_v = -coeffs._g_v;
-    int32_t _r_v = coeffs._r_v;
-    int32_t _c16 = coeffs._c16;
-
+    const RowConverters &converters = GetRowConverters();
     // Converting two lines at a time, slightly faster
-    for (size_t y = 0; y < height; y += 2) {
-        uint32_t *dstTop = (uint32_t *)dst;
-        uint32_t *dstBot = (uint32_t *)(dst + dstStride);
-        uint16_t *ySrcTop = (uint16_t *)srcY;
-        uint16_t *ySrcBot = (uint16_t *)(srcY + srcYStride);
-        uint16_t *uSrc = (uint16_t *)srcU;
-        uint16_t *vSrc = (uint16_t *)srcV;
-
-        for (size_t x = 0; x < width; x += 2) {
-            int32_t u, v, y00, y01, y10, y11;
-            u = *uSrc - 512;
-            uSrc += 1;
-            v = *vSrc - 512;
-            vSrc += 1;
-
-            y00 = *ySrcTop - _c16;
-            ySrcTop += 1;
-            y01 = *ySrcTop - _c16;
-            ySrcTop += 1;
-            y10 = *ySrcBot - _c16;
-            ySrcBot += 1;
-            y11 = *ySrcBot - _c16;
-            ySrcBot += 1;
-
-            int32_t u_b = u * _b_u;
-            int32_t u_g = u * _neg_g_u;
-            int32_t v_g = v * _neg_g_v;
-            int32_t v_r = v * _r_v;
-
-            int32_t yMult, b, g, r;
-            yMult = y00 * _y + 512;
-            b = (yMult + u_b) / 1024;
-            g = (yMult + v_g + u_g) / 1024;
-            r = (yMult + v_r) / 1024;
-            b = CLIP3(0, b, 1023);
-            g = CLIP3(0, g, 1023);
-            r = CLIP3(0, r, 1023);
-            *dstTop++ = 3 << 30 | (b << 20) | (g << 10) | r;
-
-            yMult = y01 * _y + 512;
-            b = (yMult + u_b) / 1024;
-            g = (yMult + v_g + u_g) / 1024;
-            r = (yMult + v_r) / 1024;
-            b = CLIP3(0, b, 1023);
-            g = CLIP3(0, g, 1023);
-            r = CLIP3(0, r, 1023);
-            *dstTop++ = 3 << 30 | (b << 20) | (g << 10) | r;
-
-            yMult = y10 * _y + 512;
-            b = (yMult + u_b) / 1024;
-            g = (yMult + v_g + u_g) / 1024;
-            r = (yMult + v_r) / 1024;
-            b = CLIP3(0, b, 1023);
-            g = CLIP3(0, g, 1023);
-            r = CLIP3(0, r, 1023);
-            *dstBot++ = 3 << 30 | (b << 20) | (g << 10) | r;
-
-            yMult = y11 * _y + 512;
-            b = (yMult + u_b) / 1024;
-            g = (yMult + v_g + u_g) / 1024;
-            r = (yMult + v_r) / 1024;
-            b = CLIP3(0, b, 1023);
-            g = CLIP3(0, g, 1023);
-            r = CLIP3(0, r, 1023);
-            *dstBot++ = 3 << 30 | (b << 20) | (g << 10) | r;
+    ForEachRowRange(width, height, 2, [=, &converters, &coeffs](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y += 2) {
+            uint32_t *dstTop = dst + y * dstStride;
+            const uint16_t *ySrcTop = srcY + y * srcYStride;
+            converters.rowPairToRGBA1010102(
+                    dstTop, dstTop + dstStride, ySrcTop, ySrcTop + srcYStride,
+                    srcU + y / 2 * srcUStride, srcV + y / 2 * srcVStride, (width + 1) & ~(size_t)1,
+                    coeffs);
         }
-
-        srcY += srcYStride * 2;
-        srcU += srcUStride;
-        srcV += srcVStride;
-        dst += dstStride * 2;
-    }
+    });
 }
 
 void convertYUV420Planar16ToY410OrRGBA1010102(
@@ -359,35 +246,25 @@ void convertYUV420Planar16ToYV12(uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, co
                                  size_t srcUStride, size_t srcVStride, size_t dstYStride,
                                  size_t dstUVStride, size_t width, size_t height,
                                  bool isMonochrome) {
-    for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-            dstY[x] = (uint8_t)(srcY[x] >> 2);
+    const RowConverters &converters = GetRowConverters();
+    ForEachRowRange(width, height, 2, [=, &converters](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            converters.planar16To8(dstY + y * dstYStride, srcY + y * srcYStride, width);
         }
-        srcY += srcYStride;
-        dstY += dstYStride;
-    }
 
-    if (isMonochrome) {
-        // Fill with neutral U/V values.
-        for (size_t y = 0; y < (height + 1) / 2; ++y) {
-            memset(dstV, kNeutralUVBitDepth8, (width + 1) / 2);
-            memset(dstU, kNeutralUVBitDepth8, (width + 1) / 2);
-            dstV += dstUVStride;
-            dstU += dstUVStride;
-        }
-        return;
-    }
-
-    for (size_t y = 0; y < (height + 1) / 2; ++y) {
-        for (size_t x = 0; x < (width + 1) / 2; ++x) {
-            dstU[x] = (uint8_t)(srcU[x] >> 2);
-            dstV[x] = (uint8_t)(srcV[x] >> 2);
+        for (size_t y = begin / 2; y < (end + 1) / 2; ++y) {
+            if (isMonochrome) {
+                // Fill with neutral U/V values.
+                memset(dstV + y * dstUVStride, kNeutralUVBitDepth8, (width + 1) / 2);
+                memset(dstU + y * dstUVStride, kNeutralUVBitDepth8, (width + 1) / 2);
+            } else {
+                converters.planar16To8(dstU + y * dstUVStride, srcU + y * srcUStride,
+                                       (width + 1) / 2);
+                converters.planar16To8(dstV + y * dstUVStride, srcV + y * srcVStride,
+                                       (width + 1) / 2);
+            }
         }
-        srcU += srcUStride;
-        srcV += srcVStride;
-        dstU += dstUVStride;
-        dstV += dstUVStride;
-    }
+    });
 }
 
 void convertYUV420Planar16ToP010(uint16_t *dstY, uint16_t *dstUV, const uint16_t *srcY,
@@ -395,35 +272,23 @@ void convertYUV420Planar16ToP010(uint16_t *dstY, uint16_t *dstUV, const uint16_t
                                  size_t srcUStride, size_t srcVStride, size_t dstYStride,
                                  size_t dstUVStride, size_t width, size_t height,
                                  bool isMonochrome) {
-    for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-            dstY[x] = srcY[x] << 6;
+    const RowConverters &converters = GetRowConverters();
+    ForEachRowRange(width, height, 2, [=, &converters](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            converters.planar16ToMsb(dstY + y * dstYStride, srcY + y * srcYStride, width);
         }
-        srcY += srcYStride;
-        dstY += dstYStride;
-    }
 
-    if (isMonochrome) {
-        // Fill with neutral U/V values.
-        for (size_t y = 0; y < (height + 1) / 2; ++y) {
-            for (size_t x = 0; x < (width + 1) / 2; ++x) {
-                dstUV[2 * x] = kNeutralUVBitDepth10 << 6;
-                dstUV[2 * x + 1] = kNeutralUVBitDepth10 << 6;
+        for (size_t y = begin / 2; y < (end + 1) / 2; ++y) {
+            uint16_t *dstUVRow = dstUV + y * dstUVStride;
+            if (isMonochrome) {
+                // Fill with neutral U/V values.
+                std::fill_n(dstUVRow, 2 * ((width + 1) / 2), kNeutralUVBitDepth10 << 6);
+            } else {
+                converters.planar16ToInterleavedMsb(dstUVRow, srcU + y * srcUStride,
+                                                    srcV + y * srcVStride, (width + 1) / 2);
             }
-            dstUV += dstUVStride;
-        }
-        return;
-    }
-
-    for (size_t y = 0; y < (height + 1) / 2; ++y) {
-        for (size_t x = 0; x < (width + 1) / 2; ++x) {
-            dstUV[2 * x] = srcU[x] << 6;
-            dstUV[2 * x + 1] = srcV[x] << 6;
         }
-        srcU += srcUStride;
-        srcV += srcVStride;
-        dstUV += dstUVStride;
-    }
+    });
 }
 
 void convertP010ToYUV420Planar16(uint16_t *dstY, uint16_t *dstU, uint16_t *dstV,
@@ -666,75 +531,104 @@ void SimpleC2Component::WorkHandler::setComponent(
     mThiz = thiz;
 }
 
-static void Reply(const sp<AMessage> &msg, int32_t *err = nullptr) {
-    sp<AReplyToken> replyId;
-    CHECK(msg->senderAwaitsResponse(&replyId));
-    sp<AMessage> reply = new AMessage;
-    if (err) {
-        reply->setInt32("err", *err);
+void SimpleC2Component::WorkHandler::setSequence(
+        const std::shared_ptr<SimpleC2Executor::Sequence> &sequence) {
+    mSequence = sequence;
+}
+
+void SimpleC2Component::WorkHandler::post(int32_t what) {
+    if (!mSequence) {
+        (new AMessage(what, this))->post();
+        return;
     }
-    reply->postReply(replyId);
+    sp<WorkHandler> handler = this;
+    mSequence->post([handler, what] {
+        int32_t err = C2_OK;
+        if (handler->handle(what, &err)) {
+            handler->post(kWhatProcess);
+        }
+    });
+}
+
+int32_t SimpleC2Component::WorkHandler::postAndAwaitResponse(int32_t what) {
+    int32_t err = C2_OK;
+    if (!mSequence) {
+        sp<AMessage> reply;
+        (new AMessage(what, this))->postAndAwaitResponse(&reply);
+        CHECK(reply->findInt32("err", &err));
+        return err;
+    }
+    sp<WorkHandler> handler = this;
+    mSequence->postAndWait([handler, what, &err] {
+        if (handler->handle(what, &err)) {
+            handler->post(kWhatProcess);
+        }
+    });
+    return err;
 }
 
 void SimpleC2Component::WorkHandler::onMessageReceived(const sp<AMessage> &msg) {
+    int32_t err = C2_OK;
+    if (handle(msg->what(), &err)) {
+        (new AMessage(kWhatProcess, this))->post();
+    }
+    sp<AReplyToken> replyId;
+    if (msg->senderAwaitsResponse(&replyId)) {
+        sp<AMessage> reply = new AMessage;
+        reply->setInt32("err", err);
+        reply->postReply(replyId);
+    }
+}
+
+bool SimpleC2Component::WorkHandler::handle(int32_t what, int32_t *err) {
     std::shared_ptr<SimpleC2Component> thiz = mThiz.lock();
     if (!thiz) {
-        ALOGD("component not yet set; msg = %s", msg->debugString().c_str());
-        sp<AReplyToken> replyId;
-        if (msg->senderAwaitsResponse(&replyId)) {
-            sp<AMessage> reply = new AMessage;
-            reply->setInt32("err", C2_CORRUPTED);
-            reply->postReply(replyId);
-        }
-        return;
+        ALOGD("component not yet set; what = %d", what);
+        *err = C2_CORRUPTED;
+        return false;
     }
 
-    switch (msg->what()) {
+    switch (what) {
         case kWhatProcess: {
             if (mRunning) {
-                if (thiz->processQueue()) {
-                    (new AMessage(kWhatProcess, this))->post();
-                }
-            } else {
-                ALOGV("Ignore process message as we're not running");
+                return thiz->processQueue();
             }
+            ALOGV("Ignore process message as we're not running");
             break;
         }
         case kWhatInit: {
-            int32_t err = thiz->onInit();
-            Reply(msg, &err);
+            *err = thiz->onInit();
             [[fallthrough]];
         }
         case kWhatStart: {
+            thiz->updateProcessBatchSize();
             mRunning = true;
             break;
         }
         case kWhatStop: {
-            int32_t err = thiz->onStop();
+            *err = thiz->onStop();
             thiz->mOutputBlockPool.reset();
             mRunning = false;
-            Reply(msg, &err);
             break;
         }
         case kWhatReset: {
             thiz->onReset();
             thiz->mOutputBlockPool.reset();
             mRunning = false;
-            Reply(msg);
             break;
         }
         case kWhatRelease: {
             thiz->onRelease();
             thiz->mOutputBlockPool.reset();
             mRunning = false;
-            Reply(msg);
             break;
         }
         default: {
-            ALOGD("Unrecognized msg: %d", msg->what());
+            ALOGD("Unrecognized msg: %d", what);
             break;
         }
     }
+    return false;
 }
 
 class SimpleC2Component::BlockingBlockPool : public C2BlockPool {
@@ -801,16 +695,32 @@ SimpleC2Component::SimpleC2Component(
         const std::shared_ptr<C2ComponentInterface> &intf)
     : mDummyReadView(DummyReadView()),
       mIntf(intf),
-      mLooper(new ALooper),
-      mHandler(new WorkHandler) {
+      mHandler(new WorkHandler),
+      mProcessBatchSize(1u),
+      mBatching(false) {
+    // Only audio components share the executor; video components wait in process() for the
+    // consumer to return graphic blocks and would hold a shared worker meanwhile.
+    C2ComponentDomainSetting domain;
+    c2_status_t err = intf->query_vb({ &domain }, {}, C2_DONT_BLOCK, nullptr);
+    SimpleC2Executor *executor = nullptr;
+    if (err == C2_OK && domain.value == C2Component::DOMAIN_AUDIO) {
+        executor = SimpleC2Executor::GetShared();
+    }
+    if (executor) {
+        mHandler->setSequence(executor->createSequence());
+        return;
+    }
+    mLooper = new ALooper;
     mLooper->setName(intf->getName().c_str());
     (void)mLooper->registerHandler(mHandler);
     mLooper->start(false, false, ANDROID_PRIORITY_VIDEO);
 }
 
 SimpleC2Component::~SimpleC2Component() {
-    mLooper->unregisterHandler(mHandler->id());
-    (void)mLooper->stop();
+    if (mLooper) {
+        mLooper->unregisterHandler(mHandler->id());
+        (void)mLooper->stop();
+    }
 }
 
 c2_status_t SimpleC2Component::setListener_vb(
@@ -848,7 +758,7 @@ c2_status_t SimpleC2Component::queue_nb(std::list<std::unique_ptr<C2Work>> * con
         }
     }
     if (queueWasEmpty) {
-        (new AMessage(WorkHandler::kWhatProcess, mHandler))->post();
+        mHandler->post(WorkHandler::kWhatProcess);
     }
     return C2_OK;
 }
@@ -903,7 +813,7 @@ c2_status_t SimpleC2Component::drain_nb(drain_mode_t drainMode) {
         queue->markDrain(drainMode);
     }
     if (queueWasEmpty) {
-        (new AMessage(WorkHandler::kWhatProcess, mHandler))->post();
+        mHandler->post(WorkHandler::kWhatProcess);
     }
 
     return C2_OK;
@@ -917,15 +827,12 @@ c2_status_t SimpleC2Component::start() {
     bool needsInit = (state->mState == UNINITIALIZED);
     state.unlock();
     if (needsInit) {
-        sp<AMessage> reply;
-        (new AMessage(WorkHandler::kWhatInit, mHandler))->postAndAwaitResponse(&reply);
-        int32_t err;
-        CHECK(reply->findInt32("err", &err));
+        int32_t err = mHandler->postAndAwaitResponse(WorkHandler::kWhatInit);
         if (err != C2_OK) {
             return (c2_status_t)err;
         }
     } else {
-        (new AMessage(WorkHandler::kWhatStart, mHandler))->post();
+        mHandler->post(WorkHandler::kWhatStart);
     }
     state.lock();
     state->mState = RUNNING;
@@ -946,10 +853,7 @@ c2_status_t SimpleC2Component::stop() {
         queue->clear();
         queue->pending().clear();
     }
-    sp<AMessage> reply;
-    (new AMessage(WorkHandler::kWhatStop, mHandler))->postAndAwaitResponse(&reply);
-    int32_t err;
-    CHECK(reply->findInt32("err", &err));
+    int32_t err = mHandler->postAndAwaitResponse(WorkHandler::kWhatStop);
     if (err != C2_OK) {
         return (c2_status_t)err;
     }
@@ -967,15 +871,13 @@ c2_status_t SimpleC2Component::reset() {
         queue->clear();
         queue->pending().clear();
     }
-    sp<AMessage> reply;
-    (new AMessage(WorkHandler::kWhatReset, mHandler))->postAndAwaitResponse(&reply);
+    (void)mHandler->postAndAwaitResponse(WorkHandler::kWhatReset);
     return C2_OK;
 }
 
 c2_status_t SimpleC2Component::release() {
     ALOGV("release");
-    sp<AMessage> reply;
-    (new AMessage(WorkHandler::kWhatRelease, mHandler))->postAndAwaitResponse(&reply);
+    (void)mHandler->postAndAwaitResponse(WorkHandler::kWhatRelease);
     return C2_OK;
 }
 
@@ -1007,8 +909,7 @@ void SimpleC2Component::finish(
     }
     if (work) {
         fillWork(work);
-        std::shared_ptr<C2Component::Listener> listener = mExecState.lock()->mListener;
-        listener->onWorkDone_nb(shared_from_this(), vec(work));
+        returnWork(std::move(work));
         ALOGV("returning pending work");
     }
 }
@@ -1033,13 +934,53 @@ void SimpleC2Component::cloneAndSend(
     work->worklets.emplace_back(new C2Worklet);
     if (work) {
         fillWork(work);
-        std::shared_ptr<C2Component::Listener> listener = mExecState.lock()->mListener;
-        listener->onWorkDone_nb(shared_from_this(), vec(work));
+        returnWork(std::move(work));
         ALOGV("cloned and sending work");
     }
 }
 
+void SimpleC2Component::returnWork(std::unique_ptr<C2Work> work) {
+    if (mBatching) {
+        mBatchedWork.push_back(std::move(work));
+        return;
+    }
+    std::shared_ptr<C2Component::Listener> listener = mExecState.lock()->mListener;
+    listener->onWorkDone_nb(shared_from_this(), vec(work));
+}
+
+void SimpleC2Component::returnBatchedWork() {
+    if (mBatchedWork.empty()) {
+        return;
+    }
+    std::list<std::unique_ptr<C2Work>> works;
+    works.swap(mBatchedWork);
+    std::shared_ptr<C2Component::Listener> listener = mExecState.lock()->mListener;
+    listener->onWorkDone_nb(shared_from_this(), std::move(works));
+}
+
+void SimpleC2Component::updateProcessBatchSize() {
+    C2ProcessBatchSizeTuning batchSize(1u);
+    c2_status_t err = intf()->query_vb({ &batchSize }, {}, C2_DONT_BLOCK, nullptr);
+    mProcessBatchSize = (err == C2_OK && batchSize.value > 1) ? batchSize.value : 1u;
+}
+
 bool SimpleC2Component::processQueue() {
+    if (mProcessBatchSize <= 1) {
+        return processWork();
+    }
+    // Process up to mProcessBatchSize works and return everything completed meanwhile, including
+    // pending work finished by process(), in one onWorkDone_nb() call.
+    mBatching = true;
+    bool hasQueuedWork = true;
+    for (uint32_t i = 0; i < mProcessBatchSize && hasQueuedWork; ++i) {
+        hasQueuedWork = processWork();
+    }
+    mBatching = false;
+    returnBatchedWork();
+    return hasQueuedWork;
+}
+
+bool SimpleC2Component::processWork() {
     std::unique_ptr<C2Work> work;
     uint64_t generation;
     int32_t drainMode;
@@ -1105,6 +1046,7 @@ bool SimpleC2Component::processQueue() {
             return err;
         }();
         if (err != C2_OK) {
+            returnBatchedWork();
             Mutexed<ExecState>::Locked state(mExecState);
             std::shared_ptr<C2Component::Listener> listener = state->mListener;
             state.unlock();
@@ -1116,6 +1058,7 @@ bool SimpleC2Component::processQueue() {
     if (!work) {
         c2_status_t err = drain(drainMode, mOutputBlockPool);
         if (err != C2_OK) {
+            returnBatchedWork();
             Mutexed<ExecState>::Locked state(mExecState);
             std::shared_ptr<C2Component::Listener> listener = state->mListener;
             state.unlock();
@@ -1135,6 +1078,7 @@ bool SimpleC2Component::processQueue() {
             std::vector<std::unique_ptr<C2SettingResult>> failures;
             c2_status_t err = intf()->config_vb(updates, C2_MAY_BLOCK, &failures);
             ALOGD("applied %zu configUpdates => %s (%d)", updates.size(), asString(err), err);
+            updateProcessBatchSize();
         }
     }
 
@@ -1146,7 +1090,16 @@ bool SimpleC2Component::processQueue() {
         ALOGD("Encountered null input buffer. Clearing the input buffer");
         work->input.buffers.clear();
     }
-    process(work, mOutputBlockPool);
+    {
+        // Named like the CCodecBufferChannel queue and onWorkDone slices, so a
+        // system trace joins the component stage with the client stages.
+        ScopedTrace trace(ATRACE_TAG, base::StringPrintf(
+                "SimpleC2Component::process(%s#%llu@ts=%lld)",
+                intf()->getName().c_str(),
+                (unsigned long long)work->input.ordinal.frameIndex.peeku(),
+                (long long)work->input.ordinal.timestamp.peekll()).c_str());
+        process(work, mOutputBlockPool);
+    }
     ALOGV("processed frame #%" PRIu64, work->input.ordinal.frameIndex.peeku());
     Mutexed<WorkQueue>::Locked queue(mWorkQueue);
     if (queue->generation() != generation) {
@@ -1155,19 +1108,13 @@ bool SimpleC2Component::processQueue() {
         work->result = C2_NOT_FOUND;
         queue.unlock();
 
-        Mutexed<ExecState>::Locked state(mExecState);
-        std::shared_ptr<C2Component::Listener> listener = state->mListener;
-        state.unlock();
-        listener->onWorkDone_nb(shared_from_this(), vec(work));
+        returnWork(std::move(work));
         return hasQueuedWork;
     }
     if (work->workletsProcessed != 0u) {
         queue.unlock();
-        Mutexed<ExecState>::Locked state(mExecState);
         ALOGV("returning this work");
-        std::shared_ptr<C2Component::Listener> listener = state->mListener;
-        state.unlock();
-        listener->onWorkDone_nb(shared_from_this(), vec(work));
+        returnWork(std::move(work));
     } else {
         ALOGV("queue pending work");
         work->input.buffers.clear();
@@ -1184,10 +1131,7 @@ bool SimpleC2Component::processQueue() {
         if (unexpected) {
             ALOGD("unexpected pending work");
             unexpected->result = C2_CORRUPTED;
-            Mutexed<ExecState>::Locked state(mExecState);
-            std::shared_ptr<C2Component::Listener> listener = state->mListener;
-            state.unlock();
-            listener->onWorkDone_nb(shared_from_this(), vec(unexpected));
+            returnWork(std::move(unexpected));
         }
     }
     return hasQueuedWork;
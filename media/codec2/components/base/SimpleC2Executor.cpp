@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SimpleC2Executor"
+#include <log/log.h>
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+
+#include <cutils/properties.h>
+#include <utils/AndroidThreads.h>
+#include <utils/ThreadDefs.h>
+
+#include <SimpleC2Executor.h>
+
+namespace android {
+
+namespace {
+
+// index of the worker running on this thread, or -1 on other threads
+thread_local ssize_t sWorkerIndex = -1;
+
+}  // namespace
+
+// static
+SimpleC2Executor *SimpleC2Executor::GetShared() {
+    // Never destroyed, so that detached workers and late component destruction do not race
+    // with static destructors.
+    static SimpleC2Executor *sExecutor = []() -> SimpleC2Executor * {
+        if (!property_get_bool("debug.codec2.sw_shared_executor", false)) {
+            return nullptr;
+        }
+        int32_t numThreads = property_get_int32("debug.codec2.sw_shared_executor_threads", 0);
+        if (numThreads <= 0) {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        ALOGI("software audio components share %d threads", numThreads);
+        return new SimpleC2Executor(numThreads, ANDROID_PRIORITY_AUDIO);
+    }();
+    return sExecutor;
+}
+
+SimpleC2Executor::SimpleC2Executor(size_t numThreads, int32_t priority)
+    : mPriority(priority),
+      mNumReady(0),
+      mNextWorker(0) {
+    for (size_t i = 0; i < numThreads; ++i) {
+        mWorkers.emplace_back(new Worker);
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        std::thread([this, i] { threadLoop(i); }).detach();
+    }
+}
+
+std::shared_ptr<SimpleC2Executor::Sequence> SimpleC2Executor::createSequence() {
+    return std::shared_ptr<Sequence>(new Sequence(this));
+}
+
+void SimpleC2Executor::schedule(std::shared_ptr<Sequence> sequence) {
+    // Keep sequences rescheduled by a worker on that worker, as their state is likely still
+    // in its cache; others are spread round-robin.
+    size_t ix;
+    {
+        std::lock_guard<std::mutex> lock(mIdleLock);
+        ix = sWorkerIndex >= 0 ? (size_t)sWorkerIndex : mNextWorker++ % mWorkers.size();
+    }
+    {
+        Worker &worker = *mWorkers[ix];
+        std::lock_guard<std::mutex> lock(worker.mLock);
+        worker.mReady.push_back(std::move(sequence));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mIdleLock);
+        ++mNumReady;
+    }
+    mIdleCondition.notify_one();
+}
+
+std::shared_ptr<SimpleC2Executor::Sequence> SimpleC2Executor::dequeue(size_t ix) {
+    // The caller has claimed one of mNumReady, so some worker holds a sequence for it.
+    for (;;) {
+        {
+            Worker &own = *mWorkers[ix];
+            std::lock_guard<std::mutex> lock(own.mLock);
+            if (!own.mReady.empty()) {
+                std::shared_ptr<Sequence> sequence = std::move(own.mReady.front());
+                own.mReady.pop_front();
+                return sequence;
+            }
+        }
+        for (size_t i = 1; i < mWorkers.size(); ++i) {
+            Worker &victim = *mWorkers[(ix + i) % mWorkers.size()];
+            std::lock_guard<std::mutex> lock(victim.mLock);
+            if (!victim.mReady.empty()) {
+                std::shared_ptr<Sequence> sequence = std::move(victim.mReady.back());
+                victim.mReady.pop_back();
+                return sequence;
+            }
+        }
+    }
+}
+
+void SimpleC2Executor::threadLoop(size_t ix) {
+    char name[16];
+    snprintf(name, sizeof(name), "C2SwExec#%zu", ix);
+    pthread_setname_np(pthread_self(), name);
+    androidSetThreadPriority(0 /* tid */, mPriority);
+    sWorkerIndex = ix;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mIdleLock);
+            mIdleCondition.wait(lock, [this] { return mNumReady > 0; });
+            --mNumReady;
+        }
+        dequeue(ix)->runNext();
+    }
+}
+
+SimpleC2Executor::Sequence::Sequence(SimpleC2Executor *executor)
+    : mExecutor(executor),
+      mScheduled(false) {
+}
+
+void SimpleC2Executor::Sequence::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mTasks.push_back(std::move(task));
+        if (mScheduled) {
+            return;
+        }
+        mScheduled = true;
+    }
+    mExecutor->schedule(shared_from_this());
+}
+
+void SimpleC2Executor::Sequence::postAndWait(std::function<void()> task) {
+    std::promise<void> done;
+    std::future<void> result = done.get_future();
+    post([&task, &done] {
+        task();
+        done.set_value();
+    });
+    result.wait();
+}
+
+void SimpleC2Executor::Sequence::runNext() {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        task = std::move(mTasks.front());
+        mTasks.pop_front();
+    }
+    task();
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (mTasks.empty()) {
+            mScheduled = false;
+            return;
+        }
+    }
+    // Run one task at a time so that a busy component cannot starve the others on this
+    // worker.
+    mExecutor->schedule(shared_from_this());
+}
+
+}  // namespace android
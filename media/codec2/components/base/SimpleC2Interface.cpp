@@ -188,6 +188,13 @@ SimpleInterface<void>::BaseParams::BaseParams(
             .withSetter(Setter<C2PortBlockPoolsTuning::output>::NonStrictValuesWithNoDeps)
             .build());
 
+    addParameter(
+            DefineParam(mProcessBatchSize, C2_PARAMKEY_PROCESS_BATCH_SIZE)
+            .withDefault(new C2ProcessBatchSizeTuning(1u))
+            .withFields({ C2F(mProcessBatchSize, value).inRange(1, 16) })
+            .withSetter(Setter<C2ProcessBatchSizeTuning>::NonStrictValueWithNoDeps)
+            .build());
+
     // add stateless params
     addParameter(
             DefineParam(mSubscribedParamIndices, C2_PARAMKEY_SUBSCRIBED_PARAM_INDICES)
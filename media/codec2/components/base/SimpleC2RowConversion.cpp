@@ -0,0 +1,586 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SimpleC2RowConversion"
+#include <log/log.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <utils/ThreadDefs.h>
+
+#include <SimpleC2Executor.h>
+
+#include "SimpleC2RowConversion.h"
+
+#if defined(__aarch64__) || defined(__ARM_NEON__)
+#define USE_NEON_ROWS 1
+#else
+#define USE_NEON_ROWS 0
+#endif
+
+#if defined(__i386__) || defined(__x86_64__)
+#define USE_X86_ROWS 1
+#else
+#define USE_X86_ROWS 0
+#endif
+
+#if USE_NEON_ROWS
+#include <arm_neon.h>
+#endif
+
+#if USE_X86_ROWS
+#include <immintrin.h>
+#endif
+
+namespace android {
+
+namespace {
+
+constexpr uint32_t kAlpha = 3u << 30;
+
+// Y410 keeps only the low 10 bits of the even luma and chroma samples; odd samples are used
+// unmasked.
+constexpr uint32_t kEvenSampleMask = 0x3FF;
+
+#define CLIP3(min, v, max) (((v) < (min)) ? (min) : (((max) > (v)) ? (v) : (max)))
+
+/* ----------------------------------------- scalar ----------------------------------------- */
+
+void Planar16To8(uint8_t *dst, const uint16_t *src, size_t count) {
+    for (size_t x = 0; x < count; ++x) {
+        dst[x] = (uint8_t)(src[x] >> 2);
+    }
+}
+
+void Planar16ToMsb(uint16_t *dst, const uint16_t *src, size_t count) {
+    for (size_t x = 0; x < count; ++x) {
+        dst[x] = src[x] << 6;
+    }
+}
+
+void Planar16ToInterleavedMsb(
+        uint16_t *dstUV, const uint16_t *srcU, const uint16_t *srcV, size_t count) {
+    for (size_t x = 0; x < count; ++x) {
+        dstUV[2 * x] = srcU[x] << 6;
+        dstUV[2 * x + 1] = srcV[x] << 6;
+    }
+}
+
+void RowPairToY410(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count) {
+    for (size_t x = 0; x < count; x += 4) {
+        uint32_t uv0 = (srcU[0] & kEvenSampleMask) | ((srcV[0] & kEvenSampleMask) << 20);
+        uint32_t uv1 = srcU[1] | ((uint32_t)srcV[1] << 20);
+        srcU += 2;
+        srcV += 2;
+
+        *dstTop++ = kAlpha | ((srcYTop[0] & kEvenSampleMask) << 10) | uv0;
+        *dstTop++ = kAlpha | ((uint32_t)srcYTop[1] << 10) | uv0;
+        *dstTop++ = kAlpha | ((srcYTop[2] & kEvenSampleMask) << 10) | uv1;
+        *dstTop++ = kAlpha | ((uint32_t)srcYTop[3] << 10) | uv1;
+        srcYTop += 4;
+
+        *dstBot++ = kAlpha | ((srcYBot[0] & kEvenSampleMask) << 10) | uv0;
+        *dstBot++ = kAlpha | ((uint32_t)srcYBot[1] << 10) | uv0;
+        *dstBot++ = kAlpha | ((srcYBot[2] & kEvenSampleMask) << 10) | uv1;
+        *dstBot++ = kAlpha | ((uint32_t)srcYBot[3] << 10) | uv1;
+        srcYBot += 4;
+    }
+}
+
+inline uint32_t PackRGBA1010102(int32_t yMult, int32_t u_b, int32_t uv_g, int32_t v_r) {
+    int32_t b = (yMult + u_b) / 1024;
+    int32_t g = (yMult + uv_g) / 1024;
+    int32_t r = (yMult + v_r) / 1024;
+    b = CLIP3(0, b, 1023);
+    g = CLIP3(0, g, 1023);
+    r = CLIP3(0, r, 1023);
+    return kAlpha | (b << 20) | (g << 10) | r;
+}
+
+void RowPairToRGBA1010102(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count, const Coeffs &coeffs) {
+    for (size_t x = 0; x < count; x += 2) {
+        int32_t u = *srcU++ - 512;
+        int32_t v = *srcV++ - 512;
+
+        int32_t u_b = u * coeffs._b_u;
+        int32_t uv_g = u * -coeffs._g_u + v * -coeffs._g_v;
+        int32_t v_r = v * coeffs._r_v;
+
+        *dstTop++ = PackRGBA1010102(
+                (*srcYTop++ - coeffs._c16) * coeffs._y + 512, u_b, uv_g, v_r);
+        *dstTop++ = PackRGBA1010102(
+                (*srcYTop++ - coeffs._c16) * coeffs._y + 512, u_b, uv_g, v_r);
+        *dstBot++ = PackRGBA1010102(
+                (*srcYBot++ - coeffs._c16) * coeffs._y + 512, u_b, uv_g, v_r);
+        *dstBot++ = PackRGBA1010102(
+                (*srcYBot++ - coeffs._c16) * coeffs._y + 512, u_b, uv_g, v_r);
+    }
+}
+
+// The vector kernels below compute (x / 1024) as (x >> 10): the two only differ for negative
+// x, which is clipped to 0 either way.
+
+/* ------------------------------------------ NEON ------------------------------------------ */
+
+#if USE_NEON_ROWS
+
+void Planar16To8Neon(uint8_t *dst, const uint16_t *src, size_t count) {
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        uint8x8_t lo = vshrn_n_u16(vld1q_u16(src + x), 2);
+        uint8x8_t hi = vshrn_n_u16(vld1q_u16(src + x + 8), 2);
+        vst1q_u8(dst + x, vcombine_u8(lo, hi));
+    }
+    Planar16To8(dst + x, src + x, count - x);
+}
+
+void Planar16ToMsbNeon(uint16_t *dst, const uint16_t *src, size_t count) {
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        vst1q_u16(dst + x, vshlq_n_u16(vld1q_u16(src + x), 6));
+    }
+    Planar16ToMsb(dst + x, src + x, count - x);
+}
+
+void Planar16ToInterleavedMsbNeon(
+        uint16_t *dstUV, const uint16_t *srcU, const uint16_t *srcV, size_t count) {
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        uint16x8x2_t uv;
+        uv.val[0] = vshlq_n_u16(vld1q_u16(srcU + x), 6);
+        uv.val[1] = vshlq_n_u16(vld1q_u16(srcV + x), 6);
+        vst2q_u16(dstUV + 2 * x, uv);
+    }
+    Planar16ToInterleavedMsb(dstUV + 2 * x, srcU + x, srcV + x, count - x);
+}
+
+void RowPairToY410Neon(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count) {
+    static const uint32_t kMask[4] = { kEvenSampleMask, ~0u, kEvenSampleMask, ~0u };
+    const uint32x4_t mask = vld1q_u32(kMask);
+    const uint32x4_t alpha = vdupq_n_u32(kAlpha);
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        uint32x4_t u = vandq_u32(vmovl_u16(vld1_u16(srcU + x / 2)), mask);
+        uint32x4_t v = vandq_u32(vmovl_u16(vld1_u16(srcV + x / 2)), mask);
+        uint32x4_t uv4 = vorrq_u32(vorrq_u32(u, vshlq_n_u32(v, 20)), alpha);
+        uint32x4x2_t uv = vzipq_u32(uv4, uv4);
+
+        uint16x8_t y = vld1q_u16(srcYTop + x);
+        vst1q_u32(dstTop + x, vorrq_u32(
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_low_u16(y)), mask), 10), uv.val[0]));
+        vst1q_u32(dstTop + x + 4, vorrq_u32(
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_high_u16(y)), mask), 10), uv.val[1]));
+
+        y = vld1q_u16(srcYBot + x);
+        vst1q_u32(dstBot + x, vorrq_u32(
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_low_u16(y)), mask), 10), uv.val[0]));
+        vst1q_u32(dstBot + x + 4, vorrq_u32(
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_high_u16(y)), mask), 10), uv.val[1]));
+    }
+    RowPairToY410(dstTop + x, dstBot + x, srcYTop + x, srcYBot + x, srcU + x / 2, srcV + x / 2,
+                  count - x);
+}
+
+inline uint32x4_t PackRGBA1010102Neon(
+        int32x4_t yMult, int32x4_t u_b, int32x4_t uv_g, int32x4_t v_r) {
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t max = vdupq_n_s32(1023);
+    int32x4_t b = vminq_s32(vmaxq_s32(vshrq_n_s32(vaddq_s32(yMult, u_b), 10), zero), max);
+    int32x4_t g = vminq_s32(vmaxq_s32(vshrq_n_s32(vaddq_s32(yMult, uv_g), 10), zero), max);
+    int32x4_t r = vminq_s32(vmaxq_s32(vshrq_n_s32(vaddq_s32(yMult, v_r), 10), zero), max);
+    uint32x4_t rgba = vorrq_u32(vshlq_n_u32(vreinterpretq_u32_s32(b), 20),
+                                vshlq_n_u32(vreinterpretq_u32_s32(g), 10));
+    return vorrq_u32(vorrq_u32(rgba, vreinterpretq_u32_s32(r)), vdupq_n_u32(kAlpha));
+}
+
+inline int32x4_t YMultNeon(uint16x4_t y, const Coeffs &coeffs) {
+    int32x4_t y32 = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(y)), vdupq_n_s32(coeffs._c16));
+    return vmlaq_n_s32(vdupq_n_s32(512), y32, coeffs._y);
+}
+
+void RowPairToRGBA1010102Neon(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count, const Coeffs &coeffs) {
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        int32x4_t u = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vld1_u16(srcU + x / 2))),
+                                vdupq_n_s32(512));
+        int32x4_t v = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vld1_u16(srcV + x / 2))),
+                                vdupq_n_s32(512));
+        int32x4_t u_b = vmulq_n_s32(u, coeffs._b_u);
+        int32x4_t uv_g = vaddq_s32(vmulq_n_s32(u, -coeffs._g_u), vmulq_n_s32(v, -coeffs._g_v));
+        int32x4_t v_r = vmulq_n_s32(v, coeffs._r_v);
+        int32x4x2_t b = vzipq_s32(u_b, u_b);
+        int32x4x2_t g = vzipq_s32(uv_g, uv_g);
+        int32x4x2_t r = vzipq_s32(v_r, v_r);
+
+        uint16x8_t y = vld1q_u16(srcYTop + x);
+        vst1q_u32(dstTop + x, PackRGBA1010102Neon(
+                YMultNeon(vget_low_u16(y), coeffs), b.val[0], g.val[0], r.val[0]));
+        vst1q_u32(dstTop + x + 4, PackRGBA1010102Neon(
+                YMultNeon(vget_high_u16(y), coeffs), b.val[1], g.val[1], r.val[1]));
+
+        y = vld1q_u16(srcYBot + x);
+        vst1q_u32(dstBot + x, PackRGBA1010102Neon(
+                YMultNeon(vget_low_u16(y), coeffs), b.val[0], g.val[0], r.val[0]));
+        vst1q_u32(dstBot + x + 4, PackRGBA1010102Neon(
+                YMultNeon(vget_high_u16(y), coeffs), b.val[1], g.val[1], r.val[1]));
+    }
+    RowPairToRGBA1010102(dstTop + x, dstBot + x, srcYTop + x, srcYBot + x, srcU + x / 2,
+                         srcV + x / 2, count - x, coeffs);
+}
+
+#endif  // USE_NEON_ROWS
+
+/* ------------------------------------------- x86 ------------------------------------------- */
+
+#if USE_X86_ROWS
+
+__attribute__((target("sse4.1")))
+void Planar16To8Sse41(uint8_t *dst, const uint16_t *src, size_t count) {
+    const __m128i lowByte = _mm_set1_epi16(0xFF);
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m128i lo = _mm_loadu_si128((const __m128i *)(src + x));
+        __m128i hi = _mm_loadu_si128((const __m128i *)(src + x + 8));
+        // mask before packing as packus saturates
+        lo = _mm_and_si128(_mm_srli_epi16(lo, 2), lowByte);
+        hi = _mm_and_si128(_mm_srli_epi16(hi, 2), lowByte);
+        _mm_storeu_si128((__m128i *)(dst + x), _mm_packus_epi16(lo, hi));
+    }
+    Planar16To8(dst + x, src + x, count - x);
+}
+
+__attribute__((target("sse4.1")))
+void Planar16ToMsbSse41(uint16_t *dst, const uint16_t *src, size_t count) {
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m128i y = _mm_loadu_si128((const __m128i *)(src + x));
+        _mm_storeu_si128((__m128i *)(dst + x), _mm_slli_epi16(y, 6));
+    }
+    Planar16ToMsb(dst + x, src + x, count - x);
+}
+
+__attribute__((target("sse4.1")))
+void Planar16ToInterleavedMsbSse41(
+        uint16_t *dstUV, const uint16_t *srcU, const uint16_t *srcV, size_t count) {
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m128i u = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(srcU + x)), 6);
+        __m128i v = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(srcV + x)), 6);
+        _mm_storeu_si128((__m128i *)(dstUV + 2 * x), _mm_unpacklo_epi16(u, v));
+        _mm_storeu_si128((__m128i *)(dstUV + 2 * x + 8), _mm_unpackhi_epi16(u, v));
+    }
+    Planar16ToInterleavedMsb(dstUV + 2 * x, srcU + x, srcV + x, count - x);
+}
+
+__attribute__((target("sse4.1")))
+void RowPairToY410Sse41(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count) {
+    const __m128i mask = _mm_setr_epi32(kEvenSampleMask, -1, kEvenSampleMask, -1);
+    const __m128i alpha = _mm_set1_epi32(kAlpha);
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m128i u = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(srcU + x / 2)));
+        __m128i v = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(srcV + x / 2)));
+        __m128i uv = _mm_or_si128(_mm_and_si128(u, mask),
+                                  _mm_slli_epi32(_mm_and_si128(v, mask), 20));
+        uv = _mm_or_si128(uv, alpha);
+        __m128i uvLo = _mm_unpacklo_epi32(uv, uv);
+        __m128i uvHi = _mm_unpackhi_epi32(uv, uv);
+
+        __m128i y = _mm_loadu_si128((const __m128i *)(srcYTop + x));
+        __m128i yLo = _mm_and_si128(_mm_cvtepu16_epi32(y), mask);
+        __m128i yHi = _mm_and_si128(_mm_cvtepu16_epi32(_mm_srli_si128(y, 8)), mask);
+        _mm_storeu_si128((__m128i *)(dstTop + x), _mm_or_si128(_mm_slli_epi32(yLo, 10), uvLo));
+        _mm_storeu_si128((__m128i *)(dstTop + x + 4),
+                         _mm_or_si128(_mm_slli_epi32(yHi, 10), uvHi));
+
+        y = _mm_loadu_si128((const __m128i *)(srcYBot + x));
+        yLo = _mm_and_si128(_mm_cvtepu16_epi32(y), mask);
+        yHi = _mm_and_si128(_mm_cvtepu16_epi32(_mm_srli_si128(y, 8)), mask);
+        _mm_storeu_si128((__m128i *)(dstBot + x), _mm_or_si128(_mm_slli_epi32(yLo, 10), uvLo));
+        _mm_storeu_si128((__m128i *)(dstBot + x + 4),
+                         _mm_or_si128(_mm_slli_epi32(yHi, 10), uvHi));
+    }
+    RowPairToY410(dstTop + x, dstBot + x, srcYTop + x, srcYBot + x, srcU + x / 2, srcV + x / 2,
+                  count - x);
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i PackRGBA1010102Sse41(__m128i yMult, __m128i u_b, __m128i uv_g, __m128i v_r) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi32(1023);
+    __m128i b = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(_mm_add_epi32(yMult, u_b), 10), zero),
+                              max);
+    __m128i g = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(_mm_add_epi32(yMult, uv_g), 10), zero),
+                              max);
+    __m128i r = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(_mm_add_epi32(yMult, v_r), 10), zero),
+                              max);
+    __m128i rgba = _mm_or_si128(_mm_slli_epi32(b, 20), _mm_slli_epi32(g, 10));
+    return _mm_or_si128(_mm_or_si128(rgba, r), _mm_set1_epi32(kAlpha));
+}
+
+__attribute__((target("sse4.1")))
+void RowPairToRGBA1010102Sse41(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count, const Coeffs &coeffs) {
+    const __m128i c512 = _mm_set1_epi32(512);
+    const __m128i c16 = _mm_set1_epi32(coeffs._c16);
+    const __m128i cy = _mm_set1_epi32(coeffs._y);
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m128i u = _mm_sub_epi32(
+                _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(srcU + x / 2))), c512);
+        __m128i v = _mm_sub_epi32(
+                _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(srcV + x / 2))), c512);
+        __m128i u_b = _mm_mullo_epi32(u, _mm_set1_epi32(coeffs._b_u));
+        __m128i uv_g = _mm_add_epi32(_mm_mullo_epi32(u, _mm_set1_epi32(-coeffs._g_u)),
+                                     _mm_mullo_epi32(v, _mm_set1_epi32(-coeffs._g_v)));
+        __m128i v_r = _mm_mullo_epi32(v, _mm_set1_epi32(coeffs._r_v));
+        __m128i bLo = _mm_unpacklo_epi32(u_b, u_b), bHi = _mm_unpackhi_epi32(u_b, u_b);
+        __m128i gLo = _mm_unpacklo_epi32(uv_g, uv_g), gHi = _mm_unpackhi_epi32(uv_g, uv_g);
+        __m128i rLo = _mm_unpacklo_epi32(v_r, v_r), rHi = _mm_unpackhi_epi32(v_r, v_r);
+
+        for (int row = 0; row < 2; ++row) {
+            const uint16_t *srcY = row ? srcYBot : srcYTop;
+            uint32_t *dst = row ? dstBot : dstTop;
+            __m128i y = _mm_loadu_si128((const __m128i *)(srcY + x));
+            __m128i yLo = _mm_add_epi32(
+                    _mm_mullo_epi32(_mm_sub_epi32(_mm_cvtepu16_epi32(y), c16), cy), c512);
+            __m128i yHi = _mm_add_epi32(_mm_mullo_epi32(
+                    _mm_sub_epi32(_mm_cvtepu16_epi32(_mm_srli_si128(y, 8)), c16), cy), c512);
+            _mm_storeu_si128((__m128i *)(dst + x), PackRGBA1010102Sse41(yLo, bLo, gLo, rLo));
+            _mm_storeu_si128((__m128i *)(dst + x + 4),
+                             PackRGBA1010102Sse41(yHi, bHi, gHi, rHi));
+        }
+    }
+    RowPairToRGBA1010102(dstTop + x, dstBot + x, srcYTop + x, srcYBot + x, srcU + x / 2,
+                         srcV + x / 2, count - x, coeffs);
+}
+
+// Duplicates each of the 8 lanes of |x| into consecutive lanes of |*lo| and |*hi|.
+__attribute__((target("avx2")))
+inline void DuplicateLanesAvx2(__m256i x, __m256i *lo, __m256i *hi) {
+    __m256i a = _mm256_unpacklo_epi32(x, x);  // x0 x0 x1 x1 | x4 x4 x5 x5
+    __m256i b = _mm256_unpackhi_epi32(x, x);  // x2 x2 x3 x3 | x6 x6 x7 x7
+    *lo = _mm256_permute2x128_si256(a, b, 0x20);
+    *hi = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+__attribute__((target("avx2")))
+void RowPairToY410Avx2(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count) {
+    const __m256i mask = _mm256_setr_epi32(
+            kEvenSampleMask, -1, kEvenSampleMask, -1, kEvenSampleMask, -1, kEvenSampleMask, -1);
+    const __m256i alpha = _mm256_set1_epi32(kAlpha);
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i u = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(srcU + x / 2)));
+        __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(srcV + x / 2)));
+        __m256i uv = _mm256_or_si256(_mm256_and_si256(u, mask),
+                                     _mm256_slli_epi32(_mm256_and_si256(v, mask), 20));
+        __m256i uvLo, uvHi;
+        DuplicateLanesAvx2(_mm256_or_si256(uv, alpha), &uvLo, &uvHi);
+
+        for (int row = 0; row < 2; ++row) {
+            const uint16_t *srcY = row ? srcYBot : srcYTop;
+            uint32_t *dst = row ? dstBot : dstTop;
+            __m256i y = _mm256_loadu_si256((const __m256i *)(srcY + x));
+            __m256i yLo = _mm256_and_si256(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(y)), mask);
+            __m256i yHi = _mm256_and_si256(
+                    _mm256_cvtepu16_epi32(_mm256_extracti128_si256(y, 1)), mask);
+            _mm256_storeu_si256((__m256i *)(dst + x),
+                                _mm256_or_si256(_mm256_slli_epi32(yLo, 10), uvLo));
+            _mm256_storeu_si256((__m256i *)(dst + x + 8),
+                                _mm256_or_si256(_mm256_slli_epi32(yHi, 10), uvHi));
+        }
+    }
+    RowPairToY410Sse41(dstTop + x, dstBot + x, srcYTop + x, srcYBot + x, srcU + x / 2,
+                       srcV + x / 2, count - x);
+}
+
+__attribute__((target("avx2")))
+inline __m256i PackRGBA1010102Avx2(__m256i yMult, __m256i u_b, __m256i uv_g, __m256i v_r) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi32(1023);
+    __m256i b = _mm256_min_epi32(
+            _mm256_max_epi32(_mm256_srai_epi32(_mm256_add_epi32(yMult, u_b), 10), zero), max);
+    __m256i g = _mm256_min_epi32(
+            _mm256_max_epi32(_mm256_srai_epi32(_mm256_add_epi32(yMult, uv_g), 10), zero), max);
+    __m256i r = _mm256_min_epi32(
+            _mm256_max_epi32(_mm256_srai_epi32(_mm256_add_epi32(yMult, v_r), 10), zero), max);
+    __m256i rgba = _mm256_or_si256(_mm256_slli_epi32(b, 20), _mm256_slli_epi32(g, 10));
+    return _mm256_or_si256(_mm256_or_si256(rgba, r), _mm256_set1_epi32(kAlpha));
+}
+
+__attribute__((target("avx2")))
+void RowPairToRGBA1010102Avx2(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+        const uint16_t *srcU, const uint16_t *srcV, size_t count, const Coeffs &coeffs) {
+    const __m256i c512 = _mm256_set1_epi32(512);
+    const __m256i c16 = _mm256_set1_epi32(coeffs._c16);
+    const __m256i cy = _mm256_set1_epi32(coeffs._y);
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i u = _mm256_sub_epi32(
+                _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(srcU + x / 2))), c512);
+        __m256i v = _mm256_sub_epi32(
+                _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(srcV + x / 2))), c512);
+        __m256i bLo, bHi, gLo, gHi, rLo, rHi;
+        DuplicateLanesAvx2(_mm256_mullo_epi32(u, _mm256_set1_epi32(coeffs._b_u)), &bLo, &bHi);
+        DuplicateLanesAvx2(
+                _mm256_add_epi32(_mm256_mullo_epi32(u, _mm256_set1_epi32(-coeffs._g_u)),
+                                 _mm256_mullo_epi32(v, _mm256_set1_epi32(-coeffs._g_v))),
+                &gLo, &gHi);
+        DuplicateLanesAvx2(_mm256_mullo_epi32(v, _mm256_set1_epi32(coeffs._r_v)), &rLo, &rHi);
+
+        for (int row = 0; row < 2; ++row) {
+            const uint16_t *srcY = row ? srcYBot : srcYTop;
+            uint32_t *dst = row ? dstBot : dstTop;
+            __m256i y = _mm256_loadu_si256((const __m256i *)(srcY + x));
+            __m256i yLo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(y));
+            __m256i yHi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(y, 1));
+            yLo = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(yLo, c16), cy), c512);
+            yHi = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(yHi, c16), cy), c512);
+            _mm256_storeu_si256((__m256i *)(dst + x), PackRGBA1010102Avx2(yLo, bLo, gLo, rLo));
+            _mm256_storeu_si256((__m256i *)(dst + x + 8),
+                                PackRGBA1010102Avx2(yHi, bHi, gHi, rHi));
+        }
+    }
+    RowPairToRGBA1010102Sse41(dstTop + x, dstBot + x, srcYTop + x, srcYBot + x, srcU + x / 2,
+                              srcV + x / 2, count - x, coeffs);
+}
+
+#endif  // USE_X86_ROWS
+
+/* -------------------------------------- row threads -------------------------------------- */
+
+// Frames of at least this size are converted on several threads.
+constexpr size_t kParallelMinPixels = 3840 * 2160;
+constexpr size_t kMaxRowThreads = 4;
+
+// Sequences on the helper threads; empty on single core devices.
+const std::vector<std::shared_ptr<SimpleC2Executor::Sequence>> &GetRowSequences() {
+    // Never destroyed, as the helper threads are detached.
+    static const auto *sSequences = [] {
+        auto *sequences = new std::vector<std::shared_ptr<SimpleC2Executor::Sequence>>;
+        size_t numThreads = std::min<size_t>(std::thread::hardware_concurrency(), kMaxRowThreads);
+        if (numThreads > 1) {
+            // the calling thread converts one of the ranges
+            SimpleC2Executor *executor = new SimpleC2Executor(
+                    numThreads - 1, ANDROID_PRIORITY_VIDEO);
+            for (size_t i = 0; i + 1 < numThreads; ++i) {
+                sequences->push_back(executor->createSequence());
+            }
+        }
+        return sequences;
+    }();
+    return *sSequences;
+}
+
+}  // namespace
+
+const RowConverters &GetRowConverters() {
+    static const RowConverters sConverters = [] {
+        RowConverters converters = {
+            Planar16To8,
+            Planar16ToMsb,
+            Planar16ToInterleavedMsb,
+            RowPairToY410,
+            RowPairToRGBA1010102,
+        };
+#if USE_NEON_ROWS
+        converters = {
+            Planar16To8Neon,
+            Planar16ToMsbNeon,
+            Planar16ToInterleavedMsbNeon,
+            RowPairToY410Neon,
+            RowPairToRGBA1010102Neon,
+        };
+#endif
+#if USE_X86_ROWS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.1")) {
+            converters = {
+                Planar16To8Sse41,
+                Planar16ToMsbSse41,
+                Planar16ToInterleavedMsbSse41,
+                RowPairToY410Sse41,
+                RowPairToRGBA1010102Sse41,
+            };
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            converters.rowPairToY410 = RowPairToY410Avx2;
+            converters.rowPairToRGBA1010102 = RowPairToRGBA1010102Avx2;
+        }
+#endif
+        return converters;
+    }();
+    return sConverters;
+}
+
+void ForEachRowRange(
+        size_t width, size_t height, size_t rowAlign,
+        const std::function<void(size_t begin, size_t end)> &convert) {
+    if (width * height < kParallelMinPixels || GetRowSequences().empty()) {
+        convert(0, height);
+        return;
+    }
+
+    const auto &sequences = GetRowSequences();
+    size_t numRanges = sequences.size() + 1;
+    size_t rangeRows = (height + numRanges - 1) / numRanges;
+    rangeRows = (rangeRows + rowAlign - 1) / rowAlign * rowAlign;
+
+    std::mutex lock;
+    std::condition_variable done;
+    size_t pending = 0;
+    size_t ix = 0;
+    for (size_t begin = rangeRows; begin < height; begin += rangeRows) {
+        size_t end = std::min(begin + rangeRows, height);
+        {
+            std::lock_guard<std::mutex> l(lock);
+            ++pending;
+        }
+        sequences[ix++]->post([&convert, &lock, &done, &pending, begin, end] {
+            convert(begin, end);
+            std::lock_guard<std::mutex> l(lock);
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        });
+    }
+    convert(0, std::min(rangeRows, height));
+
+    std::unique_lock<std::mutex> l(lock);
+    done.wait(l, [&pending] { return pending == 0; });
+}
+
+}  // namespace android
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SIMPLE_C2_ROW_CONVERSION_H_
+#define SIMPLE_C2_ROW_CONVERSION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+
+namespace android {
+
+// matrix conversion coefficients
+// (see media/libstagefright/colorconverter/ColorConverter.cpp for more details)
+struct Coeffs {
+    int32_t _y, _r_v, _g_u, _g_v, _b_u, _c16;
+};
+
+/**
+ * Per-row kernels of the YUV conversion functions in SimpleC2Component.cpp.
+ *
+ * Every kernel has a scalar implementation and NEON, SSE4.1 and/or AVX2 ones; the vector
+ * versions produce bit-exact results for any input, including values above 10 bits.
+ */
+struct RowConverters {
+    // dst[x] = (uint8_t)(src[x] >> 2)
+    void (*planar16To8)(uint8_t *dst, const uint16_t *src, size_t count);
+    // dst[x] = src[x] << 6
+    void (*planar16ToMsb)(uint16_t *dst, const uint16_t *src, size_t count);
+    // dstUV[2x] = srcU[x] << 6; dstUV[2x + 1] = srcV[x] << 6
+    void (*planar16ToInterleavedMsb)(
+            uint16_t *dstUV, const uint16_t *srcU, const uint16_t *srcV, size_t count);
+    // Converts |count| pixels, a multiple of 4, of two luma rows and their chroma row to Y410.
+    void (*rowPairToY410)(
+            uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+            const uint16_t *srcU, const uint16_t *srcV, size_t count);
+    // Converts |count| pixels, a multiple of 2, of two luma rows and their chroma row to
+    // RGBA1010102.
+    void (*rowPairToRGBA1010102)(
+            uint32_t *dstTop, uint32_t *dstBot, const uint16_t *srcYTop, const uint16_t *srcYBot,
+            const uint16_t *srcU, const uint16_t *srcV, size_t count, const Coeffs &coeffs);
+};
+
+/**
+ * Returns the fastest kernels for this CPU. On x86 the SSE4.1 and AVX2 kernels are selected at
+ * runtime.
+ */
+const RowConverters &GetRowConverters();
+
+/**
+ * Calls |convert|(begin, end) over [0, |height|) in ranges whose boundaries are multiples of
+ * |rowAlign|. Frames of 4K and above are split across helper threads; this returns once all
+ * rows have been converted.
+ */
+void ForEachRowRange(
+        size_t width, size_t height, size_t rowAlign,
+        const std::function<void(size_t begin, size_t end)> &convert);
+
+}  // namespace android
+
+#endif  // SIMPLE_C2_ROW_CONVERSION_H_
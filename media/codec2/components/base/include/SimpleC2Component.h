@@ -27,6 +27,8 @@
 #include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/Mutexed.h>
 
+#include <SimpleC2Executor.h>
+
 struct C2ColorAspectsStruct;
 
 namespace android {
@@ -239,11 +241,23 @@ private:
 
         void setComponent(const std::shared_ptr<SimpleC2Component> &thiz);
 
+        // Runs the handler on |sequence| of the shared executor instead of on a looper.
+        void setSequence(const std::shared_ptr<SimpleC2Executor::Sequence> &sequence);
+
+        // Posts |what| to the looper or to the sequence.
+        void post(int32_t what);
+        // Posts |what| and waits for it to be handled; returns the error of the request.
+        int32_t postAndAwaitResponse(int32_t what);
+
     protected:
         void onMessageReceived(const sp<AMessage> &msg) override;
 
     private:
+        // Handles |what|; returns true if the work queue should be processed again.
+        bool handle(int32_t what, int32_t *err);
+
         std::weak_ptr<SimpleC2Component> mThiz;
+        std::shared_ptr<SimpleC2Executor::Sequence> mSequence;
         bool mRunning;
     };
 
@@ -303,6 +317,20 @@ private:
     std::shared_ptr<BlockingBlockPool> mOutputBlockPool;
 
     std::vector<int> mBitDepth10HalPixelFormats;
+
+    // Processes the next queued work or drain; returns true if more work is queued.
+    bool processWork();
+    // Returns |work| to the client, or adds it to the current batch.
+    void returnWork(std::unique_ptr<C2Work> work);
+    // Returns the works of the current batch in one callback.
+    void returnBatchedWork();
+    void updateProcessBatchSize();
+
+    // The following are only accessed on the handler.
+    uint32_t mProcessBatchSize;
+    bool mBatching;
+    std::list<std::unique_ptr<C2Work>> mBatchedWork;
+
     SimpleC2Component() = delete;
 };
 
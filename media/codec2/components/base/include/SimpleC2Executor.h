@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SIMPLE_C2_EXECUTOR_H_
+#define SIMPLE_C2_EXECUTOR_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace android {
+
+/**
+ * Fixed pool of worker threads shared by software components.
+ *
+ * Work is posted to a Sequence. Tasks of a sequence run one at a time and in posting order,
+ * while different sequences run in parallel on the pool. Each worker keeps its own queue of
+ * ready sequences and steals from the other workers when it runs out.
+ */
+class SimpleC2Executor {
+public:
+    class Sequence : public std::enable_shared_from_this<Sequence> {
+    public:
+        /**
+         * Posts |task| to run after all previously posted tasks of this sequence.
+         */
+        void post(std::function<void()> task);
+
+        /**
+         * Posts |task| and blocks until it has run. Must not be called from a task of the same
+         * sequence.
+         */
+        void postAndWait(std::function<void()> task);
+
+    private:
+        explicit Sequence(SimpleC2Executor *executor);
+
+        // Runs the next task, then reschedules the sequence if more tasks are queued.
+        void runNext();
+
+        SimpleC2Executor *const mExecutor;
+        std::mutex mLock;
+        std::deque<std::function<void()>> mTasks;
+        // true while the sequence is queued on a worker or running
+        bool mScheduled;
+
+        friend class SimpleC2Executor;
+    };
+
+    /**
+     * Returns the process-wide executor for audio components, or nullptr if they should keep
+     * using a looper thread each. Controlled by debug.codec2.sw_shared_executor; the pool size
+     * defaults to the number of cores and can be overridden with
+     * debug.codec2.sw_shared_executor_threads. Workers run at audio priority.
+     *
+     * A task holds its worker until it returns, so only components whose process() does not
+     * wait for output buffers may use the shared executor. Video components retry graphic
+     * block allocation until the consumer returns a buffer and keep their own looper.
+     */
+    static SimpleC2Executor *GetShared();
+
+    /**
+     * Starts |numThreads| workers running at |priority|. The workers are never stopped, so
+     * the executor must outlive any use.
+     */
+    SimpleC2Executor(size_t numThreads, int32_t priority);
+
+    std::shared_ptr<Sequence> createSequence();
+
+private:
+    struct Worker {
+        std::mutex mLock;
+        std::deque<std::shared_ptr<Sequence>> mReady;
+    };
+
+    void schedule(std::shared_ptr<Sequence> sequence);
+    std::shared_ptr<Sequence> dequeue(size_t ix);
+    void threadLoop(size_t ix);
+
+    const int32_t mPriority;
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+
+    std::mutex mIdleLock;
+    std::condition_variable mIdleCondition;
+    // number of sequences queued on workers and not yet claimed
+    size_t mNumReady;
+    size_t mNextWorker;
+
+    SimpleC2Executor(const SimpleC2Executor &) = delete;
+    SimpleC2Executor &operator=(const SimpleC2Executor &) = delete;
+};
+
+}  // namespace android
+
+#endif  // SIMPLE_C2_EXECUTOR_H_
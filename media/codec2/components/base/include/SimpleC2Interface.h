@@ -171,6 +171,7 @@ public:
         std::shared_ptr<C2PrivateAllocatorsTuning> mPrivateAllocators;
         std::shared_ptr<C2PortBlockPoolsTuning::output> mOutputPoolIds;
         std::shared_ptr<C2PrivateBlockPoolsTuning> mPrivatePoolIds;
+        std::shared_ptr<C2ProcessBatchSizeTuning> mProcessBatchSize;
 
         std::shared_ptr<C2TrippedTuning> mTripped;
         std::shared_ptr<C2OutOfMemoryTuning> mOutOfMemory;
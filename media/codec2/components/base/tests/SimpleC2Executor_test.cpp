@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SimpleC2Executor_test"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <utils/ThreadDefs.h>
+
+#include <SimpleC2Executor.h>
+
+namespace android {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Workers are never stopped, so executors used by the tests are not deleted.
+SimpleC2Executor *CreateExecutor(size_t numThreads) {
+    return new SimpleC2Executor(numThreads, ANDROID_PRIORITY_NORMAL);
+}
+
+}  // namespace
+
+// Tasks of a sequence run in posting order and never concurrently, while
+// several sequences are posted to from several threads.
+TEST(SimpleC2ExecutorTest, SequenceOrder) {
+    constexpr size_t kNumSequences = 8;
+    constexpr size_t kNumTasks = 2000;
+    SimpleC2Executor *executor = CreateExecutor(4);
+
+    struct State {
+        std::shared_ptr<SimpleC2Executor::Sequence> sequence;
+        std::vector<size_t> order;
+        std::atomic_bool running{false};
+        std::atomic_size_t overlaps{0};
+    };
+    std::vector<State> states(kNumSequences);
+    for (State &state : states) {
+        state.sequence = executor->createSequence();
+    }
+
+    std::vector<std::thread> posters;
+    for (State &state : states) {
+        posters.emplace_back([&state] {
+            for (size_t i = 0; i < kNumTasks; ++i) {
+                state.sequence->post([&state, i] {
+                    if (state.running.exchange(true)) {
+                        ++state.overlaps;
+                    }
+                    state.order.push_back(i);
+                    state.running = false;
+                });
+            }
+        });
+    }
+    for (std::thread &poster : posters) {
+        poster.join();
+    }
+
+    for (State &state : states) {
+        // runs after all tasks posted before it
+        state.sequence->postAndWait([] {});
+        EXPECT_EQ(0u, state.overlaps);
+        ASSERT_EQ(kNumTasks, state.order.size());
+        for (size_t i = 0; i < kNumTasks; ++i) {
+            ASSERT_EQ(i, state.order[i]);
+        }
+    }
+}
+
+// Tasks posted from a task run after it, also when they are reposted by the
+// worker itself.
+TEST(SimpleC2ExecutorTest, PostFromTask) {
+    SimpleC2Executor *executor = CreateExecutor(2);
+    std::shared_ptr<SimpleC2Executor::Sequence> sequence = executor->createSequence();
+
+    std::vector<int> order;
+    sequence->postAndWait([&] {
+        order.push_back(0);
+        sequence->post([&] { order.push_back(2); });
+        order.push_back(1);
+    });
+    sequence->postAndWait([&] { order.push_back(3); });
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), order);
+}
+
+// A sequence scheduled from a worker is queued on that worker. While the
+// worker is busy, another worker has to steal it.
+TEST(SimpleC2ExecutorTest, WorkStealing) {
+    SimpleC2Executor *executor = CreateExecutor(2);
+    std::shared_ptr<SimpleC2Executor::Sequence> busy = executor->createSequence();
+    std::shared_ptr<SimpleC2Executor::Sequence> other = executor->createSequence();
+
+    std::promise<std::thread::id> stolen;
+    std::future<std::thread::id> stolenId = stolen.get_future();
+    std::thread::id busyId;
+    bool ranWhileBusy = false;
+    busy->postAndWait([&] {
+        busyId = std::this_thread::get_id();
+        other->post([&stolen] { stolen.set_value(std::this_thread::get_id()); });
+        // keep this worker busy until the other sequence ran elsewhere
+        ranWhileBusy = stolenId.wait_for(5s) == std::future_status::ready;
+    });
+    ASSERT_TRUE(ranWhileBusy);
+    EXPECT_NE(busyId, stolenId.get());
+}
+
+// A busy sequence yields after each task, so it does not hold up other
+// sequences queued on the same worker.
+TEST(SimpleC2ExecutorTest, BusySequenceYields) {
+    SimpleC2Executor *executor = CreateExecutor(1);
+    std::shared_ptr<SimpleC2Executor::Sequence> busy = executor->createSequence();
+    std::shared_ptr<SimpleC2Executor::Sequence> other = executor->createSequence();
+
+    std::atomic_bool stop{false};
+    std::atomic_size_t count{0};
+    std::function<void()> spin = [&] {
+        ++count;
+        if (!stop) {
+            busy->post(spin);
+        }
+    };
+    busy->post(spin);
+
+    other->postAndWait([] {});
+    EXPECT_GT(count, 0u);
+    stop = true;
+    // The task running when |stop| was set may have posted one more after the first wait.
+    busy->postAndWait([] {});
+    busy->postAndWait([] {});
+}
+
+}  // namespace android
@@ -18,6 +18,7 @@
 #define LOG_TAG "C2SoftDav1dDec"
 #include <android-base/properties.h>
 #include <cutils/properties.h>
+#include <optional>
 #include <thread>
 
 #include <C2Debug.h>
@@ -37,6 +38,10 @@ namespace android {
 static const int NUM_THREADS_DAV1D_DEFAULT = 0;
 static const char NUM_THREADS_DAV1D_PROPERTY[] = "debug.dav1d.numthreads";
 
+// Whether dav1d may decode pictures straight into output blocks.
+static const bool ZERO_COPY_DAV1D_DEFAULT = true;
+static const char ZERO_COPY_DAV1D_PROPERTY[] = "debug.dav1d.zerocopy";
+
 // codecname set and passed in as a compile flag from Android.bp
 constexpr char COMPONENT_NAME[] = CODECNAME;
 
@@ -440,6 +445,18 @@ class C2SoftDav1dDec::IntfImpl : public SimpleInterface<void>::BaseParams {
     std::shared_ptr<C2GlobalLowLatencyModeTuning> mLowLatencyMode;
 };
 
+// Backing memory of a picture allocated by AllocPicture().
+struct C2SoftDav1dDec::PictureBuffer {
+    // Output block the picture is decoded into, if any.
+    std::shared_ptr<C2GraphicBlock> block;
+    // Keeps |block| mapped until dav1d releases the picture. dav1d keeps reading a reference
+    // frame after it has been output, so the mapping has to outlive the output.
+    std::optional<C2GraphicView> view;
+    // Heap memory used otherwise.
+    std::unique_ptr<uint8_t[]> heap;
+    size_t heapSize = 0;
+};
+
 C2SoftDav1dDec::C2SoftDav1dDec(const char* name, c2_node_id_t id,
                                const std::shared_ptr<IntfImpl>& intfImpl)
     : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
@@ -459,6 +476,7 @@ c2_status_t C2SoftDav1dDec::onStop() {
     // TODO: b/277797541 - investigate if the decoder needs to be flushed.
     mSignalledError = false;
     mSignalledOutputEos = false;
+    mOutputPool.reset();
     return C2_OK;
 }
 
@@ -501,6 +519,7 @@ void C2SoftDav1dDec::flushDav1d() {
 
 void C2SoftDav1dDec::onRelease() {
     destroyDecoder();
+    mOutputPool.reset();
 }
 
 c2_status_t C2SoftDav1dDec::onFlush_sm() {
@@ -551,6 +570,14 @@ bool C2SoftDav1dDec::initDecoder() {
 
     lib_settings.max_frame_delay = mActualOutputDelayInfo->value;
 
+    mZeroCopy = android::base::GetBoolProperty(ZERO_COPY_DAV1D_PROPERTY, ZERO_COPY_DAV1D_DEFAULT);
+    mZeroCopyFailed = false;
+    if (mZeroCopy) {
+        lib_settings.allocator.cookie = this;
+        lib_settings.allocator.alloc_picture_callback = AllocPicture;
+        lib_settings.allocator.release_picture_callback = ReleasePicture;
+    }
+
     int res = 0;
     if ((res = dav1d_open(&mDav1dCtx, &lib_settings))) {
         ALOGE("dav1d_open failed. status: %d.", res);
@@ -569,11 +596,138 @@ void C2SoftDav1dDec::destroyDecoder() {
         mOutputBufferIndex = 0;
         mInputBufferIndex = 0;
     }
+    {
+        // dav1d_close() has released all pictures
+        std::lock_guard<std::mutex> lock(mFreeHeapBuffersLock);
+        mFreeHeapBuffers.clear();
+    }
 #ifdef FILE_DUMP_ENABLE
     mC2SoftDav1dDump.destroyDumping();
 #endif
 }
 
+// static
+int C2SoftDav1dDec::AllocPicture(Dav1dPicture* pic, void* cookie) {
+    C2SoftDav1dDec* thiz = static_cast<C2SoftDav1dDec*>(cookie);
+    std::unique_ptr<PictureBuffer> buffer(new PictureBuffer);
+    if (!thiz->allocPictureFromBlock(pic, buffer.get())) {
+        {
+            std::lock_guard<std::mutex> lock(thiz->mFreeHeapBuffersLock);
+            if (!thiz->mFreeHeapBuffers.empty()) {
+                buffer = std::move(thiz->mFreeHeapBuffers.back());
+                thiz->mFreeHeapBuffers.pop_back();
+            }
+        }
+        if (!thiz->allocPictureFromHeap(pic, buffer.get())) {
+            return DAV1D_ERR(ENOMEM);
+        }
+    }
+    pic->allocator_data = buffer.release();
+    return 0;
+}
+
+// static
+void C2SoftDav1dDec::ReleasePicture(Dav1dPicture* pic, void* cookie) {
+    C2SoftDav1dDec* thiz = static_cast<C2SoftDav1dDec*>(cookie);
+    std::unique_ptr<PictureBuffer> buffer(static_cast<PictureBuffer*>(pic->allocator_data));
+    if (buffer->heap) {
+        std::lock_guard<std::mutex> lock(thiz->mFreeHeapBuffersLock);
+        thiz->mFreeHeapBuffers.push_back(std::move(buffer));
+    }
+}
+
+bool C2SoftDav1dDec::allocPictureFromBlock(Dav1dPicture* pic, PictureBuffer* buffer) {
+    // Only pictures that are output without conversion can be decoded into output blocks.
+    // BufferQueue blocks are not used either, as the surface may hand them out again while
+    // dav1d still references them.
+    if (mZeroCopyFailed || !mOutputPool ||
+        mOutputPool->getAllocatorId() != C2PlatformAllocatorStore::GRALLOC ||
+        pic->p.bpc != 8 || pic->p.layout != DAV1D_PIXEL_LAYOUT_I420 ||
+        pic->p.w != (int)mWidth || pic->p.h != (int)mHeight) {
+        return false;
+    }
+
+    // dav1d writes up to 128-pixel aligned dimensions, and needs DAV1D_PICTURE_ALIGNMENT bytes
+    // of padding after each plane: the 2 extra rows provide that.
+    C2MemoryUsage usage = {C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE};
+    std::shared_ptr<C2GraphicBlock> block;
+    c2_status_t err = mOutputPool->fetchGraphicBlock(align(pic->p.w, 128),
+                                                     align(pic->p.h, 128) + 2,
+                                                     HAL_PIXEL_FORMAT_YV12, usage, &block);
+    if (err != C2_OK) {
+        ALOGV("fetchGraphicBlock for picture failed with status %d", err);
+        return false;
+    }
+    C2GraphicView wView = block->map().get();
+    if (wView.error()) {
+        ALOGV("graphic view map failed %d", wView.error());
+        return false;
+    }
+
+    const C2PlanarLayout& layout = wView.layout();
+    const C2PlaneInfo& yPlane = layout.planes[C2PlanarLayout::PLANE_Y];
+    const C2PlaneInfo& uPlane = layout.planes[C2PlanarLayout::PLANE_U];
+    const C2PlaneInfo& vPlane = layout.planes[C2PlanarLayout::PLANE_V];
+    uint8_t* dstY = const_cast<uint8_t*>(wView.data()[C2PlanarLayout::PLANE_Y]);
+    uint8_t* dstU = const_cast<uint8_t*>(wView.data()[C2PlanarLayout::PLANE_U]);
+    uint8_t* dstV = const_cast<uint8_t*>(wView.data()[C2PlanarLayout::PLANE_V]);
+    auto isAligned = [](uintptr_t value) { return value % DAV1D_PICTURE_ALIGNMENT == 0; };
+    if (layout.type != C2PlanarLayout::TYPE_YUV || layout.numPlanes != 3 ||
+        yPlane.colInc != 1 || uPlane.colInc != 1 || vPlane.colInc != 1 ||
+        uPlane.rowInc != vPlane.rowInc || !isAligned(yPlane.rowInc) ||
+        !isAligned(uPlane.rowInc) || !isAligned((uintptr_t)dstY) ||
+        !isAligned((uintptr_t)dstU) || !isAligned((uintptr_t)dstV)) {
+        // the allocator is not going to return different layouts for the next pictures
+        ALOGI("output blocks cannot be decoded into; copying pictures instead");
+        mZeroCopyFailed = true;
+        return false;
+    }
+
+    pic->data[0] = dstY;
+    pic->data[1] = dstU;
+    pic->data[2] = dstV;
+    pic->stride[0] = yPlane.rowInc;
+    pic->stride[1] = uPlane.rowInc;
+    buffer->block = std::move(block);
+    buffer->view.emplace(std::move(wView));
+    return true;
+}
+
+bool C2SoftDav1dDec::allocPictureFromHeap(Dav1dPicture* pic, PictureBuffer* buffer) {
+    // Same layout as the default dav1d allocator.
+    const bool hbd = pic->p.bpc > 8;
+    const bool hasChroma = pic->p.layout != DAV1D_PIXEL_LAYOUT_I400;
+    const bool ssVer = pic->p.layout == DAV1D_PIXEL_LAYOUT_I420;
+    const bool ssHor = pic->p.layout != DAV1D_PIXEL_LAYOUT_I444;
+    const size_t alignedWidth = align(pic->p.w, 128);
+    const size_t alignedHeight = align(pic->p.h, 128);
+    size_t yStride = alignedWidth << hbd;
+    size_t uvStride = hasChroma ? yStride >> ssHor : 0;
+    // avoid strides that map rows of a superblock to the same cache sets
+    if (!(yStride & 1023)) yStride += DAV1D_PICTURE_ALIGNMENT;
+    if (hasChroma && !(uvStride & 1023)) uvStride += DAV1D_PICTURE_ALIGNMENT;
+    const size_t ySize = yStride * alignedHeight;
+    const size_t uvSize = uvStride * (alignedHeight >> ssVer);
+    const size_t size = ySize + 2 * uvSize + DAV1D_PICTURE_ALIGNMENT;
+
+    if (buffer->heapSize != size) {
+        buffer->heap.reset(new (std::nothrow) uint8_t[size + DAV1D_PICTURE_ALIGNMENT]);
+        if (!buffer->heap) {
+            ALOGE("Error allocating picture buffer (%zu bytes)", size);
+            buffer->heapSize = 0;
+            return false;
+        }
+        buffer->heapSize = size;
+    }
+    uint8_t* data = (uint8_t*)align((uintptr_t)buffer->heap.get(), DAV1D_PICTURE_ALIGNMENT);
+    pic->data[0] = data;
+    pic->data[1] = hasChroma ? data + ySize : nullptr;
+    pic->data[2] = hasChroma ? data + ySize + uvSize : nullptr;
+    pic->stride[0] = yStride;
+    pic->stride[1] = uvStride;
+    return true;
+}
+
 void fillEmptyWork(const std::unique_ptr<C2Work>& work) {
     uint32_t flags = 0;
     if (work->input.flags & C2FrameData::FLAG_END_OF_STREAM) {
@@ -628,6 +782,7 @@ void C2SoftDav1dDec::process(const std::unique_ptr<C2Work>& work,
         work->result = C2_BAD_VALUE;
         return;
     }
+    mOutputPool = pool;
 
     size_t inOffset = 0u;
     size_t inSize = 0u;
@@ -999,6 +1154,25 @@ bool C2SoftDav1dDec::outputBuffer(const std::shared_ptr<C2BlockPool>& pool,
         mHalPixelFormat = format;
     }
 
+    PictureBuffer* picture = mZeroCopy ? static_cast<PictureBuffer*>(img.allocator_data) : nullptr;
+    if (picture && picture->block) {
+        // dav1d decoded the picture straight into an output block, and is done writing to it.
+        // The block stays mapped until ReleasePicture(), see PictureBuffer::view.
+        mOutputBufferIndex = out_frameIndex;
+        ALOGV("output a 8bit picture %dx%d from dav1d without copy "
+              "(mInputBufferIndex=%d,mOutputBufferIndex=%d).",
+              mWidth, mHeight, mInputBufferIndex, mOutputBufferIndex);
+#ifdef FILE_DUMP_ENABLE
+        mC2SoftDav1dDump.dumpOutput<uint8_t>((const uint8_t*)img.data[0],
+                                             (const uint8_t*)img.data[1],
+                                             (const uint8_t*)img.data[2], img.stride[0],
+                                             img.stride[1], img.stride[1], mWidth, mHeight);
+#endif
+        finishWork(out_frameIndex, work, picture->block, img);
+        dav1d_picture_unref(&img);
+        return true;
+    }
+
     C2MemoryUsage usage = {C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE};
 
     // We always create a graphic block that is width aligned to 16 and height
@@ -1174,6 +1348,7 @@ c2_status_t C2SoftDav1dDec::drainInternal(uint32_t drainMode,
 }
 
 c2_status_t C2SoftDav1dDec::drain(uint32_t drainMode, const std::shared_ptr<C2BlockPool>& pool) {
+    mOutputPool = pool;
     return drainInternal(drainMode, pool, nullptr);
 }
 
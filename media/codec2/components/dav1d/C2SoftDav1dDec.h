@@ -20,6 +20,8 @@
 #include <inttypes.h>
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <media/stagefright/foundation/ColorUtils.h>
 
@@ -52,6 +54,8 @@ struct C2SoftDav1dDec : public SimpleC2Component {
     // End SimpleC2Component overrides.
 
   private:
+    struct PictureBuffer;
+
     std::shared_ptr<IntfImpl> mIntf;
 
     int mInputBufferIndex = 0;
@@ -97,6 +101,17 @@ struct C2SoftDav1dDec : public SimpleC2Component {
         }
     } mBitstreamColorAspects;
 
+    // Whether 8-bit 4:2:0 pictures are decoded straight into output blocks of mOutputPool.
+    bool mZeroCopy = false;
+    // Set once output blocks turned out not to fit dav1d's requirements.
+    bool mZeroCopyFailed = false;
+    // Output pool of the ongoing process() or drain() call.
+    std::shared_ptr<C2BlockPool> mOutputPool;
+    // Heap buffers released by dav1d, kept for the next pictures of the same size. dav1d frame
+    // threads release pictures too, so these are guarded by mFreeHeapBuffersLock.
+    std::mutex mFreeHeapBuffersLock;
+    std::vector<std::unique_ptr<PictureBuffer>> mFreeHeapBuffers;
+
     nsecs_t mTimeStart = 0;  // Time at the start of decode()
     nsecs_t mTimeEnd = 0;    // Time at the end of decode()
 
@@ -119,6 +134,12 @@ struct C2SoftDav1dDec : public SimpleC2Component {
 
     void flushDav1d();
 
+    // Dav1dPicAllocator callbacks; |cookie| is the component.
+    static int AllocPicture(Dav1dPicture* pic, void* cookie);
+    static void ReleasePicture(Dav1dPicture* pic, void* cookie);
+    bool allocPictureFromBlock(Dav1dPicture* pic, PictureBuffer* buffer);
+    bool allocPictureFromHeap(Dav1dPicture* pic, PictureBuffer* buffer);
+
 #ifdef FILE_DUMP_ENABLE
     C2SoftDav1dDump mC2SoftDav1dDump;
 #endif
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "C2SoftDav1dDecTest"
+#include <log/log.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <android-base/file.h>
+#include <android-base/properties.h>
+#include <gtest/gtest.h>
+
+#include <C2ComponentFactory.h>
+#include <C2Config.h>
+#include <C2PlatformSupport.h>
+
+using namespace android;
+using namespace std::chrono_literals;
+
+extern "C" ::C2ComponentFactory* CreateCodec2Factory();
+extern "C" void DestroyCodec2Factory(::C2ComponentFactory* factory);
+
+/*
+$ atest C2SoftDav1dDecTest
+
+Decodes the AV1 streams of the codec2 VTS resources with dav1d decoding into
+output blocks (debug.dav1d.zerocopy=true) and into heap pictures that are
+copied out (debug.dav1d.zerocopy=false), and compares the output frames. The
+streams have hidden reference frames that are shown later, so output blocks
+are read by dav1d as references after they have been output.
+*/
+
+namespace {
+
+constexpr char kZeroCopyProperty[] = "debug.dav1d.zerocopy";
+// Info file flag of codec config frames.
+constexpr uint32_t kInfoFlagCodecConfig = 0x20;
+
+struct Frame {
+    uint64_t timestamp;
+    // FNV-1a hash of the cropped Y, U and V planes
+    uint64_t hash;
+    // whether the frame was decoded straight into its output block
+    bool zeroCopy;
+};
+
+uint64_t HashPlane(uint64_t hash, const uint8_t* data, size_t rowInc, size_t colInc,
+                   size_t width, size_t height) {
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            hash = (hash ^ data[y * rowInc + x * colInc]) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+class Listener : public C2Component::Listener {
+public:
+    void onWorkDone_nb(std::weak_ptr<C2Component>,
+                       std::list<std::unique_ptr<C2Work>> workItems) override {
+        std::lock_guard<std::mutex> lock(mLock);
+        mWorks.splice(mWorks.end(), workItems);
+        mCondition.notify_all();
+    }
+
+    void onTripped_nb(std::weak_ptr<C2Component>,
+                      std::vector<std::shared_ptr<C2SettingResult>>) override {}
+
+    void onError_nb(std::weak_ptr<C2Component>, uint32_t errorCode) override {
+        std::lock_guard<std::mutex> lock(mLock);
+        mError = (c2_status_t)errorCode;
+        mCondition.notify_all();
+    }
+
+    // Waits for the end of stream, and returns all finished works.
+    bool waitForEos(std::list<std::unique_ptr<C2Work>>* works) {
+        std::unique_lock<std::mutex> lock(mLock);
+        bool eos = mCondition.wait_for(lock, 10s, [this] {
+            return mError != C2_OK || (!mWorks.empty() && !mWorks.back()->worklets.empty() &&
+                                       (mWorks.back()->worklets.front()->output.flags &
+                                        C2FrameData::FLAG_END_OF_STREAM));
+        });
+        works->splice(works->end(), mWorks);
+        return eos && mError == C2_OK;
+    }
+
+private:
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::list<std::unique_ptr<C2Work>> mWorks;
+    c2_status_t mError = C2_OK;
+};
+
+class C2SoftDav1dDecTest : public ::testing::TestWithParam<std::string> {
+public:
+    void SetUp() override {
+        mFactory = CreateCodec2Factory();
+        ASSERT_NE(mFactory, nullptr);
+        mZeroCopy = base::GetProperty(kZeroCopyProperty, "");
+    }
+
+    void TearDown() override {
+        base::SetProperty(kZeroCopyProperty, mZeroCopy);
+        if (mFactory) {
+            DestroyCodec2Factory(mFactory);
+        }
+    }
+
+    void decode(bool zeroCopy, std::vector<Frame>* frames);
+
+private:
+    ::C2ComponentFactory* mFactory = nullptr;
+    // value of kZeroCopyProperty before the test
+    std::string mZeroCopy;
+};
+
+void C2SoftDav1dDecTest::decode(bool zeroCopy, std::vector<Frame>* frames) {
+    // The property is read when the decoder is created, on start().
+    ASSERT_TRUE(base::SetProperty(kZeroCopyProperty, zeroCopy ? "true" : "false"));
+
+    std::shared_ptr<C2Component> component;
+    ASSERT_EQ(C2_OK, mFactory->createComponent(0, &component,
+                                               std::default_delete<C2Component>()));
+    std::shared_ptr<Listener> listener = std::make_shared<Listener>();
+    ASSERT_EQ(C2_OK, component->setListener_vb(listener, C2_MAY_BLOCK));
+    std::shared_ptr<C2BlockPool> linearPool;
+    ASSERT_EQ(C2_OK, GetCodec2BlockPool(C2BlockPool::BASIC_LINEAR, component, &linearPool));
+    ASSERT_EQ(C2_OK, component->start());
+
+    const std::string dir = base::GetExecutableDirectory() + "/";
+    std::ifstream stream(dir + GetParam() + ".av1", std::ios::binary);
+    std::ifstream info(dir + GetParam() + ".info");
+    ASSERT_TRUE(stream.is_open() && info.is_open()) << "missing resources for " << GetParam();
+
+    std::list<std::unique_ptr<C2Work>> items;
+    uint32_t size, flags;
+    uint64_t timestamp;
+    for (uint64_t frameIndex = 0; info >> size >> flags >> timestamp; ++frameIndex) {
+        std::unique_ptr<C2Work> work(new C2Work);
+        work->input.flags = (flags & kInfoFlagCodecConfig) ? C2FrameData::FLAG_CODEC_CONFIG
+                                                           : (C2FrameData::flags_t)0;
+        work->input.ordinal.timestamp = timestamp;
+        work->input.ordinal.frameIndex = frameIndex;
+        if (size > 0) {
+            std::shared_ptr<C2LinearBlock> block;
+            ASSERT_EQ(C2_OK, linearPool->fetchLinearBlock(
+                                     size, {C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE},
+                                     &block));
+            C2WriteView view = block->map().get();
+            ASSERT_EQ(C2_OK, view.error());
+            stream.read((char*)view.base(), size);
+            ASSERT_EQ((std::streamsize)size, stream.gcount());
+            work->input.buffers.push_back(
+                    C2Buffer::CreateLinearBuffer(block->share(0, size, C2Fence())));
+        }
+        work->worklets.emplace_back(new C2Worklet);
+        items.push_back(std::move(work));
+    }
+    ASSERT_FALSE(items.empty());
+    items.back()->input.flags =
+            (C2FrameData::flags_t)(items.back()->input.flags | C2FrameData::FLAG_END_OF_STREAM);
+    ASSERT_EQ(C2_OK, component->queue_nb(&items));
+
+    std::list<std::unique_ptr<C2Work>> works;
+    ASSERT_TRUE(listener->waitForEos(&works)) << "decoding did not finish";
+    for (const std::unique_ptr<C2Work>& work : works) {
+        ASSERT_EQ(C2_OK, work->result);
+        if (work->worklets.empty() || work->worklets.front()->output.buffers.empty()) {
+            continue;
+        }
+        const C2ConstGraphicBlock& block =
+                work->worklets.front()->output.buffers.front()->data().graphicBlocks().front();
+        const C2GraphicView view = block.map().get();
+        ASSERT_EQ(C2_OK, view.error());
+        const C2PlanarLayout& layout = view.layout();
+        ASSERT_EQ(C2PlanarLayout::TYPE_YUV, layout.type);
+        const size_t width = view.crop().width;
+        const size_t height = view.crop().height;
+
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t plane : {C2PlanarLayout::PLANE_Y, C2PlanarLayout::PLANE_U,
+                               C2PlanarLayout::PLANE_V}) {
+            const C2PlaneInfo& info = layout.planes[plane];
+            ASSERT_EQ(8u, info.bitDepth);
+            hash = HashPlane(hash, view.data()[plane], info.rowInc, info.colInc,
+                             width / info.colSampling, height / info.rowSampling);
+        }
+        // Blocks decoded into by dav1d have 2 rows more than the 128-aligned height, copies
+        // only have room for the picture itself.
+        const uint8_t* y = view.data()[C2PlanarLayout::PLANE_Y];
+        const uint8_t* chroma = std::min(view.data()[C2PlanarLayout::PLANE_U],
+                                         view.data()[C2PlanarLayout::PLANE_V]);
+        const size_t yRows = (chroma - y) / layout.planes[C2PlanarLayout::PLANE_Y].rowInc;
+        frames->push_back({work->worklets.front()->output.ordinal.timestamp.peeku(), hash,
+                           yRows >= ((height + 127) & ~(size_t)127) + 2});
+    }
+
+    ASSERT_EQ(C2_OK, component->stop());
+    ASSERT_EQ(C2_OK, component->release());
+}
+
+TEST_P(C2SoftDav1dDecTest, ZeroCopyMatchesCopy) {
+    std::vector<Frame> copied;
+    ASSERT_NO_FATAL_FAILURE(decode(false /* zeroCopy */, &copied));
+    std::vector<Frame> zeroCopied;
+    ASSERT_NO_FATAL_FAILURE(decode(true /* zeroCopy */, &zeroCopied));
+
+    ASSERT_FALSE(copied.empty());
+    ASSERT_EQ(copied.size(), zeroCopied.size());
+    size_t numZeroCopied = 0;
+    for (size_t i = 0; i < copied.size(); ++i) {
+        EXPECT_EQ(copied[i].timestamp, zeroCopied[i].timestamp) << "frame " << i;
+        EXPECT_EQ(copied[i].hash, zeroCopied[i].hash) << "frame " << i;
+        numZeroCopied += zeroCopied[i].zeroCopy;
+    }
+    if (numZeroCopied == 0) {
+        GTEST_SKIP() << "output blocks cannot be decoded into on this device";
+    }
+    ALOGD("%zu of %zu frames of %s were decoded into output blocks", numZeroCopied,
+          zeroCopied.size(), GetParam().c_str());
+}
+
+INSTANTIATE_TEST_SUITE_P(Streams, C2SoftDav1dDecTest,
+                         ::testing::Values("bbb_av1_176_144", "bbb_av1_640_360"));
+
+}  // namespace
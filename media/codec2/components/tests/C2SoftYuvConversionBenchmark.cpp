@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <SimpleC2Component.h>
+
+namespace android {
+
+void convertYUV420Planar16ToY410(uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+                                 const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+                                 size_t srcVStride, size_t dstStride, size_t width, size_t height);
+void convertYUV420Planar16ToRGBA1010102(
+        uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+        const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+        size_t srcVStride, size_t dstStride, size_t width,
+        size_t height,
+        std::shared_ptr<const C2ColorAspectsStruct> aspects);
+
+}  // namespace android
+
+using namespace android;
+
+/*
+$ atest C2SoftYuvConversionBenchmark
+
+Reports the time to convert one 10-bit 4:2:0 frame of state.range(0) x state.range(1) pixels;
+frames of 4K and above are converted on several threads.
+*/
+
+namespace {
+
+struct Frame {
+    Frame(size_t width, size_t height)
+        : mWidth(width),
+          mHeight(height),
+          mY(width * height),
+          mU((width + 1) / 2 * ((height + 1) / 2)),
+          mV(mU.size()) {
+        std::minstd_rand rng(42);
+        for (auto *plane : { &mY, &mU, &mV }) {
+            for (uint16_t &sample : *plane) {
+                sample = rng() & 0x3FF;
+            }
+        }
+    }
+
+    size_t uvStride() const { return (mWidth + 1) / 2; }
+
+    const size_t mWidth;
+    const size_t mHeight;
+    std::vector<uint16_t> mY;
+    std::vector<uint16_t> mU;
+    std::vector<uint16_t> mV;
+};
+
+void SetProcessed(benchmark::State &state, const Frame &frame) {
+    state.SetItemsProcessed(state.iterations() * frame.mWidth * frame.mHeight);
+}
+
+}  // namespace
+
+static void BM_Y410(benchmark::State &state) {
+    Frame frame(state.range(0), state.range(1));
+    // one spare row as the conversion works on pairs of rows
+    std::vector<uint32_t> dst(frame.mWidth * (frame.mHeight + 1));
+    for (auto _ : state) {
+        convertYUV420Planar16ToY410(dst.data(), frame.mY.data(), frame.mU.data(),
+                                    frame.mV.data(), frame.mWidth, frame.uvStride(),
+                                    frame.uvStride(), frame.mWidth, frame.mWidth, frame.mHeight);
+        benchmark::ClobberMemory();
+    }
+    SetProcessed(state, frame);
+}
+
+static void BM_RGBA1010102(benchmark::State &state) {
+    Frame frame(state.range(0), state.range(1));
+    std::vector<uint32_t> dst(frame.mWidth * (frame.mHeight + 1));
+    for (auto _ : state) {
+        convertYUV420Planar16ToRGBA1010102(dst.data(), frame.mY.data(), frame.mU.data(),
+                                           frame.mV.data(), frame.mWidth, frame.uvStride(),
+                                           frame.uvStride(), frame.mWidth, frame.mWidth,
+                                           frame.mHeight, nullptr);
+        benchmark::ClobberMemory();
+    }
+    SetProcessed(state, frame);
+}
+
+static void BM_YV12(benchmark::State &state) {
+    Frame frame(state.range(0), state.range(1));
+    std::vector<uint8_t> dstY(frame.mY.size());
+    std::vector<uint8_t> dstU(frame.mU.size());
+    std::vector<uint8_t> dstV(frame.mV.size());
+    for (auto _ : state) {
+        convertYUV420Planar16ToYV12(dstY.data(), dstU.data(), dstV.data(), frame.mY.data(),
+                                    frame.mU.data(), frame.mV.data(), frame.mWidth,
+                                    frame.uvStride(), frame.uvStride(), frame.mWidth,
+                                    frame.uvStride(), frame.mWidth, frame.mHeight);
+        benchmark::ClobberMemory();
+    }
+    SetProcessed(state, frame);
+}
+
+static void BM_P010(benchmark::State &state) {
+    Frame frame(state.range(0), state.range(1));
+    std::vector<uint16_t> dstY(frame.mY.size());
+    std::vector<uint16_t> dstUV(2 * frame.mU.size());
+    for (auto _ : state) {
+        convertYUV420Planar16ToP010(dstY.data(), dstUV.data(), frame.mY.data(), frame.mU.data(),
+                                    frame.mV.data(), frame.mWidth, frame.uvStride(),
+                                    frame.uvStride(), frame.mWidth, 2 * frame.uvStride(),
+                                    frame.mWidth, frame.mHeight);
+        benchmark::ClobberMemory();
+    }
+    SetProcessed(state, frame);
+}
+
+static void BM_Planar8ToYV12(benchmark::State &state) {
+    size_t width = state.range(0);
+    size_t height = state.range(1);
+    size_t uvSize = (width + 1) / 2 * ((height + 1) / 2);
+    std::vector<uint8_t> src(width * height + 2 * uvSize, 0x80);
+    std::vector<uint8_t> dst(src.size());
+    for (auto _ : state) {
+        convertYUV420Planar8ToYV12(dst.data(), dst.data() + width * height,
+                                   dst.data() + width * height + uvSize, src.data(),
+                                   src.data() + width * height,
+                                   src.data() + width * height + uvSize, width, (width + 1) / 2,
+                                   (width + 1) / 2, width, (width + 1) / 2, (width + 1) / 2,
+                                   width, height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+static void FrameSizes(benchmark::internal::Benchmark *b) {
+    b->Args({1280, 720})->Args({1920, 1080})->Args({3840, 2160})->Args({7680, 4320});
+    b->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
+
+BENCHMARK(BM_Y410)->Apply(FrameSizes);
+BENCHMARK(BM_RGBA1010102)->Apply(FrameSizes);
+BENCHMARK(BM_YV12)->Apply(FrameSizes);
+BENCHMARK(BM_P010)->Apply(FrameSizes);
+BENCHMARK(BM_Planar8ToYV12)->Apply(FrameSizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "C2SoftYuvConversionTest"
+
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <log/log.h>
+
+#include <SimpleC2Component.h>
+
+namespace android {
+
+// not declared in SimpleC2Component.h; convertYUV420Planar16ToY410OrRGBA1010102() picks one
+// depending on the platform version
+void convertYUV420Planar16ToY410(uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+                                 const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+                                 size_t srcVStride, size_t dstStride, size_t width, size_t height);
+void convertYUV420Planar16ToRGBA1010102(
+        uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+        const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+        size_t srcVStride, size_t dstStride, size_t width,
+        size_t height,
+        std::shared_ptr<const C2ColorAspectsStruct> aspects);
+
+}  // namespace android
+
+using namespace android;
+
+namespace {
+
+// Scalar versions of the conversions as they were before vectorization. The vectorized ones
+// must match them bit for bit, including the rows and columns they write past an odd frame
+// size.
+
+void RefPlanar16ToY410(uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+                       const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+                       size_t srcVStride, size_t dstStride, size_t width, size_t height) {
+    for (size_t y = 0; y < height; y += 2) {
+        uint32_t *dstTop = dst;
+        uint32_t *dstBot = dst + dstStride;
+        const uint16_t *ySrcTop = srcY;
+        const uint16_t *ySrcBot = srcY + srcYStride;
+        size_t x = 0;
+        for (; x + 4 <= width; x += 4) {
+            uint32_t uv0 = (srcU[x / 2] & 0x3FF) | ((srcV[x / 2] & 0x3FF) << 20);
+            uint32_t uv1 = srcU[x / 2 + 1] | ((uint32_t)srcV[x / 2 + 1] << 20);
+            *dstTop++ = 3u << 30 | ((ySrcTop[x] & 0x3FF) << 10) | uv0;
+            *dstTop++ = 3u << 30 | ((uint32_t)ySrcTop[x + 1] << 10) | uv0;
+            *dstTop++ = 3u << 30 | ((ySrcTop[x + 2] & 0x3FF) << 10) | uv1;
+            *dstTop++ = 3u << 30 | ((uint32_t)ySrcTop[x + 3] << 10) | uv1;
+            *dstBot++ = 3u << 30 | ((ySrcBot[x] & 0x3FF) << 10) | uv0;
+            *dstBot++ = 3u << 30 | ((uint32_t)ySrcBot[x + 1] << 10) | uv0;
+            *dstBot++ = 3u << 30 | ((ySrcBot[x + 2] & 0x3FF) << 10) | uv1;
+            *dstBot++ = 3u << 30 | ((uint32_t)ySrcBot[x + 3] << 10) | uv1;
+        }
+        if (x < width) {
+            uint32_t uv0 = (srcU[x / 2] & 0x3FF) | ((srcV[x / 2] & 0x3FF) << 20);
+            *dstTop++ = ((ySrcTop[x] & 0x3FF) << 10) | uv0;
+            *dstTop++ = ((uint32_t)ySrcTop[x + 1] << 10) | uv0;
+            *dstBot++ = ((ySrcBot[x] & 0x3FF) << 10) | uv0;
+            *dstBot++ = ((uint32_t)ySrcBot[x + 1] << 10) | uv0;
+        }
+        srcY += srcYStride * 2;
+        srcU += srcUStride;
+        srcV += srcVStride;
+        dst += dstStride * 2;
+    }
+}
+
+uint32_t RefRGBA1010102(int32_t yMult, int32_t u_b, int32_t uv_g, int32_t v_r) {
+    int32_t b = std::clamp((yMult + u_b) / 1024, 0, 1023);
+    int32_t g = std::clamp((yMult + uv_g) / 1024, 0, 1023);
+    int32_t r = std::clamp((yMult + v_r) / 1024, 0, 1023);
+    return 3u << 30 | (b << 20) | (g << 10) | r;
+}
+
+void RefPlanar16ToRGBA1010102(uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+                              const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+                              size_t srcVStride, size_t dstStride, size_t width, size_t height,
+                              const int32_t coeffs[6]) {
+    const int32_t _y = coeffs[0], _r_v = coeffs[1], _g_u = coeffs[2], _g_v = coeffs[3],
+            _b_u = coeffs[4], _c16 = coeffs[5];
+    for (size_t y = 0; y < height; y += 2) {
+        for (size_t x = 0; x < width; x += 2) {
+            int32_t u = srcU[x / 2] - 512;
+            int32_t v = srcV[x / 2] - 512;
+            int32_t u_b = u * _b_u;
+            int32_t uv_g = u * -_g_u + v * -_g_v;
+            int32_t v_r = v * _r_v;
+            for (size_t row = 0; row < 2; ++row) {
+                for (size_t col = 0; col < 2; ++col) {
+                    int32_t yMult = (srcY[row * srcYStride + x + col] - _c16) * _y + 512;
+                    dst[row * dstStride + x + col] = RefRGBA1010102(yMult, u_b, uv_g, v_r);
+                }
+            }
+        }
+        srcY += srcYStride * 2;
+        srcU += srcUStride;
+        srcV += srcVStride;
+        dst += dstStride * 2;
+    }
+}
+
+// BT.709 limited range, which FillMissingColorAspects() picks for 1080p frames
+constexpr int32_t kBt709LimitedCoeffs[6] = { 1196, 1841, 219, 547, 2169, 64 };
+// BT.2020 limited range, picked for UHD frames
+constexpr int32_t kBt2020LimitedCoeffs[6] = { 1196, 1724, 192, 668, 2200, 64 };
+// BT.601 limited range, picked for SD frames
+constexpr int32_t kBt601LimitedCoeffs[6] = { 1196, 1639, 402, 835, 2072, 64 };
+
+const int32_t *CoeffsForSize(size_t width, size_t height) {
+    if (width >= 3840 || height >= 3840 || width * height >= 3840 * 1634) {
+        return kBt2020LimitedCoeffs;
+    } else if ((width <= 720 && height <= 576) || (height <= 720 && width <= 576)) {
+        return kBt601LimitedCoeffs;
+    }
+    return kBt709LimitedCoeffs;
+}
+
+// Padding around every plane, so that writes past the frame are compared as well.
+constexpr size_t kPadding = 32;
+
+}  // namespace
+
+// width, height, maximum sample value
+class C2SoftYuvConversionTest
+    : public ::testing::TestWithParam<std::tuple<size_t, size_t, uint16_t>> {
+  protected:
+    void SetUp() override {
+        std::tie(mWidth, mHeight, mMaxValue) = GetParam();
+        mYStride = mWidth + kPadding;
+        mUVStride = (mWidth + 1) / 2 + kPadding;
+        size_t rows = mHeight + kPadding;
+        std::mt19937 rng(mWidth * 65536 + mHeight);
+        std::uniform_int_distribution<uint32_t> dist(0, mMaxValue);
+        for (auto *plane : { &mSrcY, &mSrcU, &mSrcV }) {
+            plane->resize((plane == &mSrcY ? mYStride : mUVStride) * rows);
+            for (uint16_t &sample : *plane) {
+                sample = dist(rng);
+            }
+        }
+    }
+
+    size_t mWidth;
+    size_t mHeight;
+    uint16_t mMaxValue;
+    size_t mYStride;
+    size_t mUVStride;
+    std::vector<uint16_t> mSrcY;
+    std::vector<uint16_t> mSrcU;
+    std::vector<uint16_t> mSrcV;
+};
+
+TEST_P(C2SoftYuvConversionTest, Y410) {
+    if (mWidth < 3) {
+        GTEST_SKIP() << "the scalar conversion requires a width of at least 3";
+    }
+    size_t dstStride = mWidth + kPadding;
+    std::vector<uint32_t> expected(dstStride * (mHeight + kPadding), 0xDEADBEEF);
+    std::vector<uint32_t> actual(expected);
+    RefPlanar16ToY410(expected.data(), mSrcY.data(), mSrcU.data(), mSrcV.data(), mYStride,
+                      mUVStride, mUVStride, dstStride, mWidth, mHeight);
+    convertYUV420Planar16ToY410(actual.data(), mSrcY.data(), mSrcU.data(), mSrcV.data(),
+                                mYStride, mUVStride, mUVStride, dstStride, mWidth, mHeight);
+    ASSERT_EQ(expected, actual);
+}
+
+TEST_P(C2SoftYuvConversionTest, RGBA1010102) {
+    size_t dstStride = mWidth + kPadding;
+    std::vector<uint32_t> expected(dstStride * (mHeight + kPadding), 0xDEADBEEF);
+    std::vector<uint32_t> actual(expected);
+    RefPlanar16ToRGBA1010102(expected.data(), mSrcY.data(), mSrcU.data(), mSrcV.data(),
+                             mYStride, mUVStride, mUVStride, dstStride, mWidth, mHeight,
+                             CoeffsForSize(mWidth, mHeight));
+    convertYUV420Planar16ToRGBA1010102(actual.data(), mSrcY.data(), mSrcU.data(), mSrcV.data(),
+                                       mYStride, mUVStride, mUVStride, dstStride, mWidth,
+                                       mHeight, nullptr);
+    ASSERT_EQ(expected, actual);
+}
+
+TEST_P(C2SoftYuvConversionTest, YV12) {
+    size_t dstYStride = mWidth + kPadding;
+    size_t dstUVStride = (mWidth + 1) / 2 + kPadding;
+    size_t rows = mHeight + kPadding;
+    for (bool isMonochrome : { false, true }) {
+        std::vector<uint8_t> expected((dstYStride + 2 * dstUVStride) * rows, 0xA5);
+        std::vector<uint8_t> actual(expected);
+        uint8_t *dst[2][3];
+        for (int i = 0; i < 2; ++i) {
+            uint8_t *base = i ? actual.data() : expected.data();
+            dst[i][0] = base;
+            dst[i][1] = base + dstYStride * rows;
+            dst[i][2] = dst[i][1] + dstUVStride * rows;
+        }
+        for (size_t y = 0; y < mHeight; ++y) {
+            for (size_t x = 0; x < mWidth; ++x) {
+                dst[0][0][y * dstYStride + x] = (uint8_t)(mSrcY[y * mYStride + x] >> 2);
+            }
+        }
+        for (size_t y = 0; y < (mHeight + 1) / 2; ++y) {
+            for (size_t x = 0; x < (mWidth + 1) / 2; ++x) {
+                dst[0][1][y * dstUVStride + x] =
+                        isMonochrome ? 128 : (uint8_t)(mSrcU[y * mUVStride + x] >> 2);
+                dst[0][2][y * dstUVStride + x] =
+                        isMonochrome ? 128 : (uint8_t)(mSrcV[y * mUVStride + x] >> 2);
+            }
+        }
+        convertYUV420Planar16ToYV12(dst[1][0], dst[1][1], dst[1][2], mSrcY.data(),
+                                    mSrcU.data(), mSrcV.data(), mYStride, mUVStride, mUVStride,
+                                    dstYStride, dstUVStride, mWidth, mHeight, isMonochrome);
+        ASSERT_EQ(expected, actual) << "isMonochrome=" << isMonochrome;
+    }
+}
+
+TEST_P(C2SoftYuvConversionTest, P010) {
+    size_t dstYStride = mWidth + kPadding;
+    size_t dstUVStride = 2 * ((mWidth + 1) / 2) + kPadding;
+    size_t rows = mHeight + kPadding;
+    for (bool isMonochrome : { false, true }) {
+        std::vector<uint16_t> expected((dstYStride + dstUVStride) * rows, 0xA5A5);
+        std::vector<uint16_t> actual(expected);
+        uint16_t *expectedUV = expected.data() + dstYStride * rows;
+        for (size_t y = 0; y < mHeight; ++y) {
+            for (size_t x = 0; x < mWidth; ++x) {
+                expected[y * dstYStride + x] = mSrcY[y * mYStride + x] << 6;
+            }
+        }
+        for (size_t y = 0; y < (mHeight + 1) / 2; ++y) {
+            for (size_t x = 0; x < (mWidth + 1) / 2; ++x) {
+                expectedUV[y * dstUVStride + 2 * x] =
+                        isMonochrome ? 512 << 6 : mSrcU[y * mUVStride + x] << 6;
+                expectedUV[y * dstUVStride + 2 * x + 1] =
+                        isMonochrome ? 512 << 6 : mSrcV[y * mUVStride + x] << 6;
+            }
+        }
+        convertYUV420Planar16ToP010(actual.data(), actual.data() + dstYStride * rows,
+                                    mSrcY.data(), mSrcU.data(), mSrcV.data(), mYStride,
+                                    mUVStride, mUVStride, dstYStride, dstUVStride, mWidth,
+                                    mHeight, isMonochrome);
+        ASSERT_EQ(expected, actual) << "isMonochrome=" << isMonochrome;
+    }
+}
+
+TEST_P(C2SoftYuvConversionTest, Planar8ToYV12) {
+    std::vector<uint8_t> srcY(mSrcY.begin(), mSrcY.end());
+    std::vector<uint8_t> srcU(mSrcU.begin(), mSrcU.end());
+    std::vector<uint8_t> srcV(mSrcV.begin(), mSrcV.end());
+    size_t dstYStride = mWidth + kPadding;
+    size_t dstUVStride = (mWidth + 1) / 2 + kPadding;
+    size_t rows = mHeight + kPadding;
+    std::vector<uint8_t> expected((dstYStride + 2 * dstUVStride) * rows, 0xA5);
+    std::vector<uint8_t> actual(expected);
+    for (size_t y = 0; y < mHeight; ++y) {
+        memcpy(&expected[y * dstYStride], &srcY[y * mYStride], mWidth);
+    }
+    uint8_t *expectedV = expected.data() + dstYStride * rows;
+    uint8_t *expectedU = expectedV + dstUVStride * rows;
+    for (size_t y = 0; y < (mHeight + 1) / 2; ++y) {
+        memcpy(expectedV + y * dstUVStride, &srcV[y * mUVStride], (mWidth + 1) / 2);
+        memcpy(expectedU + y * dstUVStride, &srcU[y * mUVStride], (mWidth + 1) / 2);
+    }
+    uint8_t *actualV = actual.data() + dstYStride * rows;
+    uint8_t *actualU = actualV + dstUVStride * rows;
+    convertYUV420Planar8ToYV12(actual.data(), actualU, actualV, srcY.data(), srcU.data(),
+                               srcV.data(), mYStride, mUVStride, mUVStride, dstYStride,
+                               dstUVStride, dstUVStride, mWidth, mHeight);
+    ASSERT_EQ(expected, actual);
+}
+
+// Sizes cover the vector remainders, odd dimensions, and frames large enough to be split
+// across threads.
+INSTANTIATE_TEST_SUITE_P(
+        C2SoftYuvConversion, C2SoftYuvConversionTest,
+        ::testing::Combine(::testing::Values(2, 7, 16, 33, 176, 1918),
+                           ::testing::Values(1, 2, 9, 144),
+                           ::testing::Values(1023, 65535)));
+
+INSTANTIATE_TEST_SUITE_P(
+        C2SoftYuvConversionUhd, C2SoftYuvConversionTest,
+        ::testing::Values(std::make_tuple(3840, 2160, 1023),
+                          std::make_tuple(4096, 2161, 65535)));
@@ -293,6 +293,9 @@ enum C2ParamIndexKind : C2Param::type_index_t {
 
     // allow tunnel peek behavior to be unspecified for app compatibility
     kParamIndexTunnelPeekMode, // tunnel mode, enum
+
+    // number of works processed together
+    kParamIndexProcessBatchSize, // u32
 };
 
 }
@@ -897,6 +900,18 @@ typedef C2GlobalParam<C2Tuning, C2EasyBoolValue, kParamIndexLowLatencyMode>
         C2GlobalLowLatencyModeTuning;
 constexpr char C2_PARAMKEY_LOW_LATENCY_MODE[] = "algo.low-latency";
 
+/**
+ * Process batch size.
+ *
+ * Maximum number of queued works the component processes in one pass before returning the
+ * completed works to the client in a single onWorkDone_nb() call. Larger batches reduce the
+ * per-work overhead for small frames at the cost of output latency. 1 (the default) returns each
+ * work as soon as it completes.
+ */
+typedef C2GlobalParam<C2Tuning, C2Uint32Value, kParamIndexProcessBatchSize>
+        C2ProcessBatchSizeTuning;
+constexpr char C2_PARAMKEY_PROCESS_BATCH_SIZE[] = "algo.process-batch-size";
+
 /**
  * Reference characteristics.
  *
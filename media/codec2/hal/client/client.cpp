@@ -210,6 +210,39 @@ c2_status_t GetC2Status(const ::ndk::ScopedAStatus &transStatus, const char *met
     return C2_OK;
 }
 
+// Memoizes the struct descriptors returned by another reflector, so that each
+// one is fetched from the service only once. Failures are not remembered.
+struct CachedParamReflector : public C2ParamReflector {
+    explicit CachedParamReflector(const std::shared_ptr<C2ParamReflector> &reflector)
+        : mReflector(reflector) {
+    }
+
+    std::unique_ptr<C2StructDescriptor> describe(
+            C2Param::CoreIndex coreIndex) const override {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mDescriptors.find(coreIndex.coreIndex());
+            if (it != mDescriptors.end()) {
+                return std::make_unique<C2StructDescriptor>(*it->second);
+            }
+        }
+        // Do not hold the lock during the transaction.
+        std::unique_ptr<C2StructDescriptor> descriptor = mReflector->describe(coreIndex);
+        if (descriptor) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDescriptors.try_emplace(
+                    coreIndex.coreIndex(),
+                    std::make_shared<const C2StructDescriptor>(*descriptor));
+        }
+        return descriptor;
+    }
+
+private:
+    const std::shared_ptr<C2ParamReflector> mReflector;
+    mutable std::mutex mMutex;
+    mutable std::map<uint32_t, std::shared_ptr<const C2StructDescriptor>> mDescriptors;
+};
+
 }  // unnamed namespace
 
 // This class caches a Codec2Client object and its component traits. The client
@@ -1452,6 +1485,18 @@ c2_status_t Codec2Client::copyBuffer(
 }
 
 std::shared_ptr<C2ParamReflector> Codec2Client::getParamReflector() {
+    // Struct descriptors of a store do not change for the lifetime of the
+    // service, so they are fetched once per client and shared by all
+    // components created in this process. A new client is created if the
+    // service dies.
+    std::lock_guard<std::mutex> lock(mParamReflectorMutex);
+    if (!mParamReflector) {
+        mParamReflector = std::make_shared<CachedParamReflector>(createParamReflector());
+    }
+    return mParamReflector;
+}
+
+std::shared_ptr<C2ParamReflector> Codec2Client::createParamReflector() const {
     // TODO: this is not meant to be exposed as C2ParamReflector on the client side; instead, it
     // should reflect the HAL API.
     struct HidlSimpleParamReflector : public C2ParamReflector {
@@ -324,6 +324,10 @@ protected:
 
     std::vector<C2Component::Traits> _listComponents(bool* success) const;
 
+    std::mutex mParamReflectorMutex;
+    std::shared_ptr<C2ParamReflector> mParamReflector;
+    std::shared_ptr<C2ParamReflector> createParamReflector() const;
+
     class Cache;
 };
 
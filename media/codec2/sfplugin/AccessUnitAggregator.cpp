@@ -0,0 +1,147 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "AccessUnitAggregator"
+
+#include <algorithm>
+
+#include <log/log.h>
+
+#include <media/stagefright/foundation/AMessage.h>
+
+#include "AccessUnitAggregator.h"
+
+namespace android {
+
+AccessUnitAggregator::AccessUnitAggregator()
+    : mUsage{0, 0},
+      mMaxAccessUnits(0u),
+      mMaxBytes(0u),
+      mPendingSince(0) {
+}
+
+void AccessUnitAggregator::init(
+        const std::shared_ptr<C2BlockPool> &pool,
+        C2MemoryUsage usage,
+        uint32_t maxAccessUnits,
+        uint32_t maxBytes) {
+    flush();
+    mBlockPool = pool;
+    mUsage = usage;
+    mMaxAccessUnits = maxAccessUnits;
+    mMaxBytes = maxBytes;
+    mAccessUnitInfos.reserve(maxAccessUnits);
+}
+
+void AccessUnitAggregator::reset() {
+    flush();
+    mBlockPool.reset();
+    mMaxAccessUnits = 0u;
+    mMaxBytes = 0u;
+}
+
+void AccessUnitAggregator::flush() {
+    mAccessUnitInfos.clear();
+    mWriteView.reset();
+    mCurrentBlock.reset();
+}
+
+AccessUnitAggregator::operator bool() const {
+    return mBlockPool && mMaxAccessUnits > 1u && mMaxBytes > 0u;
+}
+
+bool AccessUnitAggregator::hasPending() const {
+    return !mAccessUnitInfos.empty();
+}
+
+nsecs_t AccessUnitAggregator::pendingSince() const {
+    return mPendingSince;
+}
+
+c2_status_t AccessUnitAggregator::process(
+        const sp<MediaCodecBuffer> &buffer,
+        uint32_t flags,
+        std::list<std::unique_ptr<C2Work>> *items) {
+    int64_t timeUs;
+    if (!buffer->meta()->findInt64("timeUs", &timeUs)) {
+        return C2_BAD_VALUE;
+    }
+    size_t size = buffer->size();
+    if (size == 0u) {
+        return C2_OK;
+    }
+
+    if (mCurrentBlock && mWriteView->size() + size > mWriteView->capacity()) {
+        drain(items);
+    }
+    if (!mCurrentBlock) {
+        c2_status_t err = mBlockPool->fetchLinearBlock(
+                std::max(size_t(mMaxBytes), size), mUsage, &mCurrentBlock);
+        if (err != C2_OK) {
+            return err;
+        }
+        mWriteView = mCurrentBlock->map().get();
+        err = mWriteView->error();
+        if (err != C2_OK) {
+            mWriteView.reset();
+            mCurrentBlock.reset();
+            return err;
+        }
+        mWriteView->setOffset(0u);
+        mWriteView->setSize(0u);
+    }
+
+    if (mAccessUnitInfos.empty()) {
+        mPendingSince = systemTime(SYSTEM_TIME_MONOTONIC);
+    }
+    memcpy(mWriteView->base() + mWriteView->size(), buffer->data(), size);
+    mWriteView->setSize(mWriteView->size() + size);
+    mAccessUnitInfos.emplace_back(flags, size, timeUs);
+    ALOGV("appended access unit #%zu: size=%zu time=%lld flags=%u",
+            mAccessUnitInfos.size(), size, (long long)timeUs, flags);
+
+    if (mAccessUnitInfos.size() >= mMaxAccessUnits) {
+        drain(items);
+    }
+    return C2_OK;
+}
+
+void AccessUnitAggregator::drain(std::list<std::unique_ptr<C2Work>> *items) {
+    if (!mCurrentBlock) {
+        // No-op
+        return;
+    }
+    std::shared_ptr<C2Buffer> buffer = C2Buffer::CreateLinearBuffer(
+            mCurrentBlock->share(0, mWriteView->size(), C2Fence()));
+    buffer->setInfo(C2AccessUnitInfos::input::AllocShared(
+            mAccessUnitInfos.size(), 0u, mAccessUnitInfos));
+
+    std::unique_ptr<C2Work> work{std::make_unique<C2Work>()};
+    work->input.ordinal.timestamp = mAccessUnitInfos.front().timestamp;
+    work->input.ordinal.customOrdinal = mAccessUnitInfos.front().timestamp;
+    work->input.flags = (C2FrameData::flags_t)0;
+    work->input.buffers.push_back(std::move(buffer));
+    work->worklets.clear();
+    work->worklets.emplace_back(new C2Worklet);
+    items->push_back(std::move(work));
+
+    mAccessUnitInfos.clear();
+    mWriteView.reset();
+    mCurrentBlock.reset();
+}
+
+}  // namespace android
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ACCESS_UNIT_AGGREGATOR_H_
+#define ACCESS_UNIT_AGGREGATOR_H_
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <media/MediaCodecBuffer.h>
+#include <utils/Timers.h>
+
+#include <C2Config.h>
+#include <C2Work.h>
+
+namespace android {
+
+/**
+ * Packs compressed access units queued one at a time into a single linear
+ * block, described by C2AccessUnitInfos::input, so that a component
+ * supporting large audio frames receives one work item per batch instead of
+ * one per access unit.
+ *
+ * Work items produced by this class do not have a frame index assigned.
+ */
+class AccessUnitAggregator {
+public:
+    AccessUnitAggregator();
+
+    /**
+     * \param pool            pool to fetch the batch blocks from
+     * \param usage           memory usage of the batch blocks
+     * \param maxAccessUnits  maximum number of access units in a batch
+     * \param maxBytes        capacity of a batch block; larger access units
+     *                        are sent in a batch of their own
+     */
+    void init(
+            const std::shared_ptr<C2BlockPool> &pool,
+            C2MemoryUsage usage,
+            uint32_t maxAccessUnits,
+            uint32_t maxBytes);
+    void reset();
+    /**
+     * Drop the pending batch.
+     */
+    void flush();
+
+    explicit operator bool() const;
+
+    /**
+     * \return  true if there are access units waiting in the pending batch.
+     */
+    bool hasPending() const;
+
+    /**
+     * \return  monotonic time when the first access unit of the pending
+     *          batch was appended; only valid if hasPending() is true.
+     */
+    nsecs_t pendingSince() const;
+
+    /**
+     * Append the access unit in |buffer| to the pending batch. Batches that
+     * are full are appended to |items|.
+     *
+     * On error, the access unit is not appended to any batch, and the caller
+     * has to queue it by other means.
+     *
+     * \param buffer  buffer containing one access unit with "timeUs" set
+     * \param flags   C2FrameData flags of this access unit
+     */
+    c2_status_t process(
+            const sp<MediaCodecBuffer> &buffer,
+            uint32_t flags,
+            std::list<std::unique_ptr<C2Work>> *items);
+
+    /**
+     * Append the pending batch, if any, to |items|.
+     */
+    void drain(std::list<std::unique_ptr<C2Work>> *items);
+
+private:
+    std::shared_ptr<C2BlockPool> mBlockPool;
+    C2MemoryUsage mUsage;
+    uint32_t mMaxAccessUnits;
+    uint32_t mMaxBytes;
+    std::shared_ptr<C2LinearBlock> mCurrentBlock;
+    std::optional<C2WriteView> mWriteView;
+    std::vector<C2AccessUnitInfosStruct> mAccessUnitInfos;
+    nsecs_t mPendingSince;
+};
+
+}  // namespace android
+
+#endif  // ACCESS_UNIT_AGGREGATOR_H_
@@ -18,6 +18,7 @@
 #define LOG_TAG "CCodec"
 #include <utils/Log.h>
 
+#include <map>
 #include <sstream>
 #include <thread>
 
@@ -31,16 +32,21 @@
 #include <aidl/android/hardware/graphics/common/Dataspace.h>
 #include <aidl/android/media/IAidlGraphicBufferSource.h>
 #include <aidl/android/media/IAidlBufferSource.h>
+#include <aidl/android/media/BnResourceManagerClient.h>
+#include <aidl/android/media/IResourceManagerService.h>
+#include <android/binder_manager.h>
 #include <android/IOMXBufferSource.h>
 #include <android/hardware/media/c2/1.0/IInputSurface.h>
 #include <android/hardware/media/omx/1.0/IGraphicBufferSource.h>
 #include <android/hardware/media/omx/1.0/IOmx.h>
+#include <android-base/parseint.h>
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <cutils/properties.h>
 #include <gui/IGraphicBufferProducer.h>
 #include <gui/Surface.h>
 #include <gui/bufferqueue/1.0/H2BGraphicBufferProducer.h>
+#include <media/MediaResource.h>
 #include <media/omx/1.0/WOmxNode.h>
 #include <media/openmax/OMX_Core.h>
 #include <media/openmax/OMX_IndexExt.h>
@@ -58,6 +64,7 @@
 #include <media/stagefright/MediaCodecMetricsConstants.h>
 #include <media/stagefright/PersistentSurface.h>
 #include <media/stagefright/RenderedFrameInfo.h>
+#include <server_configurable_flags/get_flags.h>
 #include <utils/NativeHandle.h>
 
 #include "C2AidlNode.h"
@@ -66,6 +73,7 @@
 #include "CCodecConfig.h"
 #include "Codec2Mapper.h"
 #include "InputSurfaceWrapper.h"
+#include "WarmPool.h"
 
 extern "C" android::PersistentSurface *CreateInputSurface();
 
@@ -77,9 +85,14 @@ using android::base::StringPrintf;
 using ::android::hardware::media::c2::V1_0::IInputSurface;
 using ::aidl::android::media::IAidlBufferSource;
 using ::aidl::android::media::IAidlNode;
+using ::aidl::android::media::BnResourceManagerClient;
+using ::aidl::android::media::ClientInfoParcel;
+using ::aidl::android::media::IResourceManagerClient;
+using ::aidl::android::media::IResourceManagerService;
 using ::android::media::AidlGraphicBufferSource;
 using ::android::media::WAidlGraphicBufferSource;
 using ::android::media::aidl_conversion::fromAidlStatus;
+using server_configurable_flags::GetServerConfigurableFlag;
 
 typedef hardware::media::omx::V1_0::IGraphicBufferSource HGraphicBufferSource;
 typedef aidl::android::media::IAidlGraphicBufferSource AGraphicBufferSource;
@@ -158,6 +171,246 @@ private:
     Mutexed<std::set<wp<CCodec>>> mCodecsToWatch;
 };
 
+// CCodecComponentPool keeps released component instances, reset and
+// restored to the parameter values they were created with, so that later
+// CCodec instances of the same component can reuse them instead of creating
+// new ones.
+//
+// Only non-secure software components are kept. MediaCodec accounts for the
+// codec resources of each instance in use. While an instance is idle, the pool
+// registers it with the resource manager as a client of its own, so that a
+// reclaim on behalf of any process can release it. The pool is also emptied
+// when a codec of this process is reclaimed, when creating a component runs
+// out of memory, and after an idle timeout.
+class CCodecComponentPool : public AHandler {
+private:
+    enum {
+        kWhatTrim,
+    };
+    constexpr static std::chrono::steady_clock::duration kMaxIdleTime = 10s;
+
+public:
+    struct Item {
+        std::shared_ptr<Codec2Client> client;
+        std::shared_ptr<Codec2Client::Component> comp;
+        std::shared_ptr<Codec2Client::Listener> listener;
+        // writable parameters of the component as created
+        std::shared_ptr<const std::vector<std::unique_ptr<C2Param>>> defaults;
+        // frame index following the work items of the previous user
+        uint64_t nextFrameIndex = 0u;
+        // codec resource the instance holds
+        MediaResourceSubType subType = MediaResourceSubType::kUnspecifiedSubType;
+        // resource manager client of the instance while it is idle
+        std::shared_ptr<IResourceManagerClient> reclaimClient;
+    };
+
+    static sp<CCodecComponentPool> getInstance() {
+        static sp<CCodecComponentPool> instance(new CCodecComponentPool);
+        static std::once_flag flag;
+        // Call Init() only once.
+        std::call_once(flag, Init, instance);
+        return instance;
+    }
+
+    ~CCodecComponentPool() = default;
+
+    bool enabled() const {
+        return mCapacity > 0;
+    }
+
+    bool take(const std::string &name, Item *item) {
+        {
+            Mutexed<State>::Locked state(mState);
+            if (!state->pool.take(name, item)) {
+                return false;
+            }
+        }
+        Unregister(*item);
+        return true;
+    }
+
+    void put(const std::string &name, Item item) {
+        item.reclaimClient = ::ndk::SharedRefBase::make<ReclaimClient>(this, name);
+        Register(item);
+        std::list<Item> evicted;
+        bool shouldPost = false;
+        {
+            Mutexed<State>::Locked state(mState);
+            state->pool.put(name, std::move(item), &evicted);
+            if (!state->trimPending && state->pool.size() > 0) {
+                state->trimPending = true;
+                shouldPost = true;
+            }
+        }
+        Release(&evicted);
+        if (shouldPost) {
+            (new AMessage(kWhatTrim, this))->post(
+                    std::chrono::duration_cast<std::chrono::microseconds>(kMaxIdleTime).count());
+        }
+    }
+
+    void clear() {
+        std::list<Item> evicted;
+        {
+            Mutexed<State>::Locked state(mState);
+            state->pool.clear(&evicted);
+        }
+        Release(&evicted);
+    }
+
+    /**
+     * Releases the idle instance registered as |client|, if it is still idle.
+     */
+    void reclaim(const IResourceManagerClient *client) {
+        std::list<Item> evicted(1);
+        {
+            Mutexed<State>::Locked state(mState);
+            if (!state->pool.takeIf(
+                    [client](const Item &item) { return item.reclaimClient.get() == client; },
+                    &evicted.front())) {
+                return;
+            }
+        }
+        ALOGD("idle component [%s] reclaimed", evicted.front().comp->getName().c_str());
+        Release(&evicted);
+    }
+
+protected:
+    void onMessageReceived(const sp<AMessage> &msg) {
+        switch (msg->what()) {
+            case kWhatTrim: {
+                std::list<Item> evicted;
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                std::chrono::steady_clock::time_point next;
+                {
+                    Mutexed<State>::Locked state(mState);
+                    next = state->pool.trim(&evicted, now);
+                    state->trimPending = (next != std::chrono::steady_clock::time_point::max());
+                }
+                Release(&evicted);
+                if (next != std::chrono::steady_clock::time_point::max()) {
+                    (new AMessage(kWhatTrim, this))->post(
+                            std::chrono::duration_cast<std::chrono::microseconds>(
+                                    next - now).count());
+                }
+                break;
+            }
+
+            default: {
+                TRESPASS("CCodecComponentPool: unrecognized message");
+            }
+        }
+    }
+
+private:
+    // Lets the resource manager reclaim an idle instance, as MediaCodec's
+    // client does for the instances in use.
+    class ReclaimClient : public BnResourceManagerClient {
+    public:
+        ReclaimClient(const wp<CCodecComponentPool> &pool, const std::string &name)
+            : mPool(pool), mName(name) {}
+
+        ::ndk::ScopedAStatus reclaimResource(bool *_aidl_return) override {
+            sp<CCodecComponentPool> pool = mPool.promote();
+            if (pool != nullptr) {
+                pool->reclaim(this);
+            }
+            // An instance that is no longer idle has been released, or is
+            // accounted for by the MediaCodec that took it.
+            *_aidl_return = true;
+            return ::ndk::ScopedAStatus::ok();
+        }
+
+        ::ndk::ScopedAStatus getName(std::string *_aidl_return) override {
+            *_aidl_return = mName;
+            return ::ndk::ScopedAStatus::ok();
+        }
+
+    private:
+        const wp<CCodecComponentPool> mPool;
+        const std::string mName;
+    };
+
+    struct State {
+        explicit State(size_t capacity) : pool(capacity, kMaxIdleTime), trimPending(false) {}
+
+        WarmPool<Item> pool;
+        bool trimPending;
+    };
+
+    CCodecComponentPool()
+        : mLooper(new ALooper),
+          mCapacity(GetCapacity()),
+          mState(mCapacity) {}
+
+    static void Init(const sp<CCodecComponentPool> &thiz) {
+        ALOGV("Init");
+        thiz->mLooper->setName("CCodecComponentPool");
+        thiz->mLooper->registerHandler(thiz);
+        thiz->mLooper->start();
+    }
+
+    // Number of idle instances kept per component; 0 disables the pool.
+    static size_t GetCapacity() {
+        std::string value = GetServerConfigurableFlag(
+                "media_native", "ccodec_warm_pool_size", "0");
+        int32_t capacity = 0;
+        if (!android::base::ParseInt(value, &capacity, 0, 8)) {
+            return 0;
+        }
+        return capacity;
+    }
+
+    static std::shared_ptr<IResourceManagerService> GetResourceManager() {
+        ::ndk::SpAIBinder binder(AServiceManager_waitForService("media.resource_manager"));
+        std::shared_ptr<IResourceManagerService> service =
+                IResourceManagerService::fromBinder(binder);
+        if (service == nullptr) {
+            ALOGW("Failed to get ResourceManagerService");
+        }
+        return service;
+    }
+
+    static ClientInfoParcel GetClientInfo(const Item &item) {
+        return ClientInfoParcel{.pid = static_cast<int32_t>(getpid()),
+                                .uid = static_cast<int32_t>(getuid()),
+                                .id = (int64_t)item.reclaimClient.get(),
+                                .name = item.comp->getName()};
+    }
+
+    static void Register(const Item &item) {
+        std::shared_ptr<IResourceManagerService> service = GetResourceManager();
+        if (service == nullptr) {
+            return;
+        }
+        std::vector<MediaResourceParcel> resources{
+                MediaResource::CodecResource(false /* secure */, item.subType)};
+        service->addResource(GetClientInfo(item), item.reclaimClient, resources);
+    }
+
+    static void Unregister(const Item &item) {
+        std::shared_ptr<IResourceManagerService> service = GetResourceManager();
+        if (service == nullptr) {
+            return;
+        }
+        service->removeClient(GetClientInfo(item));
+    }
+
+    static void Release(std::list<Item> *items) {
+        for (Item &item : *items) {
+            ALOGD("releasing idle component [%s]", item.comp->getName().c_str());
+            Unregister(item);
+            item.comp->release();
+        }
+        items->clear();
+    }
+
+    sp<ALooper> mLooper;
+    const size_t mCapacity;
+
+    Mutexed<State> mState;
+};
+
 class C2InputSurfaceWrapper : public InputSurfaceWrapper {
 public:
     explicit C2InputSurfaceWrapper(
@@ -816,22 +1069,109 @@ void AmendOutputFormatWithCodecSpecificData(
     }
 }
 
+// Returns the values of the writable parameters of |comp|.
+std::vector<std::unique_ptr<C2Param>> QueryWritableParams(
+        const std::shared_ptr<Codec2Client::Component> &comp) {
+    std::vector<std::unique_ptr<C2Param>> params;
+    std::vector<std::shared_ptr<C2ParamDescriptor>> descs;
+    if (comp->querySupportedParams(&descs) != C2_OK) {
+        return params;
+    }
+    std::vector<C2Param::Index> indices;
+    for (const std::shared_ptr<C2ParamDescriptor> &desc : descs) {
+        if (desc && !desc->isReadOnly()) {
+            indices.push_back(desc->index());
+        }
+    }
+    std::vector<std::unique_ptr<C2Param>> values;
+    (void)comp->query({}, indices, C2_MAY_BLOCK, &values);
+    for (std::unique_ptr<C2Param> &value : values) {
+        if (value) {
+            params.push_back(std::move(value));
+        }
+    }
+    return params;
+}
+
+// Configures |comp| with |defaults|, and returns whether all of the
+// parameters have their default values afterwards.
+bool RestoreParams(
+        const std::shared_ptr<Codec2Client::Component> &comp,
+        const std::vector<std::unique_ptr<C2Param>> &defaults) {
+    std::vector<std::unique_ptr<C2Param>> copies;
+    std::vector<C2Param *> params;
+    std::vector<C2Param::Index> indices;
+    for (const std::unique_ptr<C2Param> &param : defaults) {
+        copies.push_back(C2Param::Copy(*param));
+        if (!copies.back()) {
+            return false;
+        }
+        params.push_back(copies.back().get());
+        indices.push_back(param->index());
+    }
+    // Setters may reject some of the values, e.g. of parameters that are
+    // only settable in some states; the check below is what counts.
+    std::vector<std::unique_ptr<C2SettingResult>> failures;
+    (void)comp->config(params, C2_MAY_BLOCK, &failures);
+    std::vector<std::unique_ptr<C2Param>> values;
+    (void)comp->query({}, indices, C2_MAY_BLOCK, &values);
+    std::map<C2Param::Index, C2Param *> valuesByIndex;
+    for (const std::unique_ptr<C2Param> &value : values) {
+        if (value) {
+            valuesByIndex.emplace(value->index(), value.get());
+        }
+    }
+    for (const std::unique_ptr<C2Param> &param : defaults) {
+        auto it = valuesByIndex.find(param->index());
+        if (it == valuesByIndex.end() || *it->second != *param) {
+            ALOGD("[%s] parameter %#x not restored",
+                    comp->getName().c_str(), uint32_t(param->index()));
+            return false;
+        }
+    }
+    return true;
+}
+
 }  // namespace
 
 // CCodec::ClientListener
 
 struct CCodec::ClientListener : public Codec2Client::Listener {
 
-    explicit ClientListener(const wp<CCodec> &codec) : mCodec(codec) {}
+    explicit ClientListener(const wp<CCodec> &codec)
+        : mCodec(codec), mFirstFrameIndex(0u), mFailed(false) {}
+
+    // Deliver further events to |codec|, except for work items queued
+    // before |firstFrameIndex|. Used when the component is handed over to
+    // another CCodec instance.
+    void setCodec(const wp<CCodec> &codec, uint64_t firstFrameIndex) {
+        std::lock_guard<std::mutex> lock(mLock);
+        mCodec = codec;
+        mFirstFrameIndex = firstFrameIndex;
+    }
+
+    // Whether the component reported an error or died.
+    bool failed() const {
+        return mFailed;
+    }
 
     virtual void onWorkDone(
             const std::weak_ptr<Codec2Client::Component>& component,
             std::list<std::unique_ptr<C2Work>>& workItems) override {
         (void)component;
-        sp<CCodec> codec(mCodec.promote());
+        uint64_t firstFrameIndex = 0u;
+        sp<CCodec> codec(getCodec(&firstFrameIndex));
         if (!codec) {
             return;
         }
+        // Oneway calls may deliver work of the previous user of the
+        // component after the handover.
+        workItems.remove_if([firstFrameIndex](const std::unique_ptr<C2Work> &work) {
+            return work && work->input.ordinal.frameIndex.peeku() < firstFrameIndex;
+        });
+        if (workItems.empty()) {
+            return;
+        }
         codec->onWorkDone(workItems);
     }
 
@@ -847,6 +1187,7 @@ struct CCodec::ClientListener : public Codec2Client::Listener {
     virtual void onError(
             const std::weak_ptr<Codec2Client::Component>& component,
             uint32_t errorCode) override {
+        mFailed = true;
         {
             // Component is only used for reporting as we use a separate listener for each instance
             std::shared_ptr<Codec2Client::Component> comp = component.lock();
@@ -860,7 +1201,7 @@ struct CCodec::ClientListener : public Codec2Client::Listener {
         // Report to MediaCodec
         // Note: for now we do not propagate the error code to MediaCodec
         // except for C2_NO_MEMORY, as we would need to translate to a MediaCodec error.
-        sp<CCodec> codec(mCodec.promote());
+        sp<CCodec> codec(getCodec());
         if (!codec || !codec->mCallback) {
             return;
         }
@@ -871,6 +1212,7 @@ struct CCodec::ClientListener : public Codec2Client::Listener {
 
     virtual void onDeath(
             const std::weak_ptr<Codec2Client::Component>& component) override {
+        mFailed = true;
         { // Log the death of the component.
             std::shared_ptr<Codec2Client::Component> comp = component.lock();
             if (!comp) {
@@ -881,7 +1223,7 @@ struct CCodec::ClientListener : public Codec2Client::Listener {
         }
 
         // Report to MediaCodec.
-        sp<CCodec> codec(mCodec.promote());
+        sp<CCodec> codec(getCodec());
         if (!codec || !codec->mCallback) {
             return;
         }
@@ -899,14 +1241,26 @@ struct CCodec::ClientListener : public Codec2Client::Listener {
 
     virtual void onInputBufferDone(
             uint64_t frameIndex, size_t arrayIndex) override {
-        sp<CCodec> codec(mCodec.promote());
-        if (codec) {
+        uint64_t firstFrameIndex = 0u;
+        sp<CCodec> codec(getCodec(&firstFrameIndex));
+        if (codec && frameIndex >= firstFrameIndex) {
             codec->onInputBufferDone(frameIndex, arrayIndex);
         }
     }
 
 private:
+    sp<CCodec> getCodec(uint64_t *firstFrameIndex = nullptr) {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (firstFrameIndex) {
+            *firstFrameIndex = mFirstFrameIndex;
+        }
+        return mCodec.promote();
+    }
+
+    std::mutex mLock;
     wp<CCodec> mCodec;
+    uint64_t mFirstFrameIndex;
+    std::atomic_bool mFailed;
 };
 
 // CCodecCallbackImpl
@@ -932,6 +1286,10 @@ public:
         mCodec->mCallback->onFirstTunnelFrameReady();
     }
 
+    void onAccessUnitsPending(int64_t delayUs) override {
+        (new AMessage(CCodec::kWhatQueuePendingAccessUnits, mCodec))->post(delayUs);
+    }
+
 private:
     CCodec *mCodec;
 };
@@ -940,7 +1298,8 @@ private:
 
 CCodec::CCodec()
     : mChannel(new CCodecBufferChannel(std::make_shared<CCodecCallbackImpl>(this))),
-      mConfig(new CCodecConfig) {
+      mConfig(new CCodecConfig),
+      mReusable(false) {
 }
 
 CCodec::~CCodec() {
@@ -1000,11 +1359,28 @@ void CCodec::allocate(const sp<MediaCodecInfo> &codecInfo) {
     }
 
     std::shared_ptr<Codec2Client::Component> comp;
-    c2_status_t status = Codec2Client::CreateComponentByName(
-            componentName.c_str(),
-            mClientListener,
-            &comp,
-            &client);
+    c2_status_t status = C2_OK;
+    sp<CCodecComponentPool> pool = CCodecComponentPool::getInstance();
+    mReusable = pool->enabled()
+            && (codecInfo->getAttributes() & MediaCodecInfo::kFlagIsSoftwareOnly)
+            && componentName.find(".secure") < 0;
+    bool reused = mReusable && takeIdleComponent(componentName.c_str(), &comp, &client);
+    if (!reused) {
+        status = Codec2Client::CreateComponentByName(
+                componentName.c_str(),
+                mClientListener,
+                &comp,
+                &client);
+        if (status == C2_NO_MEMORY && pool->enabled()) {
+            ALOGD("releasing idle components and retrying");
+            pool->clear();
+            status = Codec2Client::CreateComponentByName(
+                    componentName.c_str(),
+                    mClientListener,
+                    &comp,
+                    &client);
+        }
+    }
     if (status != C2_OK) {
         ALOGE("Failed Create component: %s, error=%d", componentName.c_str(), status);
         Mutexed<State>::Locked state(mState);
@@ -1014,7 +1390,16 @@ void CCodec::allocate(const sp<MediaCodecInfo> &codecInfo) {
         state.lock();
         return;
     }
-    ALOGI("Created component [%s]", componentName.c_str());
+    if (reused) {
+        ALOGI("Reused component [%s]", componentName.c_str());
+    } else {
+        ALOGI("Created component [%s]", componentName.c_str());
+        if (mReusable) {
+            // remembered so that the component can be restored before reuse
+            mComponentDefaults = std::make_shared<std::vector<std::unique_ptr<C2Param>>>(
+                    QueryWritableParams(comp));
+        }
+    }
     mChannel->setComponent(comp);
     auto setAllocated = [this, comp, client] {
         Mutexed<State>::Locked state(mState);
@@ -1041,9 +1426,41 @@ void CCodec::allocate(const sp<MediaCodecInfo> &codecInfo) {
     }
     config->queryConfiguration(comp);
 
+    if (mReusable) {
+        sp<AMessage> metrics = new AMessage;
+        metrics->setInt32(kCodecComponentReused, reused);
+        mCallback->onMetricsUpdated(metrics);
+    }
     mCallback->onComponentAllocated(componentName.c_str());
 }
 
+bool CCodec::takeIdleComponent(
+        const std::string &name,
+        std::shared_ptr<Codec2Client::Component> *comp,
+        std::shared_ptr<Codec2Client> *client) {
+    sp<CCodecComponentPool> pool = CCodecComponentPool::getInstance();
+    CCodecComponentPool::Item item;
+    while (pool->take(name, &item)) {
+        std::shared_ptr<ClientListener> listener =
+            std::static_pointer_cast<ClientListener>(item.listener);
+        if (listener->failed()) {
+            ALOGD("discarding idle component [%s] that failed", name.c_str());
+            item.comp->release();
+            continue;
+        }
+        // The component keeps delivering events to the listener it was
+        // created with.
+        listener->setCodec(this, item.nextFrameIndex);
+        mChannel->setFirstFrameIndex(item.nextFrameIndex);
+        mClientListener = item.listener;
+        mComponentDefaults = item.defaults;
+        *comp = item.comp;
+        *client = item.client;
+        return true;
+    }
+    return false;
+}
+
 void CCodec::initiateConfigureComponent(const sp<AMessage> &format) {
     auto checkAllocated = [this] {
         Mutexed<State>::Locked state(mState);
@@ -2202,6 +2619,9 @@ void CCodec::initiateStop() {
         }
         state->set(STOPPING);
     }
+    reportInputBlockStats();
+    reportPipelineDepthStats();
+    reportFrameLatency();
     mChannel->reset();
     bool pushBlankBuffer = mConfig.lock().get()->mPushBlankBuffersOnStop;
     sp<AMessage> stopMessage(new AMessage(kWhatStop, this));
@@ -2317,6 +2737,9 @@ void CCodec::initiateRelease(bool sendCallback /* = true */) {
         }
     }
 
+    reportInputBlockStats();
+    reportPipelineDepthStats();
+    reportFrameLatency();
     mChannel->reset();
     bool pushBlankBuffer = mConfig.lock().get()->mPushBlankBuffersOnStop;
     // thiz holds strong ref to this while the thread is running.
@@ -2325,6 +2748,85 @@ void CCodec::initiateRelease(bool sendCallback /* = true */) {
                 { thiz->release(sendCallback, pushBlankBuffer); }).detach();
 }
 
+void CCodec::reportInputBlockStats() {
+    InputBuffers::BlockStats stats = mChannel->getInputBlockStats();
+    if (stats.fetched == 0 && stats.recycled == 0) {
+        return;
+    }
+    ALOGD("input blocks: %llu fetched, %llu recycled",
+            (unsigned long long)stats.fetched, (unsigned long long)stats.recycled);
+    sp<AMessage> metrics = new AMessage;
+    metrics->setInt64(kCodecInputBlocksFetched, stats.fetched);
+    metrics->setInt64(kCodecInputBlocksRecycled, stats.recycled);
+    mCallback->onMetricsUpdated(metrics);
+}
+
+void CCodec::reportPipelineDepthStats() {
+    uint32_t numAdjustments = 0;
+    std::string trace;
+    mChannel->getPipelineDepthStats(&numAdjustments, &trace);
+    if (numAdjustments == 0) {
+        return;
+    }
+    ALOGD("pipeline depth: %u adjustments: %s", numAdjustments, trace.c_str());
+    sp<AMessage> metrics = new AMessage;
+    metrics->setInt32(kCodecPipelineDepthAdjustments, numAdjustments);
+    metrics->setString(kCodecPipelineDepthTrace, trace.c_str());
+    mCallback->onMetricsUpdated(metrics);
+}
+
+void CCodec::reportFrameLatency() {
+    struct Span {
+        FrameLatencyTracer::Stage from;
+        FrameLatencyTracer::Stage to;
+        const char *p50Key;
+        const char *p90Key;
+    };
+    static const Span kSpans[] = {
+        { FrameLatencyTracer::QUEUED, FrameLatencyTracer::SUBMITTED,
+          kCodecFrameQueueingLatencyP50Us, kCodecFrameQueueingLatencyP90Us },
+        { FrameLatencyTracer::SUBMITTED, FrameLatencyTracer::WORK_DONE,
+          kCodecFrameProcessingLatencyP50Us, kCodecFrameProcessingLatencyP90Us },
+        { FrameLatencyTracer::WORK_DONE, FrameLatencyTracer::RELEASED,
+          kCodecFrameOutputLatencyP50Us, kCodecFrameOutputLatencyP90Us },
+    };
+    sp<AMessage> metrics = new AMessage;
+    for (const Span &span : kSpans) {
+        FrameLatencyTracer::Percentiles latency = mChannel->getFrameLatency(span.from, span.to);
+        if (latency.count > 0) {
+            metrics->setInt64(span.p50Key, latency.p50 / 1000);
+            metrics->setInt64(span.p90Key, latency.p90 / 1000);
+        }
+    }
+    if (metrics->countEntries() == 0) {
+        return;
+    }
+    mCallback->onMetricsUpdated(metrics);
+
+    // The trace goes to a dedicated log tag, one event per line without the
+    // array brackets and separators, so that the traces of all codecs can be
+    // joined into a single JSON array that Perfetto UI loads:
+    //   adb logcat -d -v raw -s CCodecFrameTrace | grep '^{' | paste -sd, - \
+    //           | sed 's/.*/[&]/' > trace.json
+    // Component process() runs in the HAL process and is not part of this
+    // trace. Software components mark it on the system trace instead, as
+    // "SimpleC2Component::process(<name>#<frame index>@ts=<timestamp>)", next
+    // to the CCodecBufferChannel queue and onWorkDone slices. A Perfetto
+    // recording with the "video" atrace category shows all three.
+    if (property_get_bool("debug.stagefright.ccodec_frame_trace", false)) {
+        std::istringstream trace(mChannel->getFrameLatencyTrace());
+        for (std::string line; std::getline(trace, line); ) {
+            if (line.empty() || line.front() != '{') {
+                continue;
+            }
+            if (line.back() == ',') {
+                line.pop_back();
+            }
+            __android_log_write(ANDROID_LOG_INFO, "CCodecFrameTrace", line.c_str());
+        }
+    }
+}
+
 void CCodec::release(bool sendCallback, bool pushBlankBuffer) {
     std::shared_ptr<Codec2Client::Component> comp;
     {
@@ -2355,12 +2857,27 @@ void CCodec::release(bool sendCallback, bool pushBlankBuffer) {
     bool stopHalBeforeSurface =
             Codec2Client::IsAidlSelected() ||
             property_get_bool("debug.codec2.stop_hal_before_surface", false);
-    if (stopHalBeforeSurface && android::media::codec::provider_->stop_hal_before_surface()) {
+
+    // A component that may be reused is reset, and restored to the parameter
+    // values it was created with, instead of released. It is handed over to
+    // the pool only after it stopped using the output surface.
+    bool reuse = mReusable && mComponentDefaults;
+    auto stopComponent = [this, &comp, &reuse] {
+        if (reuse && comp->reset() == C2_OK && RestoreParams(comp, *mComponentDefaults)) {
+            return;
+        }
+        reuse = false;
         comp->release();
+    };
+    if (stopHalBeforeSurface && android::media::codec::provider_->stop_hal_before_surface()) {
+        stopComponent();
         mChannel->stopUseOutputSurface(pushBlankBuffer);
     } else {
         mChannel->stopUseOutputSurface(pushBlankBuffer);
-        comp->release();
+        stopComponent();
+    }
+    if (reuse) {
+        recycleComponent(comp);
     }
 
     {
@@ -2374,6 +2891,32 @@ void CCodec::release(bool sendCallback, bool pushBlankBuffer) {
     }
 }
 
+void CCodec::recycleComponent(const std::shared_ptr<Codec2Client::Component> &comp) {
+    std::shared_ptr<ClientListener> listener =
+        std::static_pointer_cast<ClientListener>(mClientListener);
+    if (!listener || listener->failed()) {
+        comp->release();
+        return;
+    }
+    uint64_t nextFrameIndex = mChannel->getNextFrameIndex();
+    MediaResourceSubType subType = MediaResourceSubType::kUnspecifiedSubType;
+    {
+        Mutexed<std::unique_ptr<Config>>::Locked configLocked(mConfig);
+        uint32_t domain = (*configLocked)->mDomain;
+        if (domain & Config::IS_VIDEO) {
+            subType = MediaResourceSubType::kSwVideoCodec;
+        } else if (domain & Config::IS_IMAGE) {
+            subType = MediaResourceSubType::kSwImageCodec;
+        } else if (domain & Config::IS_AUDIO) {
+            subType = MediaResourceSubType::kSwAudioCodec;
+        }
+    }
+    listener->setCodec(wp<CCodec>(), nextFrameIndex);
+    CCodecComponentPool::getInstance()->put(
+            comp->getName(),
+            {mClient, comp, mClientListener, mComponentDefaults, nextFrameIndex, subType});
+}
+
 status_t CCodec::setSurface(const sp<Surface> &surface, uint32_t generation) {
     bool pushBlankBuffer = false;
     {
@@ -2664,6 +3207,13 @@ void CCodec::signalRequestIDRFrame() {
     config->setParameters(comp, params, C2_MAY_BLOCK);
 }
 
+void CCodec::signalReclaim() {
+    // Idle components in the pool are invisible to the resource manager, so
+    // they are given up whenever it reclaims a codec of this process.
+    mReusable = false;
+    CCodecComponentPool::getInstance()->clear();
+}
+
 status_t CCodec::querySupportedParameters(std::vector<std::string> *names) {
     Mutexed<std::unique_ptr<Config>>::Locked configLocked(mConfig);
     const std::unique_ptr<Config> &config = *configLocked;
@@ -2913,6 +3463,10 @@ void CCodec::onMessageReceived(const sp<AMessage> &msg) {
             // watch message already posted; no-op.
             break;
         }
+        case kWhatQueuePendingAccessUnits: {
+            mChannel->queuePendingAccessUnits();
+            break;
+        }
         default: {
             ALOGE("unrecognized message");
             break;
@@ -3013,6 +3567,8 @@ void CCodec::initiateReleaseIfStuck() {
     }
     ALOGW("[%s] previous call to %s exceeded timeout", compName.c_str(), name.c_str());
 
+    // Do not reuse a component that got stuck.
+    mReusable = false;
     initiateRelease(false);
     mCallback->onError(UNKNOWN_ERROR, ACTION_CODE_FATAL);
 }
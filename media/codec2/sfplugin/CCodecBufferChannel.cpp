@@ -29,6 +29,7 @@
 #include <chrono>
 
 #include <android_media_codec.h>
+#include <com_android_media_codec_flags.h>
 
 #include <C2AllocatorGralloc.h>
 #include <C2PlatformSupport.h>
@@ -92,6 +93,29 @@ static bool areRenderMetricsEnabled() {
     return v == "true";
 }
 
+// Whether the pipeline depth of low-latency streams is tuned at runtime.
+static bool isAdaptivePipelineDepthEnabled() {
+    std::string v = GetServerConfigurableFlag(
+            "media_native", "ccodec_adaptive_pipeline_depth", "true");
+    return v == "true";
+}
+
+// Capacity of a block holding aggregated access units.
+constexpr uint32_t kMaxAggregatedBytes = 128 * 1024;
+// Longest time an access unit waits in a pending batch before the batch is
+// queued regardless of the state of the pipeline.
+constexpr int64_t kMaxAggregationDelayUs = 20000;  // 20 ms
+
+// Maximum number of compressed audio access units packed into one work item
+// for components supporting large audio frames; 0 or 1 disables aggregation.
+static uint32_t getMaxAggregatedAccessUnits() {
+    std::string v = GetServerConfigurableFlag(
+            "media_native", "ccodec_max_aggregated_access_units", "16");
+    uint32_t value = 0;
+    android::base::ParseUint(v, &value);
+    return value;
+}
+
 // Flags can come with individual BufferInfos
 // when used with large frame audio
 constexpr static std::initializer_list<std::pair<uint32_t, uint32_t>> flagList = {
@@ -272,6 +296,27 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
     ALOGV("[%s] queueInputBuffer: buffer->size() = %zu time: %lld",
             mName, buffer->size(), (long long)timeUs);
     std::list<std::unique_ptr<C2Work>> items;
+    std::unique_lock<std::mutex> aggregationLock(mAccessUnitQueueLock);
+    bool aggregate = false;
+    bool schedulePendingAccessUnits = false;
+    bool waitingForInput = mPipelineWatcher.lock()->waitingForInput();
+    {
+        Mutexed<Input>::Locked input(mInput);
+        if (input->accessUnitAggregator) {
+            sp<RefBase> obj;
+            aggregate = !(flags & C2FrameData::FLAG_CODEC_CONFIG)
+                    && !tunnelFirstFrame
+                    && mParamsToBeSet.empty()
+                    && !buffer->meta()->findObject("accessUnitInfo", &obj);
+            if (!aggregate) {
+                // Keep the pending access units ahead of this buffer.
+                input->accessUnitAggregator.drain(&items);
+            }
+        }
+    }
+    for (const std::unique_ptr<C2Work> &item : items) {
+        item->input.ordinal.frameIndex = mFrameIndex++;
+    }
     std::unique_ptr<C2Work> work(new C2Work);
     work->input.ordinal.timestamp = timeUs;
     work->input.ordinal.frameIndex = mFrameIndex++;
@@ -282,7 +327,9 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
     work->input.buffers.clear();
 
     sp<Codec2Buffer> copy;
+    std::weak_ptr<C2Buffer> copyC2Buffer;
     bool usesFrameReassembler = false;
+    bool usesAccessUnitAggregator = false;
 
     if (buffer->size() > 0u) {
         Mutexed<Input>::Locked input(mInput);
@@ -298,6 +345,7 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
                 if (!input->extraBuffers.releaseSlot(copy, &c2buffer, false)) {
                     return UNKNOWN_ERROR;
                 }
+                copyC2Buffer = c2buffer;
                 bool released = input->buffers->releaseBuffer(buffer, nullptr, true);
                 ALOGV("[%s] queueInputBuffer: buffer copied; %sreleased",
                       mName, released ? "" : "not ");
@@ -307,9 +355,40 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
                       "buffer starvation on component.", mName);
             }
         }
+        AccessUnitAggregator &aggregator = input->accessUnitAggregator;
+        nsecs_t pendingSince = aggregator.hasPending() ? aggregator.pendingSince() : -1;
+        if (aggregate && !input->frameReassembler) {
+            c2_status_t err = aggregator.process(buffer, flags, &items);
+            if (err == C2_OK) {
+                usesAccessUnitAggregator = true;
+            } else {
+                ALOGW("[%s] failed to aggregate an access unit (%lld us): %s (%d); "
+                        "queueing it on its own", mName, (long long)timeUs, asString(err), err);
+                // Keep the pending access units ahead of this buffer, which
+                // takes the regular path below.
+                aggregator.drain(&items);
+                uint64_t frameIndex = work->input.ordinal.frameIndex.peeku();
+                for (const std::unique_ptr<C2Work> &item : items) {
+                    item->input.ordinal.frameIndex = frameIndex++;
+                }
+                work->input.ordinal.frameIndex = frameIndex;
+                mFrameIndex = frameIndex + 1;
+            }
+        }
         if (input->frameReassembler) {
             usesFrameReassembler = true;
             input->frameReassembler.process(buffer, &items);
+        } else if (usesAccessUnitAggregator) {
+            // Do not let the component idle while access units are pending,
+            // and do not hold them for longer than kMaxAggregationDelayUs.
+            if (eos || waitingForInput || (aggregator.hasPending()
+                    && systemTime(SYSTEM_TIME_MONOTONIC) - aggregator.pendingSince()
+                            >= us2ns(kMaxAggregationDelayUs))) {
+                aggregator.drain(&items);
+            } else if (aggregator.hasPending() && aggregator.pendingSince() != pendingSince) {
+                // A new batch was started.
+                schedulePendingAccessUnits = true;
+            }
         } else {
             int32_t cvo = 0;
             if (buffer->meta()->findInt32("cvo", &cvo)) {
@@ -362,6 +441,9 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
             usesFrameReassembler = true;
             // drain any pending items with eos
             input->frameReassembler.process(buffer, &items);
+        } else if (aggregate) {
+            usesAccessUnitAggregator = true;
+            input->accessUnitAggregator.drain(&items);
         }
         flags |= C2FrameData::FLAG_END_OF_STREAM;
     }
@@ -370,6 +452,13 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
             items.front()->input.configUpdate = std::move(mParamsToBeSet);
             mFrameIndex = (items.back()->input.ordinal.frameIndex + 1).peek();
         }
+    } else if (usesAccessUnitAggregator) {
+        // Batches take over the frame index reserved for |work|.
+        uint64_t frameIndex = work->input.ordinal.frameIndex.peeku();
+        for (const std::unique_ptr<C2Work> &item : items) {
+            item->input.ordinal.frameIndex = frameIndex++;
+        }
+        mFrameIndex = frameIndex;
     } else {
         work->input.flags = (C2FrameData::flags_t)flags;
 
@@ -414,14 +503,21 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
     if (!items.empty()) {
         ScopedTrace trace(ATRACE_TAG, android::base::StringPrintf(
                 "CCodecBufferChannel::queue(%s@ts=%lld)", mName, (long long)timeUs).c_str());
+        nsecs_t submittedAt = systemTime(SYSTEM_TIME_MONOTONIC);
+        int64_t queuedAt = submittedAt;
+        (void)buffer->meta()->findInt64("queuedAtNs", &queuedAt);
         {
             Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
             PipelineWatcher::Clock::time_point now = PipelineWatcher::Clock::now();
             for (const std::unique_ptr<C2Work> &work : items) {
+                uint64_t frameIndex = work->input.ordinal.frameIndex.peeku();
                 watcher->onWorkQueued(
-                        work->input.ordinal.frameIndex.peeku(),
+                        frameIndex,
                         std::vector(work->input.buffers),
                         now);
+                mFrameLatencyTracer.onQueued(frameIndex, queuedAt);
+                mFrameLatencyTracer.record(
+                        frameIndex, FrameLatencyTracer::SUBMITTED, submittedAt);
             }
         }
         err = mComponent->queue(&items);
@@ -436,17 +532,87 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
         bool released = false;
         if (copy) {
             released = input->extraBuffers.releaseSlot(copy, nullptr, true);
+            if (released) {
+                input->buffers->recycleClone(copy, copyC2Buffer.lock());
+            }
         } else if (buffer) {
             released = input->buffers->releaseBuffer(buffer, nullptr, true);
         }
         ALOGV("[%s] queueInputBuffer: buffer%s %sreleased",
               mName, (buffer == nullptr) ? "(copy)" : "", released ? "" : "not ");
     }
+    aggregationLock.unlock();
 
+    if (schedulePendingAccessUnits) {
+        mCCodecCallback->onAccessUnitsPending(kMaxAggregationDelayUs);
+    }
     feedInputBufferIfAvailableInternal();
     return err;
 }
 
+void CCodecBufferChannel::queuePendingAccessUnits() {
+    QueueGuard guard(mSync);
+    if (!guard.isRunning()) {
+        ALOGV("[%s] We're not running --- pending access units not queued", mName);
+        return;
+    }
+    queuePendingAccessUnitsIfDue();
+}
+
+void CCodecBufferChannel::queuePendingAccessUnitsIfDue() {
+    if (!mInput.lock()->accessUnitAggregator.hasPending()) {
+        return;
+    }
+    std::list<std::unique_ptr<C2Work>> items;
+    std::lock_guard<std::mutex> aggregationLock(mAccessUnitQueueLock);
+    bool waitingForInput = mPipelineWatcher.lock()->waitingForInput();
+    {
+        Mutexed<Input>::Locked input(mInput);
+        if (!input->accessUnitAggregator.hasPending()) {
+            return;
+        }
+        nsecs_t pendingNs = systemTime(SYSTEM_TIME_MONOTONIC)
+                - input->accessUnitAggregator.pendingSince();
+        if (pendingNs < us2ns(kMaxAggregationDelayUs) && !waitingForInput) {
+            // The pending access units go out with the next input buffer,
+            // once the component runs out of work, or when the bound expires.
+            return;
+        }
+        input->accessUnitAggregator.drain(&items);
+    }
+    if (items.empty()) {
+        return;
+    }
+    for (const std::unique_ptr<C2Work> &item : items) {
+        item->input.ordinal.frameIndex = mFrameIndex++;
+    }
+    ALOGV("[%s] queueing %zu pending batch(es) of access units", mName, items.size());
+    {
+        Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+        PipelineWatcher::Clock::time_point now = PipelineWatcher::Clock::now();
+        nsecs_t submittedAt = systemTime(SYSTEM_TIME_MONOTONIC);
+        for (const std::unique_ptr<C2Work> &work : items) {
+            uint64_t frameIndex = work->input.ordinal.frameIndex.peeku();
+            watcher->onWorkQueued(
+                    frameIndex,
+                    std::vector(work->input.buffers),
+                    now);
+            mFrameLatencyTracer.onQueued(frameIndex, submittedAt);
+            mFrameLatencyTracer.record(
+                    frameIndex, FrameLatencyTracer::SUBMITTED, submittedAt);
+        }
+    }
+    c2_status_t err = mComponent->queue(&items);
+    if (err != C2_OK) {
+        ALOGW("[%s] failed to queue pending access units: %s (%d)",
+                mName, asString(err), err);
+        Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+        for (const std::unique_ptr<C2Work> &work : items) {
+            watcher->onWorkDone(work->input.ordinal.frameIndex.peeku());
+        }
+    }
+}
+
 status_t CCodecBufferChannel::setParameters(std::vector<std::unique_ptr<C2Param>> &params) {
     QueueGuard guard(mSync);
     if (!guard.isRunning()) {
@@ -1061,6 +1227,7 @@ void CCodecBufferChannel::feedInputBufferIfAvailableInternal() {
     if (mInputMetEos) {
         return;
     }
+    queuePendingAccessUnitsIfDue();
     {
         Mutexed<Output>::Locked output(mOutput);
         if (!output->buffers ||
@@ -1097,6 +1264,11 @@ void CCodecBufferChannel::feedInputBufferIfAvailableInternal() {
 status_t CCodecBufferChannel::renderOutputBuffer(
         const sp<MediaCodecBuffer> &buffer, int64_t timestampNs) {
     ALOGV("[%s] renderOutputBuffer: %p", mName, buffer.get());
+    int64_t frameIndex;
+    if (buffer->meta()->findInt64("frameIndex", &frameIndex)) {
+        mFrameLatencyTracer.record(
+                frameIndex, FrameLatencyTracer::RELEASED, systemTime(SYSTEM_TIME_MONOTONIC));
+    }
     std::shared_ptr<C2Buffer> c2Buffer;
     bool released = false;
     {
@@ -1482,6 +1654,12 @@ status_t CCodecBufferChannel::discardBuffer(const sp<MediaCodecBuffer> &buffer)
         Mutexed<Output>::Locked output(mOutput);
         if (output->buffers && output->buffers->releaseBuffer(buffer, nullptr)) {
             released = true;
+            int64_t frameIndex;
+            if (buffer->meta()->findInt64("frameIndex", &frameIndex)) {
+                mFrameLatencyTracer.record(
+                        frameIndex, FrameLatencyTracer::RELEASED,
+                        systemTime(SYSTEM_TIME_MONOTONIC));
+            }
         }
     }
     if (released) {
@@ -1535,6 +1713,8 @@ status_t CCodecBufferChannel::start(
     C2PortActualDelayTuning::output outputDelay(0);
     C2ActualPipelineDelayTuning pipelineDelay(0);
     C2SecureModeTuning secureMode(C2Config::SM_UNPROTECTED);
+    C2LargeFrame::output largeFrame(0u, 0u, 0u);
+    C2GlobalLowLatencyModeTuning lowLatency(false);
 
     c2_status_t err = mComponent->query(
             {
@@ -1547,6 +1727,8 @@ status_t CCodecBufferChannel::start(
                 &pipelineDelay,
                 &outputDelay,
                 &secureMode,
+                &largeFrame,
+                &lowLatency,
             },
             {},
             C2_DONT_BLOCK,
@@ -1579,6 +1761,7 @@ status_t CCodecBufferChannel::start(
     if (inputFormat != nullptr) {
         bool graphic = (iStreamFormat.value == C2BufferData::GRAPHIC);
         bool audioEncoder = !graphic && (kind.value == C2Component::KIND_ENCODER);
+        bool audioDecoder = !graphic && (kind.value == C2Component::KIND_DECODER);
         C2Config::api_feature_t apiFeatures = C2Config::api_feature_t(
                 API_REFLECTION |
                 API_VALUES |
@@ -1681,6 +1864,24 @@ status_t CCodecBufferChannel::start(
                     channelCount.value,
                     pcmEncoding ? pcmEncoding.value : C2Config::PCM_16);
         }
+        input->accessUnitAggregator.reset();
+        // Components advertising large audio frames accept many access units
+        // per work item; pack the ones the client queues one at a time.
+        if (audioDecoder && largeFrame && buffersBoundToCodec
+                && !hasCryptoOrDescrambler()
+                && com::android::media::codec::flags::provider_->large_audio_frame()
+                && android::media::codec::provider_->large_audio_frame_finish()) {
+            uint32_t maxAccessUnits = getMaxAggregatedAccessUnits();
+            input->accessUnitAggregator.init(
+                    pool,
+                    {C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE},
+                    maxAccessUnits,
+                    kMaxAggregatedBytes);
+            if (input->accessUnitAggregator) {
+                ALOGD("[%s] aggregating up to %u access units per work item",
+                        mName, maxAccessUnits);
+            }
+        }
         bool conforming = (apiFeatures & API_SAME_INPUT_BUFFER);
         // For encrypted content, framework decrypts source buffer (ashmem) into
         // C2Buffers. Thus non-conforming codecs can process these.
@@ -1961,7 +2162,9 @@ status_t CCodecBufferChannel::start(
                 .pipelineDelay(pipelineDelayValue)
                 .outputDelay(outputDelayValue)
                 .smoothnessFactor(kSmoothnessFactor)
-                .tunneled(mTunneled);
+                .tunneled(mTunneled)
+                .adaptive(lowLatency && lowLatency.value && !mTunneled
+                        && isAdaptivePipelineDepthEnabled());
         watcher->flush();
     }
 
@@ -2102,10 +2305,12 @@ void CCodecBufferChannel::reset() {
         mInputSurface.reset();
     }
     mPipelineWatcher.lock()->flush();
+    mFrameLatencyTracer.clear();
     {
         Mutexed<Input>::Locked input(mInput);
         input->buffers.reset(new DummyInputBuffers(""));
         input->extraBuffers.flush();
+        input->accessUnitAggregator.reset();
     }
     {
         Mutexed<Output>::Locked output(mOutput);
@@ -2174,6 +2379,7 @@ void CCodecBufferChannel::flush(const std::list<std::unique_ptr<C2Work>> &flushe
         Mutexed<Input>::Locked input(mInput);
         input->buffers->flush();
         input->extraBuffers.flush();
+        input->accessUnitAggregator.flush();
     }
     {
         Mutexed<Output>::Locked output(mOutput);
@@ -2198,6 +2404,8 @@ void CCodecBufferChannel::onInputBufferDone(
     if (mInputSurface) {
         return;
     }
+    mFrameLatencyTracer.record(
+            frameIndex, FrameLatencyTracer::INPUT_RELEASED, systemTime(SYSTEM_TIME_MONOTONIC));
     std::shared_ptr<C2Buffer> buffer =
             mPipelineWatcher.lock()->onInputBufferReleased(frameIndex, arrayIndex);
     bool newInputSlotAvailable = false;
@@ -2256,9 +2464,18 @@ bool CCodecBufferChannel::handleWork(
             || !work->worklets.front()
             || !(work->worklets.front()->output.flags &
                  C2FrameData::FLAG_INCOMPLETE))) {
-        mPipelineWatcher.lock()->onWorkDone(
-                work->input.ordinal.frameIndex.peeku());
+        Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+        uint32_t smoothnessFactor = watcher->currentSmoothnessFactor();
+        watcher->onWorkDone(work->input.ordinal.frameIndex.peeku());
+        if (watcher->currentSmoothnessFactor() != smoothnessFactor) {
+            // Puts the tuning decisions on the same system trace as the frames.
+            ATRACE_INT(StringPrintf("%s smoothness factor", mName).c_str(),
+                       watcher->currentSmoothnessFactor());
+        }
     }
+    mFrameLatencyTracer.record(
+            work->input.ordinal.frameIndex.peeku(), FrameLatencyTracer::WORK_DONE,
+            systemTime(SYSTEM_TIME_MONOTONIC));
 
     // NOTE: MediaCodec usage supposedly have only one worklet
     if (work->worklets.size() != 1u) {
@@ -2466,7 +2683,9 @@ bool CCodecBufferChannel::handleWork(
         timestamp = work->input.ordinal.customOrdinal;
     }
     ScopedTrace trace(ATRACE_TAG, android::base::StringPrintf(
-            "CCodecBufferChannel::onWorkDone(%s@ts=%lld)", mName, timestamp.peekll()).c_str());
+            "CCodecBufferChannel::onWorkDone(%s#%llu@ts=%lld)", mName,
+            (unsigned long long)work->input.ordinal.frameIndex.peeku(),
+            timestamp.peekll()).c_str());
     ALOGV("[%s] onWorkDone: input %lld, codec %lld => output %lld => %lld",
           mName,
           work->input.ordinal.customOrdinal.peekll(),
@@ -2755,6 +2974,39 @@ uint32_t CCodecBufferChannel::getBuffersPixelFormat(bool isEncoder) {
     }
 }
 
+void CCodecBufferChannel::getPipelineDepthStats(
+        uint32_t *numAdjustments, std::string *trace) {
+    Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+    *numAdjustments = watcher->numAdjustments();
+    *trace = watcher->adjustmentTrace();
+}
+
+FrameLatencyTracer::Percentiles CCodecBufferChannel::getFrameLatency(
+        FrameLatencyTracer::Stage from, FrameLatencyTracer::Stage to) const {
+    return mFrameLatencyTracer.latency(from, to);
+}
+
+std::string CCodecBufferChannel::getFrameLatencyTrace() const {
+    return mFrameLatencyTracer.toJson(mName);
+}
+
+InputBuffers::BlockStats CCodecBufferChannel::getInputBlockStats() {
+    Mutexed<Input>::Locked input(mInput);
+    if (input->buffers == nullptr) {
+        return {};
+    }
+    return input->buffers->blockStats();
+}
+
+uint64_t CCodecBufferChannel::getNextFrameIndex() const {
+    return mFrameIndex.load();
+}
+
+void CCodecBufferChannel::setFirstFrameIndex(uint64_t frameIndex) {
+    mFrameIndex = frameIndex;
+    mFirstValidFrameIndex = frameIndex;
+}
+
 uint32_t CCodecBufferChannel::getInputBuffersPixelFormat() {
     Mutexed<Input>::Locked input(mInput);
     if (input->buffers == nullptr) {
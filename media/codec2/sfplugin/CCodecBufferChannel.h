@@ -21,6 +21,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <C2Buffer.h>
@@ -31,7 +32,9 @@
 #include <media/stagefright/foundation/Mutexed.h>
 #include <media/stagefright/CodecBase.h>
 
+#include "AccessUnitAggregator.h"
 #include "CCodecBuffers.h"
+#include "FrameLatencyTracer.h"
 #include "FrameReassembler.h"
 #include "InputSurfaceWrapper.h"
 #include "PipelineWatcher.h"
@@ -47,6 +50,11 @@ public:
     virtual void onOutputFramesRendered(int64_t mediaTimeUs, nsecs_t renderTimeNs) = 0;
     virtual void onOutputBuffersChanged() = 0;
     virtual void onFirstTunnelFrameReady() = 0;
+    /**
+     * A batch of aggregated access units is pending; call
+     * CCodecBufferChannel::queuePendingAccessUnits() after |delayUs|.
+     */
+    virtual void onAccessUnitsPending(int64_t delayUs) = 0;
 };
 
 /**
@@ -209,6 +217,12 @@ public:
      */
     void onInputBufferDone(uint64_t frameIndex, size_t arrayIndex);
 
+    /**
+     * Queue the pending batch of aggregated access units if it has waited for
+     * the maximum aggregation delay, or if the component is waiting for input.
+     */
+    void queuePendingAccessUnits();
+
     PipelineWatcher::Clock::duration elapsed();
 
     enum MetaMode {
@@ -227,6 +241,43 @@ public:
 
     void resetBuffersPixelFormat(bool isEncoder);
 
+    /**
+     * Get the counters of blocks backing the input buffers.
+     */
+    InputBuffers::BlockStats getInputBlockStats();
+
+    /**
+     * Get the frame index of the next work item queued to the component.
+     */
+    uint64_t getNextFrameIndex() const;
+
+    /**
+     * Number work items from |frameIndex| on, e.g. to keep them apart from
+     * the work items of a previous user of the component. Must be called
+     * before the channel is started.
+     */
+    void setFirstFrameIndex(uint64_t frameIndex);
+
+    /**
+     * Get the adjustments made to the pipeline depth of a low-latency stream.
+     *
+     * @param numAdjustments  number of adjustments
+     * @param trace           description of the latest adjustments
+     */
+    void getPipelineDepthStats(uint32_t *numAdjustments, std::string *trace);
+
+    /**
+     * Get the distribution of the time the latest frames took between two
+     * stages of the pipeline.
+     */
+    FrameLatencyTracer::Percentiles getFrameLatency(
+            FrameLatencyTracer::Stage from, FrameLatencyTracer::Stage to) const;
+
+    /**
+     * Get the latest frames as a trace in the Chrome JSON trace event format.
+     */
+    std::string getFrameLatencyTrace() const;
+
     /**
      * Queue a C2 info buffer that will be sent to codec in the subsequent
      * queueInputBuffer
@@ -306,6 +357,8 @@ private:
 
     void feedInputBufferIfAvailable();
     void feedInputBufferIfAvailableInternal();
+    // Called with a running QueueGuard held.
+    void queuePendingAccessUnitsIfDue();
     status_t queueInputBufferInternal(sp<MediaCodecBuffer> buffer,
                                       std::shared_ptr<C2LinearBlock> encryptedBlock = nullptr,
                                       size_t blockSize = 0);
@@ -349,8 +402,12 @@ private:
         c2_cntr64_t lastFlushIndex;
 
         FrameReassembler frameReassembler;
+        AccessUnitAggregator accessUnitAggregator;
     };
     Mutexed<Input> mInput;
+    // Serializes queueing of aggregated access units between the client
+    // thread and the thread delivering onWorkDone().
+    std::mutex mAccessUnitQueueLock;
     struct Output {
         std::unique_ptr<OutputBuffers> buffers;
         size_t numSlots;
@@ -395,6 +452,7 @@ private:
     MetaMode mMetaMode;
 
     Mutexed<PipelineWatcher> mPipelineWatcher;
+    FrameLatencyTracer mFrameLatencyTracer;
 
     std::atomic_bool mInputMetEos;
     std::once_flag mRenderWarningFlag;
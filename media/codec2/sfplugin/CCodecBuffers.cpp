@@ -664,6 +664,47 @@ void LocalBufferPool::returnVector(std::vector<uint8_t> &&vec) {
     mPool.push_front(std::move(vec));
 }
 
+// LinearBufferRecycler
+
+sp<Codec2Buffer> LinearBufferRecycler::obtain(size_t capacity) {
+    std::vector<Entry> &entries = mClasses[ClassOf(capacity)];
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->compBuffer.expired() && it->clientBuffer->capacity() >= capacity) {
+            sp<Codec2Buffer> buffer = std::move(it->clientBuffer);
+            entries.erase(it);
+            buffer->meta()->clear();
+            buffer->setRange(0, buffer->capacity());
+            return buffer;
+        }
+    }
+    return nullptr;
+}
+
+void LinearBufferRecycler::recycle(
+        const sp<Codec2Buffer> &buffer, const std::shared_ptr<C2Buffer> &compBuffer) {
+    std::vector<Entry> &entries = mClasses[ClassOf(buffer->capacity())];
+    if (entries.size() >= kMaxBuffersPerClass) {
+        return;
+    }
+    entries.push_back({ buffer, compBuffer });
+}
+
+void LinearBufferRecycler::clear() {
+    for (std::vector<Entry> &entries : mClasses) {
+        entries.clear();
+    }
+}
+
+// static
+size_t LinearBufferRecycler::ClassOf(size_t capacity) {
+    size_t index = 0;
+    while (index + 1 < std::tuple_size_v<decltype(mClasses)>
+            && (size_t(1) << index) < capacity) {
+        ++index;
+    }
+    return index;
+}
+
 // FlexBuffersImpl
 
 size_t FlexBuffersImpl::assignSlot(const sp<Codec2Buffer> &buffer) {
@@ -939,8 +980,28 @@ size_t InputBuffersArray::numActiveSlots() const {
     return mImpl.numActiveSlots();
 }
 
+void InputBuffersArray::recycleClone(
+        const sp<Codec2Buffer> &clone, const std::shared_ptr<C2Buffer> &compBuffer) {
+    if (mCloneCapacity > 0) {
+        mCloneRecycler.recycle(clone, compBuffer);
+    }
+}
+
 sp<Codec2Buffer> InputBuffersArray::createNewBuffer() {
-    return mAllocate();
+    sp<Codec2Buffer> buffer;
+    if (mCloneCapacity > 0) {
+        buffer = mCloneRecycler.obtain(mCloneCapacity);
+        if (buffer) {
+            buffer->setFormat(mFormat);
+            ++mBlockStats.recycled;
+            return buffer;
+        }
+    }
+    buffer = mAllocate();
+    if (buffer) {
+        ++mBlockStats.fetched;
+    }
+    return buffer;
 }
 
 // SlotInputBuffers
@@ -997,7 +1058,18 @@ bool LinearInputBuffers::releaseBuffer(
         const sp<MediaCodecBuffer> &buffer,
         std::shared_ptr<C2Buffer> *c2buffer,
         bool release) {
-    return mImpl.releaseSlot(buffer, c2buffer, release);
+    std::shared_ptr<C2Buffer> compBuffer;
+    if (!mImpl.releaseSlot(buffer, &compBuffer, release)) {
+        return false;
+    }
+    if (release) {
+        // All client buffers on file are Codec2Buffer's.
+        mRecycler.recycle(static_cast<Codec2Buffer *>(buffer.get()), compBuffer);
+    }
+    if (c2buffer) {
+        *c2buffer = compBuffer;
+    }
+    return true;
 }
 
 bool LinearInputBuffers::expireComponentBuffer(
@@ -1016,6 +1088,8 @@ std::unique_ptr<InputBuffers> LinearInputBuffers::toArrayMode(size_t size) {
             new InputBuffersArray(mComponentName.c_str(), "1D-Input[N]"));
     array->setPool(mPool);
     array->setFormat(mFormat);
+    array->setBlockStats(mBlockStats);
+    array->setCloneCapacity(GetCapacity(mFormat));
     array->initialize(
             mImpl,
             size,
@@ -1030,14 +1104,20 @@ size_t LinearInputBuffers::numActiveSlots() const {
 }
 
 // static
-sp<Codec2Buffer> LinearInputBuffers::Alloc(
-        const std::shared_ptr<C2BlockPool> &pool, const sp<AMessage> &format) {
+size_t LinearInputBuffers::GetCapacity(const sp<AMessage> &format) {
     int32_t capacity = kLinearBufferSize;
     (void)format->findInt32(KEY_MAX_INPUT_SIZE, &capacity);
     if ((size_t)capacity > kMaxLinearBufferSize) {
         ALOGD("client requested %d, capped to %zu", capacity, kMaxLinearBufferSize);
         capacity = kMaxLinearBufferSize;
     }
+    return capacity;
+}
+
+// static
+sp<Codec2Buffer> LinearInputBuffers::Alloc(
+        const std::shared_ptr<C2BlockPool> &pool, const sp<AMessage> &format) {
+    size_t capacity = GetCapacity(format);
 
     int64_t usageValue = 0;
     (void)format->findInt64("android._C2MemoryUsage", &usageValue);
@@ -1053,7 +1133,17 @@ sp<Codec2Buffer> LinearInputBuffers::Alloc(
 }
 
 sp<Codec2Buffer> LinearInputBuffers::createNewBuffer() {
-    return Alloc(mPool, mFormat);
+    sp<Codec2Buffer> buffer = mRecycler.obtain(GetCapacity(mFormat));
+    if (buffer) {
+        buffer->setFormat(mFormat);
+        ++mBlockStats.recycled;
+        return buffer;
+    }
+    buffer = Alloc(mPool, mFormat);
+    if (buffer) {
+        ++mBlockStats.fetched;
+    }
+    return buffer;
 }
 
 // EncryptedLinearInputBuffers
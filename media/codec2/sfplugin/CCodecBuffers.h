@@ -18,6 +18,7 @@
 
 #define CCODEC_BUFFERS_H_
 
+#include <array>
 #include <optional>
 #include <string>
 #include <vector>
@@ -164,12 +165,38 @@ public:
      */
     sp<Codec2Buffer> cloneAndReleaseBuffer(const sp<MediaCodecBuffer> &buffer);
 
+    /**
+     * Take back |clone| returned from cloneAndReleaseBuffer() once the client
+     * is done with it; it may back a later clone after |compBuffer| expires.
+     * No-op by default.
+     */
+    virtual void recycleClone(
+            const sp<Codec2Buffer> &clone, const std::shared_ptr<C2Buffer> &compBuffer) {
+        (void)clone;
+        (void)compBuffer;
+    }
+
+    /**
+     * Number of input buffers handed out with a newly fetched block, and with
+     * a recycled one.
+     */
+    struct BlockStats {
+        uint64_t fetched = 0;
+        uint64_t recycled = 0;
+    };
+
+    const BlockStats &blockStats() const { return mBlockStats; }
+
+    void setBlockStats(const BlockStats &stats) { mBlockStats = stats; }
+
 protected:
     virtual sp<Codec2Buffer> createNewBuffer() = 0;
 
     // Pool to obtain blocks for input buffers.
     std::shared_ptr<C2BlockPool> mPool;
 
+    BlockStats mBlockStats;
+
 private:
     DISALLOW_EVIL_CONSTRUCTORS(InputBuffers);
 };
@@ -560,6 +587,51 @@ private:
     DISALLOW_EVIL_CONSTRUCTORS(LocalBufferPool);
 };
 
+/**
+ * Free list of linear client buffers, binned by power-of-two capacity class.
+ *
+ * A buffer is put back when the client releases it, and handed out again only
+ * after the component has dropped the C2Buffer queued from it --- the same
+ * condition under which array mode reuses its buffers. This saves fetching and
+ * mapping a new block for every input buffer. Like the rest of the input
+ * buffers, this object is only accessed with the channel's input lock held.
+ */
+class LinearBufferRecycler {
+public:
+    LinearBufferRecycler() = default;
+
+    /**
+     * Return a recycled buffer with at least |capacity| bytes, with its range
+     * and meta reset; nullptr if none is available.
+     */
+    sp<Codec2Buffer> obtain(size_t capacity);
+
+    /**
+     * Keep |buffer| for reuse once |compBuffer| expires.
+     */
+    void recycle(const sp<Codec2Buffer> &buffer, const std::shared_ptr<C2Buffer> &compBuffer);
+
+    /**
+     * Drop all buffers.
+     */
+    void clear();
+
+private:
+    struct Entry {
+        sp<Codec2Buffer> clientBuffer;
+        std::weak_ptr<C2Buffer> compBuffer;
+    };
+    // Buffers kept per capacity class; the number of input slots is normally
+    // well below this.
+    static constexpr size_t kMaxBuffersPerClass = 16;
+
+    static size_t ClassOf(size_t capacity);
+
+    std::array<std::vector<Entry>, 32> mClasses;
+
+    DISALLOW_EVIL_CONSTRUCTORS(LinearBufferRecycler);
+};
+
 class BuffersArrayImpl;
 
 /**
@@ -796,12 +868,24 @@ public:
 
     size_t numActiveSlots() const final;
 
+    /**
+     * Back clones with recycled linear buffers of at least |capacity| bytes
+     * instead of allocating a new block for each.
+     */
+    void setCloneCapacity(size_t capacity) { mCloneCapacity = capacity; }
+
+    void recycleClone(
+            const sp<Codec2Buffer> &clone, const std::shared_ptr<C2Buffer> &compBuffer) override;
+
 protected:
     sp<Codec2Buffer> createNewBuffer() override;
 
 private:
     BuffersArrayImpl mImpl;
     std::function<sp<Codec2Buffer>()> mAllocate;
+    // Non-zero if clones are linear buffers that can be recycled.
+    size_t mCloneCapacity = 0;
+    LinearBufferRecycler mCloneRecycler;
 };
 
 class SlotInputBuffers : public InputBuffers {
@@ -863,8 +947,12 @@ protected:
     FlexBuffersImpl mImpl;
 
 private:
+    static size_t GetCapacity(const sp<AMessage> &format);
+
     static sp<Codec2Buffer> Alloc(
             const std::shared_ptr<C2BlockPool> &pool, const sp<AMessage> &format);
+
+    LinearBufferRecycler mRecycler;
 };
 
 class EncryptedLinearInputBuffers : public LinearInputBuffers {
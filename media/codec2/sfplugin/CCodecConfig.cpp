@@ -18,6 +18,8 @@
 #define LOG_TAG "CCodecConfig"
 
 #include <initializer_list>
+#include <map>
+#include <mutex>
 
 #include <android_media_codec.h>
 
@@ -1054,6 +1056,50 @@ void CCodecConfig::initializeStandardParams() {
     */
 }
 
+namespace {
+
+/**
+ * Supported parameters of the components created in this process, by component
+ * name. An entry is only valid with the reflector it was recorded with: the
+ * client keeps one reflector per service, and a new one once a service dies.
+ */
+class SupportedParamsCache {
+public:
+    static SupportedParamsCache &Get() {
+        static SupportedParamsCache sCache;
+        return sCache;
+    }
+
+    bool find(const std::string &name,
+              const std::shared_ptr<C2ParamReflector> &reflector,
+              std::vector<std::shared_ptr<C2ParamDescriptor>> *paramDescs) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(name);
+        if (it == mEntries.end() || it->second.reflector.lock() != reflector) {
+            return false;
+        }
+        *paramDescs = it->second.paramDescs;
+        return true;
+    }
+
+    void put(const std::string &name,
+             const std::shared_ptr<C2ParamReflector> &reflector,
+             const std::vector<std::shared_ptr<C2ParamDescriptor>> &paramDescs) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries[name] = Entry{reflector, paramDescs};
+    }
+
+private:
+    struct Entry {
+        std::weak_ptr<C2ParamReflector> reflector;
+        std::vector<std::shared_ptr<C2ParamDescriptor>> paramDescs;
+    };
+    std::mutex mMutex;
+    std::map<std::string, Entry> mEntries;
+};
+
+}  // namespace
+
 status_t CCodecConfig::initialize(
         const std::shared_ptr<C2ParamReflector> &reflector,
         const std::shared_ptr<Codec2Client::Configurable> &configurable) {
@@ -1109,11 +1155,18 @@ status_t CCodecConfig::initialize(
         mCodingMediaType = "";
     }
 
-    c2err = configurable->querySupportedParams(&mParamDescs);
-    if (c2err != C2_OK) {
-        ALOGD("Query supported params failed after returning %zu values => %s",
-                mParamDescs.size(), asString(c2err));
-        return UNKNOWN_ERROR;
+    SupportedParamsCache &supportedParamsCache = SupportedParamsCache::Get();
+    if (reflector == nullptr
+            || !supportedParamsCache.find(configurable->getName(), reflector, &mParamDescs)) {
+        c2err = configurable->querySupportedParams(&mParamDescs);
+        if (c2err != C2_OK) {
+            ALOGD("Query supported params failed after returning %zu values => %s",
+                    mParamDescs.size(), asString(c2err));
+            return UNKNOWN_ERROR;
+        }
+        if (reflector) {
+            supportedParamsCache.put(configurable->getName(), reflector, mParamDescs);
+        }
     }
     for (const std::shared_ptr<C2ParamDescriptor> &desc : mParamDescs) {
         mSupportedIndices.emplace(desc->index());
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "FrameLatencyTracer"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <android-base/stringprintf.h>
+#include <log/log.h>
+
+#include "FrameLatencyTracer.h"
+
+namespace android {
+
+namespace {
+
+// Name of the span that starts at |stage|.
+const char *spanName(FrameLatencyTracer::Stage stage) {
+    switch (stage) {
+        case FrameLatencyTracer::QUEUED:         return "queueing";
+        case FrameLatencyTracer::SUBMITTED:      return "consuming";
+        case FrameLatencyTracer::INPUT_RELEASED: return "processing";
+        case FrameLatencyTracer::WORK_DONE:      return "output";
+        default:                                 return "?";
+    }
+}
+
+// Chrome trace timestamps are in microseconds.
+std::string toUs(nsecs_t ns) {
+    return base::StringPrintf("%lld.%03lld", (long long)(ns / 1000), (long long)(ns % 1000));
+}
+
+}  // namespace
+
+FrameLatencyTracer::FrameLatencyTracer(size_t capacity)
+    : mCapacity(std::max(capacity, size_t(1))),
+      mSlots(new Slot[mCapacity]) {
+    clear();
+}
+
+void FrameLatencyTracer::onQueued(uint64_t frameIndex, nsecs_t queuedAt) {
+    Slot &slot = mSlots[frameIndex % mCapacity];
+    // Readers that see any of the new times also see the slot as changed.
+    slot.tag.store(0, std::memory_order_relaxed);
+    for (std::atomic<nsecs_t> &time : slot.times) {
+        time.store(0, std::memory_order_release);
+    }
+    slot.times[QUEUED].store(queuedAt, std::memory_order_release);
+    slot.tag.store(frameIndex + 1, std::memory_order_release);
+}
+
+void FrameLatencyTracer::record(uint64_t frameIndex, Stage stage, nsecs_t at) {
+    if (stage >= NUM_STAGES) {
+        return;
+    }
+    Slot &slot = mSlots[frameIndex % mCapacity];
+    if (slot.tag.load(std::memory_order_acquire) != frameIndex + 1) {
+        ALOGV("record: frame index %llu is not tracked", (unsigned long long)frameIndex);
+        return;
+    }
+    slot.times[stage].store(at, std::memory_order_release);
+}
+
+void FrameLatencyTracer::clear() {
+    for (size_t i = 0; i < mCapacity; ++i) {
+        mSlots[i].tag.store(0, std::memory_order_release);
+        for (std::atomic<nsecs_t> &time : mSlots[i].times) {
+            time.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename Fn>
+void FrameLatencyTracer::forEachEntry(Fn fn) const {
+    for (size_t i = 0; i < mCapacity; ++i) {
+        const Slot &slot = mSlots[i];
+        uint64_t tag = slot.tag.load(std::memory_order_acquire);
+        if (tag == 0) {
+            continue;
+        }
+        Entry entry;
+        entry.frameIndex = tag - 1;
+        for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+            entry.times[stage] = slot.times[stage].load(std::memory_order_acquire);
+        }
+        if (slot.tag.load(std::memory_order_relaxed) != tag) {
+            // overwritten while reading
+            continue;
+        }
+        fn(entry);
+    }
+}
+
+FrameLatencyTracer::Percentiles FrameLatencyTracer::latency(Stage from, Stage to) const {
+    Percentiles result;
+    if (from >= NUM_STAGES || to >= NUM_STAGES) {
+        return result;
+    }
+    std::vector<nsecs_t> latencies;
+    forEachEntry([from, to, &latencies](const Entry &entry) {
+        if (entry.times[from] != 0 && entry.times[to] >= entry.times[from]) {
+            latencies.push_back(entry.times[to] - entry.times[from]);
+        }
+    });
+    if (latencies.empty()) {
+        return result;
+    }
+    auto percentile = [&latencies](size_t p) {
+        auto it = latencies.begin() + (latencies.size() - 1) * p / 100;
+        std::nth_element(latencies.begin(), it, latencies.end());
+        return *it;
+    };
+    result.count = latencies.size();
+    result.p50 = percentile(50);
+    result.p90 = percentile(90);
+    result.p99 = percentile(99);
+    return result;
+}
+
+std::string FrameLatencyTracer::toJson(const std::string &name) const {
+    std::vector<Entry> entries;
+    forEachEntry([&entries](const Entry &entry) { entries.push_back(entry); });
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.frameIndex < b.frameIndex;
+    });
+
+    const int pid = getpid();
+    std::string json = "[";
+    bool first = true;
+    auto addEvent = [&](const char *eventName, char phase, uint64_t id, nsecs_t ts) {
+        json += first ? "\n" : ",\n";
+        first = false;
+        json += base::StringPrintf(
+                "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"id\":%llu,"
+                "\"ts\":%s,\"pid\":%d,\"tid\":%d}",
+                eventName, name.c_str(), phase, (unsigned long long)id,
+                toUs(ts).c_str(), pid, pid);
+    };
+    for (const Entry &entry : entries) {
+        Stage last = QUEUED;
+        for (size_t stage = SUBMITTED; stage < NUM_STAGES; ++stage) {
+            if (entry.times[stage] >= entry.times[QUEUED]) {
+                last = Stage(stage);
+            }
+        }
+        if (last == QUEUED) {
+            continue;
+        }
+        std::string frameName = base::StringPrintf(
+                "frame #%llu", (unsigned long long)entry.frameIndex);
+        addEvent(frameName.c_str(), 'b', entry.frameIndex, entry.times[QUEUED]);
+        Stage begin = QUEUED;
+        for (size_t stage = SUBMITTED; stage <= last; ++stage) {
+            if (entry.times[stage] < entry.times[begin]) {
+                continue;
+            }
+            addEvent(spanName(begin), 'b', entry.frameIndex, entry.times[begin]);
+            addEvent(spanName(begin), 'e', entry.frameIndex, entry.times[stage]);
+            begin = Stage(stage);
+        }
+        addEvent(frameName.c_str(), 'e', entry.frameIndex, entry.times[last]);
+    }
+    json += "\n]\n";
+    return json;
+}
+
+}  // namespace android
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAME_LATENCY_TRACER_H_
+#define FRAME_LATENCY_TRACER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <utils/Timers.h>
+
+namespace android {
+
+/**
+ * FrameLatencyTracer keeps the time each of the latest work items reached
+ * each stage of the pipeline, keyed by input frame index, in a fixed size
+ * ring buffer.
+ *
+ * Recording is lock-free and may happen from any thread. Readers may run
+ * concurrently with writers; entries that are being overwritten while read
+ * are skipped. A late event for a frame whose slot has just been reused can
+ * be attributed to the newer frame, which is acceptable for diagnostics.
+ */
+class FrameLatencyTracer {
+public:
+    enum Stage : size_t {
+        QUEUED,          // client queued the input buffer to MediaCodec
+        SUBMITTED,       // work item queued to the component
+        INPUT_RELEASED,  // component released the input buffer
+        WORK_DONE,       // component returned the work item
+        RELEASED,        // client rendered or released the output buffer
+        NUM_STAGES,
+    };
+
+    static constexpr size_t kDefaultCapacity = 512;
+
+    explicit FrameLatencyTracer(size_t capacity = kDefaultCapacity);
+    ~FrameLatencyTracer() = default;
+
+    /**
+     * Start tracking work item |frameIndex|, replacing the oldest entry if
+     * needed.
+     *
+     * \param frameIndex  input frame index
+     * \param queuedAt    time when the client queued the input, in the
+     *                    systemTime(SYSTEM_TIME_MONOTONIC) time base
+     */
+    void onQueued(uint64_t frameIndex, nsecs_t queuedAt);
+
+    /**
+     * Record the time work item |frameIndex| reached |stage|. Ignored if the
+     * work item is not tracked.
+     */
+    void record(uint64_t frameIndex, Stage stage, nsecs_t at);
+
+    /**
+     * Forget all work items.
+     */
+    void clear();
+
+    struct Percentiles {
+        size_t count = 0;
+        nsecs_t p50 = 0;
+        nsecs_t p90 = 0;
+        nsecs_t p99 = 0;
+    };
+
+    /**
+     * \return  distribution of the time tracked work items took from |from|
+     *          to |to|, over the items that reached both stages.
+     */
+    Percentiles latency(Stage from, Stage to) const;
+
+    /**
+     * \return  tracked work items as a trace in the Chrome JSON trace event
+     *          format, which Perfetto UI and chrome://tracing load. Each work
+     *          item is an async track made of the spans between the stages
+     *          it reached. Each event is on a line of its own.
+     *
+     * \param name  name of the codec, used as the trace category
+     */
+    std::string toJson(const std::string &name) const;
+
+private:
+    struct Slot {
+        // frame index + 1; 0 if the slot is not in use
+        std::atomic<uint64_t> tag;
+        std::atomic<nsecs_t> times[NUM_STAGES];
+    };
+    struct Entry {
+        uint64_t frameIndex;
+        nsecs_t times[NUM_STAGES];
+    };
+
+    const size_t mCapacity;
+    std::unique_ptr<Slot[]> mSlots;
+
+    /**
+     * Call |fn| with a consistent copy of each tracked entry.
+     */
+    template <typename Fn>
+    void forEachEntry(Fn fn) const;
+};
+
+}  // namespace android
+
+#endif  // FRAME_LATENCY_TRACER_H_
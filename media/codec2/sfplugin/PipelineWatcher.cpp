@@ -17,8 +17,10 @@
 //#define LOG_NDEBUG 0
 #define LOG_TAG "PipelineWatcher"
 
+#include <algorithm>
 #include <numeric>
 
+#include <android-base/stringprintf.h>
 #include <log/log.h>
 
 #include "PipelineWatcher.h"
@@ -42,6 +44,7 @@ PipelineWatcher &PipelineWatcher::outputDelay(uint32_t value) {
 
 PipelineWatcher &PipelineWatcher::smoothnessFactor(uint32_t value) {
     mSmoothnessFactor = value;
+    resetTuning();
     return *this;
 }
 
@@ -50,6 +53,23 @@ PipelineWatcher &PipelineWatcher::tunneled(bool value) {
     return *this;
 }
 
+PipelineWatcher &PipelineWatcher::adaptive(bool value) {
+    mAdaptive = value;
+    resetTuning();
+    return *this;
+}
+
+void PipelineWatcher::resetTuning() {
+    mTuningStartedAt = Clock::now();
+    mCurrentSmoothnessFactor = mSmoothnessFactor;
+    mMinSmoothnessFactor = std::min(kMinSmoothnessFactor, mSmoothnessFactor);
+    mWindow = Window();
+    mLastThroughput.reset();
+    mLastAdjustmentShrank = false;
+    mTrace.clear();
+    mNumAdjustments = 0;
+}
+
 void PipelineWatcher::onWorkQueued(
         uint64_t frameIndex,
         std::vector<std::shared_ptr<C2Buffer>> &&buffers,
@@ -65,6 +85,13 @@ void PipelineWatcher::onWorkQueued(
         (void)mFramesInPipeline.erase(it);
     }
     (void)mFramesInPipeline.try_emplace(frameIndex, std::move(buffers), queuedAt);
+    if (mAdaptive) {
+        if (mWindow.start == Clock::time_point()) {
+            mWindow.start = queuedAt;
+        }
+        ++mWindow.numQueued;
+        mWindow.totalOccupancy += mFramesInPipeline.size();
+    }
 }
 
 std::shared_ptr<C2Buffer> PipelineWatcher::onInputBufferReleased(
@@ -88,7 +115,7 @@ std::shared_ptr<C2Buffer> PipelineWatcher::onInputBufferReleased(
     return buffer;
 }
 
-void PipelineWatcher::onWorkDone(uint64_t frameIndex) {
+void PipelineWatcher::onWorkDone(uint64_t frameIndex, const Clock::time_point &doneAt) {
     ALOGV("onWorkDone(frameIndex=%llu)", (unsigned long long)frameIndex);
     auto it = mFramesInPipeline.find(frameIndex);
     if (it == mFramesInPipeline.end()) {
@@ -101,17 +128,88 @@ void PipelineWatcher::onWorkDone(uint64_t frameIndex) {
         }
         return;
     }
+    if (mAdaptive) {
+        ++mWindow.numDone;
+        mWindow.totalLatency += doneAt - it->second.queuedAt;
+    }
     (void)mFramesInPipeline.erase(it);
+    if (mAdaptive && mWindow.numDone >= kTuningWindow) {
+        tune(doneAt);
+    }
 }
 
 void PipelineWatcher::flush() {
     ALOGV("flush");
     mFramesInPipeline.clear();
+    // Throughput across a flush is not comparable; keep the current
+    // smoothness factor but start observing afresh.
+    mWindow = Window();
+    mLastThroughput.reset();
+    mLastAdjustmentShrank = false;
+}
+
+void PipelineWatcher::tune(const Clock::time_point &now) {
+    const Window window = mWindow;
+    mWindow = Window();
+    mWindow.start = now;
+    double seconds = std::chrono::duration<double>(now - window.start).count();
+    if (seconds <= 0.0 || window.numQueued == 0u) {
+        return;
+    }
+    double throughput = window.numDone / seconds;
+    Clock::duration latency = window.totalLatency / window.numDone;
+    double occupancy = double(window.totalOccupancy) / window.numQueued;
+
+    uint32_t from = mCurrentSmoothnessFactor;
+    uint32_t to = from;
+    if (mLastAdjustmentShrank && mLastThroughput
+            && throughput < *mLastThroughput * (1.0 - kThroughputTolerance)) {
+        // The previous step starved the component; step back and stay there.
+        to = std::min(from + 1, mSmoothnessFactor);
+        mMinSmoothnessFactor = to;
+    } else if (from > mMinSmoothnessFactor
+            && occupancy > mInputDelay + mPipelineDelay + mOutputDelay) {
+        // Work items are waiting in the slack beyond the component delays.
+        to = from - 1;
+    }
+    ALOGV("tune: %.1f works/s, latency %lldus, %.1f in flight: smoothness factor %u -> %u",
+          throughput,
+          (long long)std::chrono::duration_cast<std::chrono::microseconds>(latency).count(),
+          occupancy, from, to);
+    mLastAdjustmentShrank = (to < from);
+    mLastThroughput = throughput;
+    if (to == from) {
+        return;
+    }
+    mCurrentSmoothnessFactor = to;
+    ++mNumAdjustments;
+    mTrace.push_back({now, from, to, throughput, latency, occupancy});
+    if (mTrace.size() > kMaxTraceEntries) {
+        mTrace.pop_front();
+    }
+}
+
+std::string PipelineWatcher::adjustmentTrace() const {
+    std::string trace;
+    for (const Adjustment &adjustment : mTrace) {
+        if (!trace.empty()) {
+            trace += "; ";
+        }
+        trace += base::StringPrintf(
+                "+%lldms %u->%u (%.1f/s, %lldms, %.1f in flight)",
+                (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                        adjustment.at - mTuningStartedAt).count(),
+                adjustment.from, adjustment.to, adjustment.throughput,
+                (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                        adjustment.latency).count(),
+                adjustment.occupancy);
+    }
+    return trace;
 }
 
 bool PipelineWatcher::pipelineFull() const {
     if (mFramesInPipeline.size() >=
-            mInputDelay + mPipelineDelay + mOutputDelay + mSmoothnessFactor) {
+            mInputDelay + mPipelineDelay + mOutputDelay + mCurrentSmoothnessFactor) {
         ALOGV("pipelineFull: too many frames in pipeline (%zu)", mFramesInPipeline.size());
         return true;
     }
@@ -127,14 +225,14 @@ bool PipelineWatcher::pipelineFull() const {
                 return true;
             });
     if (sizeWithInputReleased >=
-            mPipelineDelay + mOutputDelay + mSmoothnessFactor) {
+            mPipelineDelay + mOutputDelay + mCurrentSmoothnessFactor) {
         ALOGV("pipelineFull: too many frames in pipeline, with input released (%zu)",
               sizeWithInputReleased);
         return true;
     }
 
     size_t sizeWithInputsPending = mFramesInPipeline.size() - sizeWithInputReleased;
-    if (sizeWithInputsPending > mPipelineDelay + mInputDelay + mSmoothnessFactor) {
+    if (sizeWithInputsPending > mPipelineDelay + mInputDelay + mCurrentSmoothnessFactor) {
         ALOGV("pipelineFull: too many inputs pending (%zu) in pipeline, with inputs released (%zu)",
               sizeWithInputsPending, sizeWithInputReleased);
         return true;
@@ -144,6 +242,10 @@ bool PipelineWatcher::pipelineFull() const {
     return false;
 }
 
+bool PipelineWatcher::waitingForInput() const {
+    return mFramesInPipeline.size() <= mInputDelay + mPipelineDelay + mOutputDelay;
+}
+
 PipelineWatcher::Clock::duration PipelineWatcher::elapsed(
         const PipelineWatcher::Clock::time_point &now, size_t n) const {
     if (mFramesInPipeline.size() <= n) {
@@ -18,8 +18,11 @@
 #define PIPELINE_WATCHER_H_
 
 #include <chrono>
+#include <deque>
 #include <map>
 #include <memory>
+#include <optional>
+#include <string>
 
 #include <C2Work.h>
 
@@ -38,7 +41,12 @@ public:
           mPipelineDelay(0),
           mOutputDelay(0),
           mSmoothnessFactor(0),
-          mTunneled(false) {}
+          mTunneled(false),
+          mAdaptive(false),
+          mCurrentSmoothnessFactor(0),
+          mMinSmoothnessFactor(kMinSmoothnessFactor),
+          mLastAdjustmentShrank(false),
+          mNumAdjustments(0) {}
     ~PipelineWatcher() = default;
 
     /**
@@ -71,6 +79,21 @@ public:
      */
     PipelineWatcher &tunneled(bool value);
 
+    /**
+     * Enable or disable adaptive tuning of the smoothness factor.
+     *
+     * When enabled, the smoothness factor actually applied is lowered one
+     * step at a time, while in-flight work items occupy it, as long as the
+     * rate of completed work items does not drop. A step that costs
+     * throughput is reverted and not retried until the smoothness factor is
+     * set again. The delays advertised by the component are never reduced.
+     *
+     * \param value true to enable adaptive tuning, e.g. for low-latency
+     *              streams; false to always apply the full smoothness factor
+     * \return  this object
+     */
+    PipelineWatcher &adaptive(bool value);
+
     /**
      * Client queued a work item to the component.
      *
@@ -98,8 +121,9 @@ public:
      * The component finished processing a work item.
      *
      * \param frameIndex  input frame index
+     * \param doneAt      time when the work item was returned
      */
-    void onWorkDone(uint64_t frameIndex);
+    void onWorkDone(uint64_t frameIndex, const Clock::time_point &doneAt = Clock::now());
 
     /**
      * Flush the pipeline.
@@ -113,6 +137,14 @@ public:
      */
     bool pipelineFull() const;
 
+    /**
+     * \return  true  if the pipeline holds no more work items than the input,
+     *                pipeline and output delays, i.e. the component may not
+     *                produce further output without more input;
+     *          false otherwise.
+     */
+    bool waitingForInput() const;
+
     /**
      * Return elapsed processing time of a work item, nth from the longest
      * processing time to the shortest.
@@ -124,13 +156,71 @@ public:
      */
     Clock::duration elapsed(const Clock::time_point &now, size_t n) const;
 
+    /**
+     * \return  the smoothness factor currently applied, which is below the
+     *          configured one only if adaptive tuning lowered it.
+     */
+    uint32_t currentSmoothnessFactor() const { return mCurrentSmoothnessFactor; }
+
+    /**
+     * \return  number of adjustments made by adaptive tuning.
+     */
+    uint32_t numAdjustments() const { return mNumAdjustments; }
+
+    /**
+     * \return  human readable description of the latest adjustments made by
+     *          adaptive tuning, oldest first; empty if there were none.
+     */
+    std::string adjustmentTrace() const;
+
 private:
+    // Never throttle to less than one work item beyond the component delays,
+    // or a component without delays could not be fed at all.
+    static constexpr uint32_t kMinSmoothnessFactor = 1;
+    // Number of completed work items observed before each adjustment.
+    static constexpr size_t kTuningWindow = 30;
+    // Relative throughput drop that reverts the previous adjustment.
+    static constexpr double kThroughputTolerance = 0.1;
+    // Number of adjustments kept for adjustmentTrace().
+    static constexpr size_t kMaxTraceEntries = 16;
+
     uint32_t mInputDelay;
     uint32_t mPipelineDelay;
     uint32_t mOutputDelay;
     uint32_t mSmoothnessFactor;
     bool mTunneled;
 
+    bool mAdaptive;
+    Clock::time_point mTuningStartedAt;
+    uint32_t mCurrentSmoothnessFactor;
+    uint32_t mMinSmoothnessFactor;
+
+    // Observations since the last adjustment.
+    struct Window {
+        Clock::time_point start;
+        size_t numQueued = 0;
+        size_t totalOccupancy = 0;
+        size_t numDone = 0;
+        Clock::duration totalLatency = Clock::duration::zero();
+    };
+    Window mWindow;
+    std::optional<double> mLastThroughput;
+    bool mLastAdjustmentShrank;
+
+    struct Adjustment {
+        Clock::time_point at;
+        uint32_t from;
+        uint32_t to;
+        double throughput;
+        Clock::duration latency;
+        double occupancy;
+    };
+    std::deque<Adjustment> mTrace;
+    uint32_t mNumAdjustments;
+
+    void resetTuning();
+    void tune(const Clock::time_point &now);
+
     struct Frame {
         Frame(std::vector<std::shared_ptr<C2Buffer>> &&b,
               const Clock::time_point &q)
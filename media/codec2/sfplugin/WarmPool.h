@@ -0,0 +1,180 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WARM_POOL_H_
+#define WARM_POOL_H_
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+
+namespace android {
+
+/**
+ * WarmPool keeps idle items, such as released component instances, by name so
+ * that they can be reused instead of creating new ones.
+ *
+ * At most |capacity| items are kept per name, and items idle for longer than
+ * |maxIdleTime| expire. Items that leave the pool without being taken are
+ * handed back to the caller, who is responsible for disposing of them.
+ *
+ * This class is not thread-safe.
+ */
+template <typename T>
+class WarmPool {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    WarmPool(size_t capacity, Clock::duration maxIdleTime)
+        : mCapacity(capacity), mMaxIdleTime(maxIdleTime) {}
+    ~WarmPool() = default;
+
+    /**
+     * \return  the maximum number of items kept per name; 0 if the pool is
+     *          disabled.
+     */
+    size_t capacity() const { return mCapacity; }
+
+    /**
+     * Add |item| under |name|. If the pool is full for |name|, the least
+     * recently added items are moved to |evicted|.
+     */
+    void put(const std::string &name, T item, std::list<T> *evicted,
+             Clock::time_point now = Clock::now()) {
+        std::deque<Entry> &entries = mEntries[name];
+        entries.push_back({std::move(item), now + mMaxIdleTime});
+        while (entries.size() > mCapacity) {
+            evicted->push_back(std::move(entries.front().item));
+            entries.pop_front();
+        }
+        if (entries.empty()) {
+            mEntries.erase(name);
+        }
+    }
+
+    /**
+     * Take the most recently added item that has not expired under |name|.
+     *
+     * \return  true if an item was moved to |item|.
+     */
+    bool take(const std::string &name, T *item, Clock::time_point now = Clock::now()) {
+        auto it = mEntries.find(name);
+        if (it == mEntries.end()) {
+            return false;
+        }
+        std::deque<Entry> &entries = it->second;
+        bool found = false;
+        if (entries.back().expiresAt > now) {
+            *item = std::move(entries.back().item);
+            entries.pop_back();
+            found = true;
+        }
+        if (entries.empty()) {
+            mEntries.erase(it);
+        }
+        return found;
+    }
+
+    /**
+     * Take the item of any name for which |pred| returns true, whether or not
+     * it has expired.
+     *
+     * \return  true if an item was moved to |item|.
+     */
+    template <typename Pred>
+    bool takeIf(Pred pred, T *item) {
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+            std::deque<Entry> &entries = it->second;
+            auto found = std::find_if(entries.begin(), entries.end(),
+                                      [&pred](const Entry &entry) { return pred(entry.item); });
+            if (found == entries.end()) {
+                continue;
+            }
+            *item = std::move(found->item);
+            entries.erase(found);
+            if (entries.empty()) {
+                mEntries.erase(it);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Move expired items to |evicted|.
+     *
+     * \return  the time the next item expires, or Clock::time_point::max() if
+     *          the pool is empty.
+     */
+    Clock::time_point trim(std::list<T> *evicted, Clock::time_point now = Clock::now()) {
+        Clock::time_point next = Clock::time_point::max();
+        for (auto it = mEntries.begin(); it != mEntries.end(); ) {
+            std::deque<Entry> &entries = it->second;
+            // Entries of a name are ordered by expiry time.
+            while (!entries.empty() && entries.front().expiresAt <= now) {
+                evicted->push_back(std::move(entries.front().item));
+                entries.pop_front();
+            }
+            if (entries.empty()) {
+                it = mEntries.erase(it);
+                continue;
+            }
+            next = std::min(next, entries.front().expiresAt);
+            ++it;
+        }
+        return next;
+    }
+
+    /**
+     * Move all items to |evicted|.
+     */
+    void clear(std::list<T> *evicted) {
+        for (auto &[name, entries] : mEntries) {
+            for (Entry &entry : entries) {
+                evicted->push_back(std::move(entry.item));
+            }
+        }
+        mEntries.clear();
+    }
+
+    /**
+     * \return  the number of items in the pool.
+     */
+    size_t size() const {
+        size_t count = 0;
+        for (const auto &[name, entries] : mEntries) {
+            count += entries.size();
+        }
+        return count;
+    }
+
+private:
+    struct Entry {
+        T item;
+        Clock::time_point expiresAt;
+    };
+
+    const size_t mCapacity;
+    const Clock::duration mMaxIdleTime;
+    std::map<std::string, std::deque<Entry>> mEntries;
+};
+
+}  // namespace android
+
+#endif  // WARM_POOL_H_
@@ -64,6 +64,7 @@ public:
     virtual void signalSetParameters(const sp<AMessage> &params) override;
     virtual void signalEndOfInputStream() override;
     virtual void signalRequestIDRFrame() override;
+    virtual void signalReclaim() override;
 
     virtual status_t querySupportedParameters(std::vector<std::string> *names) override;
     virtual status_t describeParameter(
@@ -105,6 +106,12 @@ private:
 
     void initiateStop();
     void initiateRelease(bool sendCallback = true);
+    // Codec statistics are reported to the client as metrics on stop and
+    // release. Codecs have no dump hook of their own, and metrics are what
+    // "dumpsys media.metrics" shows.
+    void reportInputBlockStats();
+    void reportPipelineDepthStats();
+    void reportFrameLatency();
 
     void allocate(const sp<MediaCodecInfo> &codecInfo);
     void configure(const sp<AMessage> &msg);
@@ -113,6 +120,20 @@ private:
     void flush();
     void release(bool sendCallback, bool pushBlankBuffer);
 
+    /**
+     * Takes an idle instance of component |name| released by another CCodec
+     * from the process-wide pool, and binds it to this CCodec.
+     */
+    bool takeIdleComponent(
+            const std::string &name,
+            std::shared_ptr<Codec2Client::Component> *comp,
+            std::shared_ptr<Codec2Client> *client);
+    /**
+     * Hands the reset and restored component over to the pool, or releases
+     * it if it failed.
+     */
+    void recycleComponent(const std::shared_ptr<Codec2Client::Component> &comp);
+
     /**
      * Creates an input surface for the current device configuration compatible with CCodec.
      * This could be backed by the C2 HAL or the OMX HAL.
@@ -150,6 +171,7 @@ private:
 
         kWhatWorkDone,
         kWhatWatch,
+        kWhatQueuePendingAccessUnits,
     };
 
     enum {
@@ -207,6 +229,11 @@ private:
 
     sp<AMessage> mMetrics;
 
+    // Whether the component may be kept for reuse by another CCodec on release.
+    std::atomic_bool mReusable;
+    // Writable parameters of the component as created, restored before reuse.
+    std::shared_ptr<const std::vector<std::unique_ptr<C2Param>>> mComponentDefaults;
+
     friend class CCodecCallbackImpl;
 
     DISALLOW_EVIL_CONSTRUCTORS(CCodec);
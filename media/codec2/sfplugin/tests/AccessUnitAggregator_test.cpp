@@ -0,0 +1,245 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AccessUnitAggregator.h"
+
+#include <gtest/gtest.h>
+
+#include <C2PlatformSupport.h>
+
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/AMessage.h>
+
+namespace android {
+
+class AccessUnitAggregatorTest : public ::testing::Test {
+public:
+    static const C2MemoryUsage kUsage;
+    static constexpr uint64_t kFrameDurationUs = 21333;
+
+    AccessUnitAggregatorTest() {
+        mInitStatus = GetCodec2BlockPool(C2BlockPool::BASIC_LINEAR, nullptr, &mPool);
+    }
+
+    status_t initStatus() const { return mInitStatus; }
+
+    const std::shared_ptr<C2BlockPool> &pool() const { return mPool; }
+
+    // Access unit #|index| is |size| bytes of (index + j) & 0xFF.
+    static sp<MediaCodecBuffer> CreateAccessUnit(size_t index, size_t size) {
+        sp<MediaCodecBuffer> buffer = new MediaCodecBuffer(new AMessage, new ABuffer(size));
+        buffer->setRange(0, size);
+        for (size_t j = 0; j < size; ++j) {
+            buffer->base()[j] = ((index + j) & 0xFF);
+        }
+        buffer->meta()->setInt64("timeUs", index * kFrameDurationUs);
+        return buffer;
+    }
+
+    // Verify that |work| carries access units [|first|, |first| + |count|) of
+    // |size| bytes each.
+    static void VerifyBatch(
+            const std::unique_ptr<C2Work> &work, size_t first, size_t count, size_t size) {
+        EXPECT_EQ(first * kFrameDurationUs, work->input.ordinal.timestamp.peeku());
+        EXPECT_EQ(0u, work->input.flags);
+        ASSERT_EQ(1u, work->worklets.size());
+
+        ASSERT_EQ(1u, work->input.buffers.size());
+        std::shared_ptr<C2Buffer> buffer = work->input.buffers.front();
+        ASSERT_EQ(C2BufferData::LINEAR, buffer->data().type());
+        ASSERT_EQ(1u, buffer->data().linearBlocks().size());
+
+        std::shared_ptr<const C2AccessUnitInfos::input> infos =
+            std::static_pointer_cast<const C2AccessUnitInfos::input>(
+                    buffer->getInfo(C2AccessUnitInfos::input::PARAM_TYPE));
+        ASSERT_NE(nullptr, infos);
+        ASSERT_EQ(count, infos->flexCount());
+
+        C2ReadView view = buffer->data().linearBlocks().front().map().get();
+        ASSERT_EQ(C2_OK, view.error());
+        ASSERT_EQ(count * size, view.capacity());
+        for (size_t i = 0; i < count; ++i) {
+            const C2AccessUnitInfosStruct &info = infos->m.values[i];
+            EXPECT_EQ(size, info.size) << "access unit #" << (first + i);
+            EXPECT_EQ((first + i) * kFrameDurationUs, info.timestamp)
+                << "access unit #" << (first + i);
+            EXPECT_EQ(0u, info.flags) << "access unit #" << (first + i);
+            for (size_t j = 0; j < size; ++j) {
+                ASSERT_EQ(uint8_t((first + i + j) & 0xFF), view.data()[i * size + j])
+                    << "access unit #" << (first + i) << " byte " << j;
+            }
+        }
+    }
+
+private:
+    status_t mInitStatus;
+    std::shared_ptr<C2BlockPool> mPool;
+};
+
+const C2MemoryUsage AccessUnitAggregatorTest::kUsage{
+        C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE};
+
+TEST_F(AccessUnitAggregatorTest, Init) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    EXPECT_FALSE(aggregator);
+    aggregator.init(pool(), kUsage, 1u /* max access units */, 4096u /* max bytes */);
+    EXPECT_FALSE(aggregator) << "a single access unit per batch needs no aggregation";
+    aggregator.init(pool(), kUsage, 16u /* max access units */, 4096u /* max bytes */);
+    EXPECT_TRUE(aggregator);
+    aggregator.reset();
+    EXPECT_FALSE(aggregator);
+}
+
+// Batches are sent once they hold the maximum number of access units.
+TEST_F(AccessUnitAggregatorTest, BatchByCount) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    aggregator.init(pool(), kUsage, 4u /* max access units */, 4096u /* max bytes */);
+    ASSERT_TRUE(aggregator);
+
+    std::list<std::unique_ptr<C2Work>> items;
+    for (size_t i = 0; i < 10; ++i) {
+        ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(i, 100), 0u, &items));
+        EXPECT_EQ((i + 1) / 4, items.size()) << "after access unit #" << i;
+    }
+    EXPECT_TRUE(aggregator.hasPending());
+    aggregator.drain(&items);
+    EXPECT_FALSE(aggregator.hasPending());
+
+    ASSERT_EQ(3u, items.size());
+    auto it = items.begin();
+    VerifyBatch(*it++, 0, 4, 100);
+    VerifyBatch(*it++, 4, 4, 100);
+    VerifyBatch(*it++, 8, 2, 100);
+}
+
+// Batches are sent before an access unit would overflow the block.
+TEST_F(AccessUnitAggregatorTest, BatchBySize) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    aggregator.init(pool(), kUsage, 16u /* max access units */, 1000u /* max bytes */);
+
+    std::list<std::unique_ptr<C2Work>> items;
+    for (size_t i = 0; i < 7; ++i) {
+        ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(i, 300), 0u, &items));
+    }
+    aggregator.drain(&items);
+
+    ASSERT_EQ(3u, items.size());
+    auto it = items.begin();
+    VerifyBatch(*it++, 0, 3, 300);
+    VerifyBatch(*it++, 3, 3, 300);
+    VerifyBatch(*it++, 6, 1, 300);
+}
+
+// An access unit larger than the block capacity goes in a batch of its own.
+TEST_F(AccessUnitAggregatorTest, LargeAccessUnit) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    aggregator.init(pool(), kUsage, 16u /* max access units */, 1000u /* max bytes */);
+
+    std::list<std::unique_ptr<C2Work>> items;
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(0, 100), 0u, &items));
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(1, 2500), 0u, &items));
+    ASSERT_EQ(1u, items.size());
+    VerifyBatch(items.front(), 0, 1, 100);
+    items.clear();
+
+    aggregator.drain(&items);
+    ASSERT_EQ(1u, items.size());
+    VerifyBatch(items.front(), 1, 1, 2500);
+}
+
+// Per access unit flags are kept, and empty buffers are ignored.
+TEST_F(AccessUnitAggregatorTest, FlagsAndEmptyBuffers) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    aggregator.init(pool(), kUsage, 16u /* max access units */, 4096u /* max bytes */);
+
+    std::list<std::unique_ptr<C2Work>> items;
+    ASSERT_EQ(C2_OK, aggregator.process(
+            CreateAccessUnit(0, 10), C2FrameData::FLAG_DROP_FRAME, &items));
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(1, 0), 0u, &items));
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(2, 10), 0u, &items));
+    aggregator.drain(&items);
+
+    ASSERT_EQ(1u, items.size());
+    std::shared_ptr<const C2AccessUnitInfos::input> infos =
+        std::static_pointer_cast<const C2AccessUnitInfos::input>(
+                items.front()->input.buffers.front()->getInfo(
+                        C2AccessUnitInfos::input::PARAM_TYPE));
+    ASSERT_NE(nullptr, infos);
+    ASSERT_EQ(2u, infos->flexCount());
+    EXPECT_EQ(C2FrameData::FLAG_DROP_FRAME, infos->m.values[0].flags);
+    EXPECT_EQ(0u, infos->m.values[1].flags);
+    EXPECT_EQ(2 * kFrameDurationUs, infos->m.values[1].timestamp);
+}
+
+TEST_F(AccessUnitAggregatorTest, Flush) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    aggregator.init(pool(), kUsage, 16u /* max access units */, 4096u /* max bytes */);
+
+    std::list<std::unique_ptr<C2Work>> items;
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(i, 100), 0u, &items));
+    }
+    aggregator.flush();
+    EXPECT_FALSE(aggregator.hasPending());
+    aggregator.drain(&items);
+    EXPECT_TRUE(items.empty());
+
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(5, 100), 0u, &items));
+    aggregator.drain(&items);
+    ASSERT_EQ(1u, items.size());
+    VerifyBatch(items.front(), 5, 1, 100);
+}
+
+TEST_F(AccessUnitAggregatorTest, MissingTimestamp) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    aggregator.init(pool(), kUsage, 16u /* max access units */, 4096u /* max bytes */);
+
+    sp<MediaCodecBuffer> buffer = CreateAccessUnit(0, 100);
+    buffer->meta()->clear();
+    std::list<std::unique_ptr<C2Work>> items;
+    EXPECT_EQ(C2_BAD_VALUE, aggregator.process(buffer, 0u, &items));
+    EXPECT_FALSE(aggregator.hasPending());
+}
+
+// The pending time is that of the first access unit of the pending batch.
+TEST_F(AccessUnitAggregatorTest, PendingSince) {
+    ASSERT_EQ(OK, initStatus());
+    AccessUnitAggregator aggregator;
+    aggregator.init(pool(), kUsage, 2u /* max access units */, 4096u /* max bytes */);
+
+    std::list<std::unique_ptr<C2Work>> items;
+    nsecs_t before = systemTime(SYSTEM_TIME_MONOTONIC);
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(0, 100), 0u, &items));
+    nsecs_t first = aggregator.pendingSince();
+    EXPECT_LE(before, first);
+    EXPECT_GE(systemTime(SYSTEM_TIME_MONOTONIC), first);
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(1, 100), 0u, &items));
+    EXPECT_FALSE(aggregator.hasPending());
+
+    before = systemTime(SYSTEM_TIME_MONOTONIC);
+    ASSERT_EQ(C2_OK, aggregator.process(CreateAccessUnit(2, 100), 0u, &items));
+    EXPECT_LE(before, aggregator.pendingSince());
+    EXPECT_LE(first, aggregator.pendingSince());
+}
+
+} // namespace android
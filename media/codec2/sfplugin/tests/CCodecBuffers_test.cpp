@@ -914,4 +914,58 @@ TEST(LinearOutputBuffersTest, PcmConvertFormat) {
     ASSERT_TRUE(buffers->releaseBuffer(clientBuffer, &c2Buffer));
 }
 
+TEST(LinearInputBuffersTest, RecycleBlocks) {
+    constexpr size_t kCapacity = 4096;
+    std::shared_ptr<LinearInputBuffers> buffers =
+        std::make_shared<LinearInputBuffers>("test");
+    std::shared_ptr<C2BlockPool> pool;
+    ASSERT_EQ(OK, GetCodec2BlockPool(C2BlockPool::BASIC_LINEAR, nullptr, &pool));
+    buffers->setPool(pool);
+    sp<AMessage> format{new AMessage};
+    format->setInt32(KEY_MAX_INPUT_SIZE, kCapacity);
+    buffers->setFormat(format);
+
+    size_t index;
+    sp<MediaCodecBuffer> clientBuffer;
+    ASSERT_TRUE(buffers->requestNewBuffer(&index, &clientBuffer));
+    ASSERT_GE(clientBuffer->capacity(), kCapacity);
+    EXPECT_EQ(1u, buffers->blockStats().fetched);
+    clientBuffer->setRange(0, 16);
+    clientBuffer->meta()->setInt64("timeUs", 1234);
+    MediaCodecBuffer *firstBuffer = clientBuffer.get();
+
+    // Queue the buffer to the component.
+    std::shared_ptr<C2Buffer> c2Buffer;
+    ASSERT_TRUE(buffers->releaseBuffer(clientBuffer, &c2Buffer, false));
+    ASSERT_TRUE(buffers->releaseBuffer(clientBuffer, nullptr, true));
+    ASSERT_NE(nullptr, c2Buffer);
+    clientBuffer.clear();
+
+    // The component still holds the first buffer, so a new block is fetched.
+    ASSERT_TRUE(buffers->requestNewBuffer(&index, &clientBuffer));
+    EXPECT_NE(firstBuffer, clientBuffer.get());
+    EXPECT_EQ(2u, buffers->blockStats().fetched);
+    EXPECT_EQ(0u, buffers->blockStats().recycled);
+    ASSERT_TRUE(buffers->releaseBuffer(clientBuffer, nullptr, true));
+    clientBuffer.clear();
+
+    // Once the component is done, the first buffer comes back reset.
+    ASSERT_TRUE(buffers->expireComponentBuffer(c2Buffer));
+    c2Buffer.reset();
+    ASSERT_TRUE(buffers->requestNewBuffer(&index, &clientBuffer));
+    EXPECT_EQ(firstBuffer, clientBuffer.get());
+    EXPECT_EQ(0u, clientBuffer->offset());
+    EXPECT_EQ(clientBuffer->capacity(), clientBuffer->size());
+    int64_t timeUs;
+    EXPECT_FALSE(clientBuffer->meta()->findInt64("timeUs", &timeUs));
+    EXPECT_EQ(2u, buffers->blockStats().fetched);
+    EXPECT_EQ(1u, buffers->blockStats().recycled);
+
+    // The counters carry over to the array mode.
+    std::unique_ptr<InputBuffers> array = buffers->toArrayMode(4);
+    ASSERT_NE(nullptr, array);
+    EXPECT_EQ(2u, array->blockStats().fetched);
+    EXPECT_EQ(1u, array->blockStats().recycled);
+}
+
 } // namespace android
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <iterator>
+
+#include <benchmark/benchmark.h>
+
+#include <binder/ProcessState.h>
+#include <media/stagefright/MediaCodec.h>
+#include <media/stagefright/MediaCodecConstants.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+
+using namespace android;
+
+/*
+$ atest ccodec_create_benchmark
+
+Reports the time to create, configure and release a codec by component name,
+as done for each item of a thumbnail scan or on each channel switch. The first
+iteration also pays for the process-wide parameter reflection caches.
+*/
+
+namespace {
+
+struct Codec {
+    const char *name;
+    const char *mediaType;
+    bool audio;
+};
+
+const Codec kCodecs[] = {
+    { "c2.android.avc.decoder",  MIMETYPE_VIDEO_AVC,  false },
+    { "c2.android.hevc.decoder", MIMETYPE_VIDEO_HEVC, false },
+    { "c2.android.avc.encoder",  MIMETYPE_VIDEO_AVC,  false },
+    { "c2.android.aac.decoder",  MIMETYPE_AUDIO_AAC,  true },
+};
+
+sp<AMessage> CreateFormat(const Codec &codec) {
+    sp<AMessage> format = new AMessage;
+    format->setString(KEY_MIME, codec.mediaType);
+    if (codec.audio) {
+        format->setInt32(KEY_SAMPLE_RATE, 48000);
+        format->setInt32(KEY_CHANNEL_COUNT, 2);
+    } else {
+        format->setInt32(KEY_WIDTH, 1920);
+        format->setInt32(KEY_HEIGHT, 1080);
+        format->setInt32(KEY_BIT_RATE, 8000000);
+        format->setInt32(KEY_FRAME_RATE, 30);
+        format->setInt32(KEY_I_FRAME_INTERVAL, 1);
+        format->setInt32(KEY_COLOR_FORMAT, COLOR_FormatYUV420Flexible);
+    }
+    return format;
+}
+
+}  // namespace
+
+static void BM_CreateConfigureRelease(benchmark::State &state) {
+    const Codec &codec = kCodecs[state.range(0)];
+    state.SetLabel(codec.name);
+    const bool encoder = strstr(codec.name, "encoder") != nullptr;
+
+    ProcessState::self()->startThreadPool();
+    sp<ALooper> looper = new ALooper;
+    looper->start();
+    sp<AMessage> format = CreateFormat(codec);
+
+    for (auto _ : state) {
+        status_t err = OK;
+        sp<MediaCodec> mediaCodec = MediaCodec::CreateByComponentName(looper, codec.name, &err);
+        if (mediaCodec == nullptr || err != OK) {
+            state.SkipWithError("codec creation failed");
+            break;
+        }
+        err = mediaCodec->configure(
+                format, nullptr /* surface */, nullptr /* crypto */,
+                encoder ? MediaCodec::CONFIGURE_FLAG_ENCODE : 0);
+        mediaCodec->release();
+        if (err != OK) {
+            state.SkipWithError("codec configuration failed");
+            break;
+        }
+    }
+
+    looper->stop();
+}
+
+BENCHMARK(BM_CreateConfigureRelease)
+        ->DenseRange(0, std::size(kCodecs) - 1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameLatencyTracer.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace android {
+
+constexpr nsecs_t kMs = 1000000;
+
+TEST(FrameLatencyTracerTest, Latency) {
+    FrameLatencyTracer tracer;
+    for (uint64_t i = 0; i < 100; ++i) {
+        nsecs_t queuedAt = (i + 1) * 100 * kMs;
+        tracer.onQueued(i, queuedAt);
+        tracer.record(i, FrameLatencyTracer::SUBMITTED, queuedAt + (i + 1) * kMs);
+        if (i % 2 == 0) {
+            tracer.record(i, FrameLatencyTracer::WORK_DONE, queuedAt + 50 * kMs);
+        }
+    }
+
+    FrameLatencyTracer::Percentiles queueing =
+        tracer.latency(FrameLatencyTracer::QUEUED, FrameLatencyTracer::SUBMITTED);
+    EXPECT_EQ(100u, queueing.count);
+    EXPECT_EQ(50 * kMs, queueing.p50);
+    EXPECT_EQ(90 * kMs, queueing.p90);
+    EXPECT_EQ(99 * kMs, queueing.p99);
+
+    FrameLatencyTracer::Percentiles total =
+        tracer.latency(FrameLatencyTracer::QUEUED, FrameLatencyTracer::WORK_DONE);
+    EXPECT_EQ(50u, total.count);
+    EXPECT_EQ(50 * kMs, total.p50);
+
+    FrameLatencyTracer::Percentiles output =
+        tracer.latency(FrameLatencyTracer::WORK_DONE, FrameLatencyTracer::RELEASED);
+    EXPECT_EQ(0u, output.count);
+
+    tracer.clear();
+    EXPECT_EQ(0u, tracer.latency(
+            FrameLatencyTracer::QUEUED, FrameLatencyTracer::SUBMITTED).count);
+}
+
+// Only the latest frames are kept, and events of frames no longer tracked
+// are ignored.
+TEST(FrameLatencyTracerTest, Wraparound) {
+    FrameLatencyTracer tracer(4u /* capacity */);
+    for (uint64_t i = 0; i < 10; ++i) {
+        tracer.onQueued(i, (i + 1) * kMs);
+    }
+    tracer.record(2, FrameLatencyTracer::SUBMITTED, 100 * kMs);
+    tracer.record(6, FrameLatencyTracer::SUBMITTED, 8 * kMs);
+    tracer.record(9, FrameLatencyTracer::SUBMITTED, 12 * kMs);
+
+    FrameLatencyTracer::Percentiles queueing =
+        tracer.latency(FrameLatencyTracer::QUEUED, FrameLatencyTracer::SUBMITTED);
+    EXPECT_EQ(2u, queueing.count);
+    EXPECT_EQ(1 * kMs, queueing.p50);
+    EXPECT_EQ(1 * kMs, queueing.p90);
+}
+
+TEST(FrameLatencyTracerTest, Json) {
+    FrameLatencyTracer tracer;
+    tracer.onQueued(7, 1000 * kMs);
+    tracer.record(7, FrameLatencyTracer::SUBMITTED, 1001 * kMs);
+    // INPUT_RELEASED is missing
+    tracer.record(7, FrameLatencyTracer::WORK_DONE, 1010 * kMs + 500);
+    tracer.record(7, FrameLatencyTracer::RELEASED, 1020 * kMs);
+    // not submitted yet: no event
+    tracer.onQueued(8, 1005 * kMs);
+
+    std::string json = tracer.toJson("c2.android.avc.decoder");
+    EXPECT_EQ('[', json.front()) << json;
+    EXPECT_EQ("]\n", json.substr(json.size() - 2)) << json;
+    EXPECT_NE(std::string::npos, json.find(
+            "{\"name\":\"frame #7\",\"cat\":\"c2.android.avc.decoder\",\"ph\":\"b\",\"id\":7,"
+            "\"ts\":1000000.000,")) << json;
+    EXPECT_NE(std::string::npos, json.find(
+            "{\"name\":\"consuming\",\"cat\":\"c2.android.avc.decoder\",\"ph\":\"e\",\"id\":7,"
+            "\"ts\":1010000.500,")) << json;
+    EXPECT_NE(std::string::npos, json.find(
+            "{\"name\":\"frame #7\",\"cat\":\"c2.android.avc.decoder\",\"ph\":\"e\",\"id\":7,"
+            "\"ts\":1020000.000,")) << json;
+    EXPECT_EQ(std::string::npos, json.find("processing")) << json;
+    EXPECT_EQ(std::string::npos, json.find("frame #8")) << json;
+    // frame, queueing, consuming and output spans, begin and end each
+    EXPECT_EQ(8, std::count(json.begin(), json.end(), '{')) << json;
+
+    // CCodec logs the events line by line.
+    std::istringstream lines(json);
+    size_t numEvents = 0;
+    for (std::string line; std::getline(lines, line); ) {
+        if (line == "[" || line == "]") {
+            continue;
+        }
+        EXPECT_EQ('{', line.front()) << line;
+        EXPECT_EQ(1, std::count(line.begin(), line.end(), '{')) << line;
+        ++numEvents;
+    }
+    EXPECT_EQ(8u, numEvents);
+}
+
+// Writers on different threads may run concurrently with readers.
+TEST(FrameLatencyTracerTest, Concurrency) {
+    FrameLatencyTracer tracer(64u /* capacity */);
+    std::thread writer([&tracer] {
+        for (uint64_t i = 0; i < 100000; ++i) {
+            tracer.onQueued(i, 1 * kMs);
+            tracer.record(i, FrameLatencyTracer::SUBMITTED, 2 * kMs);
+        }
+    });
+    for (int i = 0; i < 100; ++i) {
+        FrameLatencyTracer::Percentiles queueing =
+            tracer.latency(FrameLatencyTracer::QUEUED, FrameLatencyTracer::SUBMITTED);
+        EXPECT_TRUE(queueing.count == 0 || queueing.p90 == kMs);
+        (void)tracer.toJson("test");
+    }
+    writer.join();
+    EXPECT_EQ(64u, tracer.latency(
+            FrameLatencyTracer::QUEUED, FrameLatencyTracer::SUBMITTED).count);
+}
+
+} // namespace android
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PipelineWatcher.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace android {
+
+class PipelineWatcherTest : public ::testing::Test {
+public:
+    using Clock = PipelineWatcher::Clock;
+    static constexpr uint32_t kSmoothnessFactor = 4;
+
+    PipelineWatcherTest() {
+        mWatcher.inputDelay(0).pipelineDelay(0).outputDelay(0)
+                .smoothnessFactor(kSmoothnessFactor);
+    }
+
+    PipelineWatcher &watcher() { return mWatcher; }
+
+    // Feed the watcher for |durationMs| milliseconds with a client that always
+    // has input ready, and a component that processes up to |parallelism|
+    // work items at a time, each taking |serviceMs| milliseconds.
+    void run(size_t parallelism, int serviceMs, int durationMs) {
+        std::vector<Clock::time_point> freeAt(parallelism, mNow);
+        for (int i = 0; i < durationMs; ++i) {
+            mNow += std::chrono::milliseconds(1);
+            while (!mInFlight.empty() && mInFlight.front().second <= mNow) {
+                mWatcher.onWorkDone(mInFlight.front().first, mNow);
+                mInFlight.pop_front();
+            }
+            while (!mWatcher.pipelineFull()) {
+                auto server = std::min_element(freeAt.begin(), freeAt.end());
+                *server = std::max(*server, mNow) + std::chrono::milliseconds(serviceMs);
+                mInFlight.emplace_back(mFrameIndex, *server);
+                mWatcher.onWorkQueued(mFrameIndex++, {}, mNow);
+            }
+        }
+    }
+
+private:
+    PipelineWatcher mWatcher;
+    // Clock::time_point() is never used as an actual time.
+    Clock::time_point mNow{std::chrono::seconds(1)};
+    uint64_t mFrameIndex = 0;
+    // frame index and completion time of work items in the component
+    std::deque<std::pair<uint64_t, Clock::time_point>> mInFlight;
+};
+
+TEST_F(PipelineWatcherTest, FixedByDefault) {
+    run(1u /* parallelism */, 10 /* serviceMs */, 5000 /* durationMs */);
+    EXPECT_EQ(kSmoothnessFactor, watcher().currentSmoothnessFactor());
+    EXPECT_EQ(0u, watcher().numAdjustments());
+    EXPECT_TRUE(watcher().adjustmentTrace().empty());
+}
+
+// A component working on one item at a time keeps its throughput with a
+// single work item in flight, so the slack is removed.
+TEST_F(PipelineWatcherTest, ShrinkForSerialComponent) {
+    watcher().adaptive(true);
+    run(1u /* parallelism */, 10 /* serviceMs */, 5000 /* durationMs */);
+    EXPECT_EQ(1u, watcher().currentSmoothnessFactor());
+    EXPECT_EQ(kSmoothnessFactor - 1, watcher().numAdjustments());
+    std::string trace = watcher().adjustmentTrace();
+    EXPECT_NE(std::string::npos, trace.find("4->3")) << trace;
+    EXPECT_NE(std::string::npos, trace.find("2->1")) << trace;
+
+    // Flush keeps the tuned value; setting the smoothness factor resets it.
+    watcher().flush();
+    EXPECT_EQ(1u, watcher().currentSmoothnessFactor());
+    watcher().smoothnessFactor(kSmoothnessFactor);
+    EXPECT_EQ(kSmoothnessFactor, watcher().currentSmoothnessFactor());
+    EXPECT_EQ(0u, watcher().numAdjustments());
+}
+
+// A component working on four items in parallel loses throughput with fewer
+// items in flight, so the slack is restored and kept.
+TEST_F(PipelineWatcherTest, RevertForParallelComponent) {
+    watcher().adaptive(true);
+    run(4u /* parallelism */, 30 /* serviceMs */, 5000 /* durationMs */);
+    EXPECT_EQ(kSmoothnessFactor, watcher().currentSmoothnessFactor());
+    EXPECT_EQ(2u, watcher().numAdjustments());
+    std::string trace = watcher().adjustmentTrace();
+    EXPECT_NE(std::string::npos, trace.find("4->3")) << trace;
+    EXPECT_NE(std::string::npos, trace.find("3->4")) << trace;
+}
+
+// A component with delays holds that many work items before it produces
+// output for them.
+TEST_F(PipelineWatcherTest, WaitingForInput) {
+    Clock::time_point now{std::chrono::seconds(1)};
+    EXPECT_TRUE(watcher().waitingForInput());
+    watcher().onWorkQueued(0, {}, now);
+    EXPECT_FALSE(watcher().waitingForInput());
+
+    watcher().inputDelay(1).outputDelay(2);
+    watcher().onWorkQueued(1, {}, now);
+    watcher().onWorkQueued(2, {}, now);
+    EXPECT_TRUE(watcher().waitingForInput());
+    watcher().onWorkQueued(3, {}, now);
+    EXPECT_FALSE(watcher().waitingForInput());
+    watcher().onWorkDone(0, now);
+    EXPECT_TRUE(watcher().waitingForInput());
+}
+
+} // namespace android
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WarmPool.h"
+
+#include <gtest/gtest.h>
+
+namespace android {
+
+using namespace std::chrono_literals;
+
+using Pool = WarmPool<int>;
+
+TEST(WarmPoolTest, Disabled) {
+    Pool pool(0u /* capacity */, 10s /* max idle time */);
+    std::list<int> evicted;
+    pool.put("a", 1, &evicted);
+    EXPECT_EQ(std::list<int>({1}), evicted);
+    EXPECT_EQ(0u, pool.size());
+    int item = 0;
+    EXPECT_FALSE(pool.take("a", &item));
+}
+
+// Items are taken by name, most recently added first.
+TEST(WarmPoolTest, TakeByName) {
+    Pool pool(2u /* capacity */, 10s /* max idle time */);
+    std::list<int> evicted;
+    pool.put("a", 1, &evicted);
+    pool.put("b", 2, &evicted);
+    pool.put("a", 3, &evicted);
+    EXPECT_TRUE(evicted.empty());
+    EXPECT_EQ(3u, pool.size());
+
+    int item = 0;
+    EXPECT_FALSE(pool.take("c", &item));
+    ASSERT_TRUE(pool.take("a", &item));
+    EXPECT_EQ(3, item);
+    ASSERT_TRUE(pool.take("a", &item));
+    EXPECT_EQ(1, item);
+    EXPECT_FALSE(pool.take("a", &item));
+    ASSERT_TRUE(pool.take("b", &item));
+    EXPECT_EQ(2, item);
+    EXPECT_EQ(0u, pool.size());
+}
+
+// The least recently added items of a name are evicted when it is full.
+TEST(WarmPoolTest, Capacity) {
+    Pool pool(2u /* capacity */, 10s /* max idle time */);
+    std::list<int> evicted;
+    for (int i = 1; i <= 4; ++i) {
+        pool.put("a", i, &evicted);
+    }
+    pool.put("b", 5, &evicted);
+    EXPECT_EQ(std::list<int>({1, 2}), evicted);
+    EXPECT_EQ(3u, pool.size());
+}
+
+TEST(WarmPoolTest, Expiry) {
+    Pool pool(4u /* capacity */, 10s /* max idle time */);
+    Pool::Clock::time_point now = Pool::Clock::now();
+    std::list<int> evicted;
+    pool.put("a", 1, &evicted, now);
+    pool.put("b", 2, &evicted, now + 2s);
+    pool.put("a", 3, &evicted, now + 4s);
+
+    EXPECT_EQ(now + 10s, pool.trim(&evicted, now + 5s));
+    EXPECT_TRUE(evicted.empty());
+
+    EXPECT_EQ(now + 12s, pool.trim(&evicted, now + 10s));
+    EXPECT_EQ(std::list<int>({1}), evicted);
+    evicted.clear();
+
+    // Expired items are not taken even before they are trimmed.
+    int item = 0;
+    EXPECT_FALSE(pool.take("b", &item, now + 12s));
+    ASSERT_TRUE(pool.take("a", &item, now + 12s));
+    EXPECT_EQ(3, item);
+
+    EXPECT_EQ(Pool::Clock::time_point::max(), pool.trim(&evicted, now + 12s));
+    EXPECT_EQ(std::list<int>({2}), evicted);
+    EXPECT_EQ(0u, pool.size());
+}
+
+// An idle item can be taken out by identity, as when the resource manager
+// reclaims it, without disturbing the other items.
+TEST(WarmPoolTest, TakeIf) {
+    Pool pool(2u /* capacity */, 10s /* max idle time */);
+    Pool::Clock::time_point now = Pool::Clock::now();
+    std::list<int> evicted;
+    pool.put("a", 1, &evicted, now);
+    pool.put("a", 2, &evicted, now + 1s);
+    pool.put("b", 3, &evicted, now + 2s);
+
+    int item = 0;
+    ASSERT_TRUE(pool.takeIf([](int i) { return i == 1; }, &item));
+    EXPECT_EQ(1, item);
+    EXPECT_EQ(2u, pool.size());
+    // Already taken.
+    EXPECT_FALSE(pool.takeIf([](int i) { return i == 1; }, &item));
+
+    // Expiry of the remaining items is unchanged.
+    EXPECT_EQ(now + 11s, pool.trim(&evicted, now + 5s));
+    EXPECT_TRUE(evicted.empty());
+    ASSERT_TRUE(pool.take("a", &item, now + 5s));
+    EXPECT_EQ(2, item);
+
+    ASSERT_TRUE(pool.takeIf([](int i) { return i == 3; }, &item));
+    EXPECT_EQ(3, item);
+    EXPECT_EQ(0u, pool.size());
+}
+
+TEST(WarmPoolTest, Clear) {
+    Pool pool(2u /* capacity */, 10s /* max idle time */);
+    std::list<int> evicted;
+    pool.put("a", 1, &evicted);
+    pool.put("b", 2, &evicted);
+    pool.clear(&evicted);
+    evicted.sort();
+    EXPECT_EQ(std::list<int>({1, 2}), evicted);
+    EXPECT_EQ(0u, pool.size());
+}
+
+}  // namespace android
@@ -64,7 +64,8 @@ public:
     }
 
     /**
-     * Adds support for describing a specific struct.
+     * Adds support for describing a specific struct. Structs that are already
+     * described are kept as they are.
      *
      * \param strukt descriptor for the struct that will be moved out.
      */
@@ -82,6 +83,8 @@ private:
     void addStructDescriptors(
             std::vector<C2StructDescriptor> &structs, _Tuple<> *);
 
+    void addStructDescriptor_l(C2StructDescriptor &&strukt);
+
     /**
      * Utility method that adds support for describing the given descriptors in a recursive manner
      * one structure at a time using a list of structure descriptors temporary.
@@ -641,6 +644,12 @@ public:
     }
 
 public:
+    /**
+     * Helper implementing query calls.
+     *
+     * Stack parameters are updated in place without allocations. Each heap
+     * parameter is returned as a new copy.
+     */
     c2_status_t query(
             const std::vector<C2Param*> &stackParams,
             const std::vector<C2Param::Index> &heapParamIndices,
@@ -29,7 +29,7 @@ void C2ReflectorHelper::addStructDescriptors(
     std::lock_guard<std::mutex> lock(_mMutex);
     for (C2StructDescriptor &strukt : structs) {
         // TODO: check if structure descriptions conflict with existing ones
-        addStructDescriptor(std::move(strukt));
+        addStructDescriptor_l(std::move(strukt));
     }
 }
 
@@ -45,9 +45,15 @@ C2ReflectorHelper::describe(C2Param::CoreIndex paramIndex) const {
 };
 
 void C2ReflectorHelper::addStructDescriptor(C2StructDescriptor &&strukt) {
+    std::lock_guard<std::mutex> lock(_mMutex);
+    addStructDescriptor_l(std::move(strukt));
+}
+
+void C2ReflectorHelper::addStructDescriptor_l(C2StructDescriptor &&strukt) {
     if (_mStructs.find(strukt.coreIndex()) != _mStructs.end()) {
-        // already added
+        // already added, e.g. by another instance of the same component
         // TODO: validate that descriptor matches stored descriptor
+        return;
     }
     // validate that all struct fields are known to this reflector
     for (const C2FieldDescriptor &fd : strukt) {
@@ -788,6 +794,9 @@ c2_status_t C2InterfaceHelper::query(
         }
     }
 
+    if (!heapParamIndices.empty()) {
+        heapParams->reserve(heapParams->size() + heapParamIndices.size());
+    }
     for (const C2Param::Index ix : heapParamIndices) {
         std::shared_ptr<C2Param> value = _mFactory->getParamValue(ix);
         if (value) {
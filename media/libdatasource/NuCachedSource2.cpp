@@ -24,6 +24,7 @@
 #include <datasource/HTTPBase.h>
 
 #include <cutils/properties.h>
+#include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/MediaErrors.h>
@@ -37,6 +38,7 @@ struct PageCache {
     struct Page {
         void *mData;
         size_t mSize;
+        size_t mCapacity;
     };
 
     Page *acquirePage();
@@ -49,6 +51,10 @@ struct PageCache {
         return mTotalSize;
     }
 
+    // Pages handed out by subsequent calls to acquirePage() will have
+    // the new size, pages that are currently in use are not affected.
+    void setPageSize(size_t pageSize);
+
     void copy(size_t from, void *data, size_t size);
 
 private:
@@ -98,15 +104,33 @@ PageCache::Page *PageCache::acquirePage() {
     Page *page = new Page;
     page->mData = malloc(mPageSize);
     page->mSize = 0;
+    page->mCapacity = mPageSize;
 
     return page;
 }
 
 void PageCache::releasePage(Page *page) {
+    if (page->mCapacity != mPageSize) {
+        free(page->mData);
+        delete page;
+        return;
+    }
+
     page->mSize = 0;
     mFreePages.push_back(page);
 }
 
+void PageCache::setPageSize(size_t pageSize) {
+    if (pageSize == mPageSize) {
+        return;
+    }
+
+    mPageSize = pageSize;
+
+    freePages(&mFreePages);
+    mFreePages.clear();
+}
+
 void PageCache::appendPage(Page *page) {
     mTotalSize += page->mSize;
     mActivePages.push_back(page);
@@ -187,6 +211,7 @@ NuCachedSource2::NuCachedSource2(
       mReflector(new AHandlerReflector<NuCachedSource2>(this)),
       mLooper(new ALooper),
       mCache(new PageCache(kPageSize)),
+      mPageSize(kPageSize),
       mCacheOffset(0),
       mFinalStatus(OK),
       mLastAccessPos(0),
@@ -197,7 +222,11 @@ NuCachedSource2::NuCachedSource2(
       mHighwaterThresholdBytes(kDefaultHighWaterThreshold),
       mLowwaterThresholdBytes(kDefaultLowWaterThreshold),
       mKeepAliveIntervalUs(kDefaultKeepAliveIntervalUs),
-      mDisconnectAtHighwatermark(disconnectAtHighwatermark) {
+      mDisconnectAtHighwatermark(disconnectAtHighwatermark),
+      mPinnedBytes(0),
+      mExcursionReturnPos(-1),
+      mExcursionStart(0),
+      mExcursionEnd(0) {
     // We are NOT going to support disconnect-at-highwatermark indefinitely
     // and we are not guaranteeing support for client-specified cache
     // parameters. Both of these are temporary measures to solve a specific
@@ -363,8 +392,12 @@ void NuCachedSource2::fetchInternal() {
 
     PageCache::Page *page = mCache->acquirePage();
 
+    int64_t startUs = ALooper::GetNowUs();
+
     ssize_t n = mSource->readAt(
-            mCacheOffset + mCache->totalSize(), page->mData, kPageSize);
+            mCacheOffset + mCache->totalSize(), page->mData, page->mCapacity);
+
+    int64_t durationUs = ALooper::GetNowUs() - startUs;
 
     Mutex::Autolock autoLock(mLock);
 
@@ -394,6 +427,40 @@ void NuCachedSource2::fetchInternal() {
 
         page->mSize = n;
         mCache->appendPage(page);
+
+        updatePageSize_l(n, durationUs);
+    }
+}
+
+void NuCachedSource2::updatePageSize_l(size_t bytesRead, int64_t durationUs) {
+    // Never let a single page take up a significant part of the cache.
+    size_t maxPageSize = mHighwaterThresholdBytes / 4;
+    if (maxPageSize > kMaxPageSize) {
+        maxPageSize = kMaxPageSize;
+    }
+    if (maxPageSize < kPageSize) {
+        maxPageSize = kPageSize;
+    }
+
+    size_t pageSize = mPageSize;
+    if (bytesRead == mPageSize && durationUs < kTargetFetchDurationUs / 2) {
+        pageSize = mPageSize * 2;
+    } else if (durationUs > kTargetFetchDurationUs * 2) {
+        pageSize = mPageSize / 2;
+    }
+
+    if (pageSize > maxPageSize) {
+        pageSize = maxPageSize;
+    } else if (pageSize < kPageSize) {
+        pageSize = kPageSize;
+    }
+
+    if (pageSize != mPageSize) {
+        ALOGV("page size %zu -> %zu (read %zu bytes in %lld us)",
+              mPageSize, pageSize, bytesRead, (long long)durationUs);
+
+        mPageSize = pageSize;
+        mCache->setPageSize(pageSize);
     }
 }
 
@@ -533,10 +600,20 @@ ssize_t NuCachedSource2::readAt(off64_t offset, void *data, size_t size) {
         mCache->copy(delta, data, size);
 
         mLastAccessPos = offset + size;
+        noteAccess_l(offset, size);
+
+        return size;
+    }
 
+    // Reads served from a pinned range do not move the read position,
+    // the prefetcher keeps going where the stream data is.
+    if (readFromPinnedRange_l(offset, data, size)) {
         return size;
     }
 
+    // This runs once per read, retries of a deferred read happen in onRead().
+    noteSeek_l(offset);
+
     sp<AMessage> msg = new AMessage(kWhatRead, mReflector);
     msg->setInt64("offset", offset);
     msg->setPointer("data", data);
@@ -647,12 +724,14 @@ ssize_t NuCachedSource2::readInternal(off64_t offset, void *data, size_t size) {
         }
 
         mCache->copy(delta, data, avail);
+        noteAccess_l(offset, avail);
 
         return avail;
     }
 
     if (offset + size <= mCacheOffset + mCache->totalSize()) {
         mCache->copy(delta, data, size);
+        noteAccess_l(offset, size);
 
         return size;
     }
@@ -683,6 +762,112 @@ status_t NuCachedSource2::seekInternal_l(off64_t offset) {
     return OK;
 }
 
+void NuCachedSource2::noteSeek_l(off64_t offset) {
+    if (offset >= mLastAccessPos
+            && offset <= mLastAccessPos + kExcursionReturnSlop) {
+        // Reading on, or skipping a little ahead, e.g. while the prefetcher
+        // is catching up at the end of the cache. This is not a jump.
+        return;
+    }
+
+    if (mExcursionReturnPos < 0) {
+        mExcursionReturnPos = mLastAccessPos;
+        mExcursionStart = mExcursionEnd = offset;
+        return;
+    }
+
+    if (offset + kExcursionReturnSlop >= mExcursionReturnPos
+            && offset <= mExcursionReturnPos + kExcursionReturnSlop) {
+        // We're back where we came from, whatever was read in between
+        // is likely index data that will be consulted again.
+        pinExcursion_l();
+        mExcursionReturnPos = -1;
+    }
+
+    // Other jumps are part of the current excursion, which noteAccess_l()
+    // abandons once it spans too much data.
+}
+
+void NuCachedSource2::noteAccess_l(off64_t offset, size_t size) {
+    if (mExcursionReturnPos < 0 || size == 0) {
+        return;
+    }
+
+    if (mExcursionStart == mExcursionEnd) {
+        mExcursionStart = offset;
+        mExcursionEnd = offset + size;
+        return;
+    }
+
+    if (offset < mExcursionStart) {
+        mExcursionStart = offset;
+    }
+    if (offset + (off64_t)size > mExcursionEnd) {
+        mExcursionEnd = offset + size;
+    }
+
+    if (mExcursionEnd - mExcursionStart > kMaxPinnedBytes) {
+        // Too much data for an index, this is a regular seek.
+        mExcursionReturnPos = -1;
+    }
+}
+
+void NuCachedSource2::pinExcursion_l() {
+    size_t size = mExcursionEnd - mExcursionStart;
+
+    if (size == 0
+            || mExcursionStart < mCacheOffset
+            || mExcursionEnd > (off64_t)(mCacheOffset + mCache->totalSize())) {
+        return;
+    }
+
+    PinnedRange range;
+    range.mOffset = mExcursionStart;
+    range.mData = new ABuffer(size);
+    mCache->copy(mExcursionStart - mCacheOffset, range.mData->data(), size);
+
+    // Drop any ranges that are covered by the new one, and the oldest ones
+    // if we run out of space.
+    List<PinnedRange>::iterator it = mPinnedRanges.begin();
+    while (it != mPinnedRanges.end()) {
+        if (range.contains(it->mOffset, it->mData->size())) {
+            mPinnedBytes -= it->mData->size();
+            it = mPinnedRanges.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    while (mPinnedBytes + size > kMaxPinnedBytes && !mPinnedRanges.empty()) {
+        mPinnedBytes -= (*mPinnedRanges.begin()).mData->size();
+        mPinnedRanges.erase(mPinnedRanges.begin());
+    }
+
+    ALOGI("pinning range: offset= %lld, size= %zu",
+          (long long)mExcursionStart, size);
+
+    mPinnedRanges.push_back(range);
+    mPinnedBytes += size;
+}
+
+bool NuCachedSource2::PinnedRange::contains(off64_t offset, size_t size) const {
+    return offset >= mOffset
+            && offset + (off64_t)size <= mOffset + (off64_t)mData->size();
+}
+
+bool NuCachedSource2::readFromPinnedRange_l(
+        off64_t offset, void *data, size_t size) const {
+    for (List<PinnedRange>::const_iterator it = mPinnedRanges.begin();
+            it != mPinnedRanges.end(); ++it) {
+        if (it->contains(offset, size)) {
+            memcpy(data, it->mData->data() + (offset - it->mOffset), size);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void NuCachedSource2::resumeFetchingIfNecessary() {
     Mutex::Autolock autoLock(mLock);
 
@@ -21,9 +21,11 @@
 #include <media/DataSource.h>
 #include <media/stagefright/foundation/ABase.h>
 #include <media/stagefright/foundation/AHandlerReflector.h>
+#include <utils/List.h>
 
 namespace android {
 
+struct ABuffer;
 struct ALooper;
 struct PageCache;
 
@@ -85,12 +87,25 @@ private:
 
     enum {
         kPageSize                       = 65536,
+        kMaxPageSize                    = 1024 * 1024,
         kDefaultHighWaterThreshold      = 20 * 1024 * 1024,
         kDefaultLowWaterThreshold       = 4 * 1024 * 1024,
 
         // Read data after a 15 sec timeout whether we're actively
         // fetching or not.
         kDefaultKeepAliveIntervalUs     = 15000000,
+
+        // The page size is adapted so that a single fetch takes roughly
+        // this long, fast links get bigger reads (fewer round trips through
+        // the HTTP connection), slow links keep pending reads responsive.
+        kTargetFetchDurationUs          = 100000,
+
+        // Ranges visited during a short "excursion" away from the current
+        // read position (e.g. the moov atom at the end of the file, or
+        // matroska cues) are kept around so that revisiting them does not
+        // flush the cache.
+        kMaxPinnedBytes                 = 4 * 1024 * 1024,
+        kExcursionReturnSlop            = 1024 * 1024,
     };
 
     enum {
@@ -111,7 +126,15 @@ private:
     mutable Mutex mLock;
     Condition mCondition;
 
+    struct PinnedRange {
+        off64_t mOffset;
+        sp<ABuffer> mData;
+
+        bool contains(off64_t offset, size_t size) const;
+    };
+
     PageCache *mCache;
+    size_t mPageSize;
     off64_t mCacheOffset;
     status_t mFinalStatus;
     off64_t mLastAccessPos;
@@ -130,6 +153,15 @@ private:
 
     bool mDisconnectAtHighwatermark;
 
+    List<PinnedRange> mPinnedRanges;
+    size_t mPinnedBytes;
+
+    // Position we jumped away from, or -1 if we are not on an excursion,
+    // and the range read since then.
+    off64_t mExcursionReturnPos;
+    off64_t mExcursionStart;
+    off64_t mExcursionEnd;
+
     void onMessageReceived(const sp<AMessage> &msg);
     void onFetch();
     void onRead(const sp<AMessage> &msg);
@@ -138,6 +170,13 @@ private:
     ssize_t readInternal(off64_t offset, void *data, size_t size);
     status_t seekInternal_l(off64_t offset);
 
+    void updatePageSize_l(size_t bytesRead, int64_t durationUs);
+
+    void noteSeek_l(off64_t offset);
+    void noteAccess_l(off64_t offset, size_t size);
+    void pinExcursion_l();
+    bool readFromPinnedRange_l(off64_t offset, void *data, size_t size) const;
+
     size_t approxDataRemaining_l(off64_t offset, status_t *finalStatus) const;
 
     void restartPrefetcherIfNecessary_l(
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "NuCachedSource2Test"
+#include <utils/Log.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <datasource/NuCachedSource2.h>
+
+using namespace android;
+
+namespace {
+
+constexpr off64_t kMiB = 1024 * 1024;
+constexpr off64_t kFileSize = 64 * kMiB;
+// Low water mark 512 KiB, high water mark 2 MiB, no keep-alive.
+constexpr char kCacheConfig[] = "512/2048/0";
+
+// In-memory source that records where it was read from.
+struct MemorySource : public DataSource {
+    static uint8_t ByteAt(off64_t offset) {
+        return (offset ^ (offset >> 8) ^ (offset >> 16)) & 0xff;
+    }
+
+    status_t initCheck() const override {
+        return OK;
+    }
+
+    ssize_t readAt(off64_t offset, void *data, size_t size) override {
+        if (offset >= kFileSize) {
+            return 0;
+        }
+        size = std::min(size, (size_t)(kFileSize - offset));
+        for (size_t i = 0; i < size; ++i) {
+            ((uint8_t *)data)[i] = ByteAt(offset + i);
+        }
+        std::lock_guard<std::mutex> lock(mLock);
+        mReads.push_back(offset);
+        return size;
+    }
+
+    status_t getSize(off64_t *size) override {
+        *size = kFileSize;
+        return OK;
+    }
+
+    // Whether a read started in [begin, end) since the last clearReads().
+    bool readFrom(off64_t begin, off64_t end) {
+        std::lock_guard<std::mutex> lock(mLock);
+        return std::any_of(mReads.begin(), mReads.end(), [begin, end](off64_t offset) {
+            return offset >= begin && offset < end;
+        });
+    }
+
+    void clearReads() {
+        std::lock_guard<std::mutex> lock(mLock);
+        mReads.clear();
+    }
+
+private:
+    std::mutex mLock;
+    std::vector<off64_t> mReads;
+};
+
+}  // namespace
+
+class NuCachedSource2Test : public ::testing::Test {
+public:
+    void SetUp() override {
+        mSource = new MemorySource;
+        mCache = NuCachedSource2::Create(mSource, kCacheConfig);
+    }
+
+    void TearDown() override {
+        mCache.clear();
+        mSource.clear();
+    }
+
+    // Read |size| bytes at |offset| through the cache and check them.
+    void read(off64_t offset, size_t size) {
+        std::vector<uint8_t> data(size);
+        ASSERT_EQ((ssize_t)size, mCache->readAt(offset, data.data(), size))
+                << "offset " << offset;
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(MemorySource::ByteAt(offset + i), data[i])
+                    << "offset " << offset << " byte " << i;
+        }
+    }
+
+protected:
+    sp<MemorySource> mSource;
+    sp<NuCachedSource2> mCache;
+};
+
+// A short jump away and back, e.g. to a moov atom at the end of the file,
+// keeps the range read in between. The read at the far position is deferred
+// and retried until the prefetcher gets there, which must not lose track of
+// where the excursion started.
+TEST_F(NuCachedSource2Test, ExcursionIsPinned) {
+    constexpr off64_t kIndexOffset = 60 * kMiB;
+    constexpr size_t kIndexSize = 64 * 1024;
+
+    ASSERT_NO_FATAL_FAILURE(read(0, 4096));
+    ASSERT_NO_FATAL_FAILURE(read(4096, 4096));
+
+    ASSERT_NO_FATAL_FAILURE(read(kIndexOffset, kIndexSize));
+    ASSERT_NO_FATAL_FAILURE(read(kIndexOffset + kIndexSize, kIndexSize));
+
+    // back to where we came from
+    ASSERT_NO_FATAL_FAILURE(read(8192, 4096));
+
+    mSource->clearReads();
+    ASSERT_NO_FATAL_FAILURE(read(kIndexOffset, 2 * kIndexSize));
+    ASSERT_NO_FATAL_FAILURE(read(kIndexOffset + 1000, 1000));
+    EXPECT_FALSE(mSource->readFrom(kIndexOffset - 4 * kMiB, kFileSize))
+            << "the index range was read from the source again";
+}
+
+// Reading on past the end of the cache while the prefetcher catches up is
+// not an excursion, linear stream data is never pinned.
+TEST_F(NuCachedSource2Test, SequentialReadsAreNotPinned) {
+    constexpr size_t kChunkSize = 64 * 1024;
+    constexpr off64_t kIndexOffset = 60 * kMiB;
+
+    for (off64_t offset = 0; offset < 4 * kMiB; offset += kChunkSize) {
+        ASSERT_NO_FATAL_FAILURE(read(offset, kChunkSize));
+    }
+
+    ASSERT_NO_FATAL_FAILURE(read(kIndexOffset, kChunkSize));
+    ASSERT_NO_FATAL_FAILURE(read(4 * kMiB, kChunkSize));
+
+    mSource->clearReads();
+    ASSERT_NO_FATAL_FAILURE(read(kIndexOffset, kChunkSize));
+    EXPECT_FALSE(mSource->readFrom(kIndexOffset - 4 * kMiB, kFileSize));
+
+    mSource->clearReads();
+    ASSERT_NO_FATAL_FAILURE(read(2 * kMiB + kChunkSize, kChunkSize));
+    EXPECT_TRUE(mSource->readFrom(kMiB, 3 * kMiB))
+            << "linear stream data was served from a pinned range";
+}
@@ -536,6 +536,12 @@ void MPEG4Writer::initInternal(int fd, bool isFirstSession) {
     mSendNotify = false;
     mWriteSeekErr = false;
     mFallocateErr = false;
+    mStageWrites = false;
+    mWriteStagingBuffer.clear();
+    mNumWriteCalls = 0;
+    mNumBytesWritten = 0;
+    mTotalWriteDurationUs = 0;
+    mMaxWriteDurationUs = 0;
     // Reset following variables for all the sessions and they will be
     // initialized in start(MetaData *param).
     mIsRealTimeRecording = true;
@@ -614,6 +620,14 @@ status_t MPEG4Writer::dump(
     result.append(buffer);
     snprintf(buffer, SIZE, "     mStarted: %s\n", mStarted? "true": "false");
     result.append(buffer);
+    uint64_t numWriteCalls = mNumWriteCalls.load(std::memory_order_relaxed);
+    snprintf(buffer, SIZE, "     write calls: %" PRIu64 ", bytes: %" PRIu64
+            ", avg duration: %" PRId64 " us, max duration: %" PRId64 " us\n",
+            numWriteCalls, mNumBytesWritten.load(std::memory_order_relaxed),
+            numWriteCalls > 0 ? mTotalWriteDurationUs.load(std::memory_order_relaxed)
+                    / (int64_t)numWriteCalls : 0,
+            mMaxWriteDurationUs.load(std::memory_order_relaxed));
+    result.append(buffer);
     ::write(fd, result.c_str(), result.size());
     for (List<Track *>::iterator it = mTracks.begin();
          it != mTracks.end(); ++it) {
@@ -1788,8 +1802,58 @@ void MPEG4Writer::writeOrPostError(int fd, const void* buf, size_t count) {
     if (mWriteSeekErr == true)
         return;
 
+    if (!mStageWrites || fd != mFd) {
+        struct iovec iov = { const_cast<void *>(buf), count };
+        writevOrPostError(fd, &iov, 1);
+        return;
+    }
+
+    if (count < kMaxStagedWriteSize) {
+        if (mWriteStagingBuffer.size() + count > kWriteStagingCapacity) {
+            flushStagedWrites();
+        }
+        const uint8_t *ptr = (const uint8_t *)buf;
+        mWriteStagingBuffer.insert(mWriteStagingBuffer.end(), ptr, ptr + count);
+        return;
+    }
+
+    // Large sample data is not copied, it goes out in the same syscall as
+    // whatever was staged before it.
+    struct iovec iov[2];
+    int iovcnt = 0;
+    if (!mWriteStagingBuffer.empty()) {
+        iov[iovcnt].iov_base = mWriteStagingBuffer.data();
+        iov[iovcnt].iov_len = mWriteStagingBuffer.size();
+        ++iovcnt;
+    }
+    iov[iovcnt].iov_base = const_cast<void *>(buf);
+    iov[iovcnt].iov_len = count;
+    ++iovcnt;
+
+    writevOrPostError(fd, iov, iovcnt);
+    mWriteStagingBuffer.clear();
+}
+
+void MPEG4Writer::flushStagedWrites() {
+    if (mWriteStagingBuffer.empty()) {
+        return;
+    }
+
+    if (mWriteSeekErr == false) {
+        struct iovec iov = { mWriteStagingBuffer.data(), mWriteStagingBuffer.size() };
+        writevOrPostError(mFd, &iov, 1);
+    }
+    mWriteStagingBuffer.clear();
+}
+
+void MPEG4Writer::writevOrPostError(int fd, const struct iovec *iov, int iovcnt) {
+    size_t count = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        count += iov[i].iov_len;
+    }
+
     auto beforeTP = std::chrono::high_resolution_clock::now();
-    ssize_t bytesWritten = ::write(fd, buf, count);
+    ssize_t bytesWritten = ::writev(fd, iov, iovcnt);
     auto afterTP = std::chrono::high_resolution_clock::now();
     auto writeDuration =
             std::chrono::duration_cast<std::chrono::microseconds>(afterTP - beforeTP).count();
@@ -1797,6 +1861,15 @@ void MPEG4Writer::writeOrPostError(int fd, const void* buf, size_t count) {
     if (mWriteDurationPQ.size() > kWriteDurationsCount) {
         mWriteDurationPQ.pop();
     }
+    mNumWriteCalls.fetch_add(1, std::memory_order_relaxed);
+    mTotalWriteDurationUs.fetch_add(writeDuration, std::memory_order_relaxed);
+    // Writes are serialized; only dump() reads concurrently.
+    if (writeDuration > mMaxWriteDurationUs.load(std::memory_order_relaxed)) {
+        mMaxWriteDurationUs.store(writeDuration, std::memory_order_relaxed);
+    }
+    if (bytesWritten > 0) {
+        mNumBytesWritten.fetch_add(bytesWritten, std::memory_order_relaxed);
+    }
 
     /* Write as much as possible during stop() execution when there was an error
      * (mWriteSeekErr == true) in the previous call to write() or lseek64().
@@ -1805,16 +1878,19 @@ void MPEG4Writer::writeOrPostError(int fd, const void* buf, size_t count) {
         return;
     mWriteSeekErr = true;
     // Note that errno is not changed even when bytesWritten < count.
-    ALOGE("writeOrPostError bytesWritten:%zd, count:%zu, error:%s(%d)", bytesWritten, count,
+    ALOGE("writevOrPostError bytesWritten:%zd, count:%zu, error:%s(%d)", bytesWritten, count,
           std::strerror(errno), errno);
 
     // Can't guarantee that file is usable or write would succeed anymore, hence signal to stop.
     sp<AMessage> msg = new AMessage(kWhatIOError, mReflector);
     msg->setInt32("err", ERROR_IO);
-    WARN_UNLESS(msg->post() == OK, "writeOrPostError:error posting ERROR_IO");
+    WARN_UNLESS(msg->post() == OK, "writevOrPostError:error posting ERROR_IO");
 }
 
 void MPEG4Writer::seekOrPostError(int fd, off64_t offset, int whence) {
+    if (fd == mFd) {
+        flushStagedWrites();
+    }
     if (mWriteSeekErr == true)
         return;
     off64_t resOffset = lseek64(fd, offset, whence);
@@ -2793,6 +2869,7 @@ void MPEG4Writer::writeChunkToFile(Chunk* chunk) {
     ALOGV("writeChunkToFile: %" PRId64 " from %s track",
         chunk->mTimeStampUs, chunk->mTrack->getTrackType());
 
+    mStageWrites = true;
     int32_t isFirstSample = true;
     while (!chunk->mSamples.empty()) {
         List<MediaBuffer *>::iterator it = chunk->mSamples.begin();
@@ -2820,6 +2897,9 @@ void MPEG4Writer::writeChunkToFile(Chunk* chunk) {
         chunk->mSamples.erase(it);
     }
     chunk->mSamples.clear();
+
+    flushStagedWrites();
+    mStageWrites = false;
 }
 
 void MPEG4Writer::writeAllChunks() {
@@ -3216,6 +3216,7 @@ status_t MediaCodec::queueInputBuffer(
     }
 
     sp<AMessage> msg = new AMessage(kWhatQueueInputBuffer, this);
+    msg->setInt64("queuedAtNs", systemTime(SYSTEM_TIME_MONOTONIC));
     msg->setSize("index", index);
     msg->setSize("offset", offset);
     msg->setSize("size", size);
@@ -3233,6 +3234,7 @@ status_t MediaCodec::queueInputBuffers(
         const sp<BufferInfosWrapper> &infos,
         AString *errorDetailMsg) {
     sp<AMessage> msg = new AMessage(kWhatQueueInputBuffer, this);
+    msg->setInt64("queuedAtNs", systemTime(SYSTEM_TIME_MONOTONIC));
     uint32_t bufferFlags = 0;
     uint32_t flagsinAllAU = BUFFER_FLAG_DECODE_ONLY | BUFFER_FLAG_CODECCONFIG;
     uint32_t andFlags = flagsinAllAU;
@@ -3286,6 +3288,7 @@ status_t MediaCodec::queueSecureInputBuffer(
     }
 
     sp<AMessage> msg = new AMessage(kWhatQueueInputBuffer, this);
+    msg->setInt64("queuedAtNs", systemTime(SYSTEM_TIME_MONOTONIC));
     msg->setSize("index", index);
     msg->setSize("offset", offset);
     msg->setPointer("subSamples", (void *)subSamples);
@@ -3316,6 +3319,7 @@ status_t MediaCodec::queueSecureInputBuffers(
         errorDetailMsg->clear();
     }
     sp<AMessage> msg = new AMessage(kWhatQueueInputBuffer, this);
+    msg->setInt64("queuedAtNs", systemTime(SYSTEM_TIME_MONOTONIC));
     uint32_t bufferFlags = 0;
     uint32_t flagsinAllAU = BUFFER_FLAG_DECODE_ONLY | BUFFER_FLAG_CODECCONFIG;
     uint32_t andFlags = flagsinAllAU;
@@ -3371,6 +3375,7 @@ status_t MediaCodec::queueBuffer(
     }
     status_t err = OK;
     sp<AMessage> msg = new AMessage(kWhatQueueInputBuffer, this);
+    msg->setInt64("queuedAtNs", systemTime(SYSTEM_TIME_MONOTONIC));
     msg->setSize("index", index);
     sp<WrapperObject<std::shared_ptr<C2Buffer>>> obj{
         new WrapperObject<std::shared_ptr<C2Buffer>>{buffer}};
@@ -3406,6 +3411,7 @@ status_t MediaCodec::queueEncryptedBuffer(
     }
     status_t err = OK;
     sp<AMessage> msg = new AMessage(kWhatQueueInputBuffer, this);
+    msg->setInt64("queuedAtNs", systemTime(SYSTEM_TIME_MONOTONIC));
     msg->setSize("index", index);
     sp<WrapperObject<sp<hardware::HidlMemory>>> memory{
         new WrapperObject<sp<hardware::HidlMemory>>{buffer}};
@@ -5257,6 +5263,9 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
 
                     break;
                 }
+                if (mCodec != NULL) {
+                    mCodec->signalReclaim();
+                }
             }
 
             bool isReleasingAllocatedComponent =
@@ -6236,6 +6245,12 @@ status_t MediaCodec::onQueueInputBuffer(const sp<AMessage> &msg) {
             buffer->meta()->setObject("accessUnitInfo", obj);
         }
         buffer->meta()->setInt64("timeUs", timeUs);
+        // time the client queued the buffer, for frame latency tracing
+        int64_t queuedAtNs;
+        if (!msg->findInt64("queuedAtNs", &queuedAtNs)) {
+            queuedAtNs = systemTime(SYSTEM_TIME_MONOTONIC);
+        }
+        buffer->meta()->setInt64("queuedAtNs", queuedAtNs);
         if (flags & BUFFER_FLAG_EOS) {
             buffer->meta()->setInt32("eos", true);
         }
@@ -38,6 +38,7 @@
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/MediaCodecConstants.h>
 #include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/MediaFormatKeys.h>
 #include <media/AudioSystem.h>
 #include <media/MediaPlayerInterface.h>
 #include <media/stagefright/Utils.h>
@@ -735,194 +736,224 @@ static void parseAV1ProfileLevelFromCsd(const sp<ABuffer> &csd, sp<AMessage> &fo
 }
 
 
-static std::vector<std::pair<const char *, uint32_t>> stringMappings {
-    {
-        { "album", kKeyAlbum },
-        { "albumartist", kKeyAlbumArtist },
-        { "artist", kKeyArtist },
-        { "author", kKeyAuthor },
-        { "cdtracknum", kKeyCDTrackNumber },
-        { "compilation", kKeyCompilation },
-        { "composer", kKeyComposer },
-        { "date", kKeyDate },
-        { "discnum", kKeyDiscNumber },
-        { "genre", kKeyGenre },
-        { "location", kKeyLocation },
-        { "lyricist", kKeyWriter },
-        { "manufacturer", kKeyManufacturer },
-        { "title", kKeyTitle },
-        { "year", kKeyYear },
-    }
+// A format entry that is copied as is between an AMessage item and a MetaData key.
+struct FormatKeyMapping {
+    AMessage::Key name;
+    uint32_t key;
 };
 
-static std::vector<std::pair<const char *, uint32_t>> floatMappings {
-    {
-        { "capture-rate", kKeyCaptureFramerate },
-    }
+// Entries copied for every track, including scrambled ones.
+static constexpr FormatKeyMapping kStringMappings[] = {
+    { AMessage::Key("album"), kKeyAlbum },
+    { AMessage::Key("albumartist"), kKeyAlbumArtist },
+    { AMessage::Key("artist"), kKeyArtist },
+    { AMessage::Key("author"), kKeyAuthor },
+    { AMessage::Key("cdtracknum"), kKeyCDTrackNumber },
+    { AMessage::Key("compilation"), kKeyCompilation },
+    { AMessage::Key("composer"), kKeyComposer },
+    { AMessage::Key("date"), kKeyDate },
+    { AMessage::Key("discnum"), kKeyDiscNumber },
+    { AMessage::Key("genre"), kKeyGenre },
+    { AMessage::Key("location"), kKeyLocation },
+    { AMessage::Key("lyricist"), kKeyWriter },
+    { AMessage::Key("manufacturer"), kKeyManufacturer },
+    { AMessage::Key("title"), kKeyTitle },
+    { AMessage::Key("year"), kKeyYear },
 };
 
-static std::vector<std::pair<const char*, uint32_t>> int64Mappings {
-    {
-        { "exif-offset", kKeyExifOffset},
-        { "exif-size", kKeyExifSize},
-        { "xmp-offset", kKeyXmpOffset},
-        { "xmp-size", kKeyXmpSize},
-        { "target-time", kKeyTargetTime},
-        { "thumbnail-time", kKeyThumbnailTime},
-        { "timeUs", kKeyTime},
-        { "durationUs", kKeyDuration},
-        { "sample-file-offset", kKeySampleFileOffset},
-        { "last-sample-index-in-chunk", kKeyLastSampleIndexInChunk},
-        { "sample-time-before-append", kKeySampleTimeBeforeAppend},
-    }
+static constexpr FormatKeyMapping kFloatMappings[] = {
+    { AMessage::Key("capture-rate"), kKeyCaptureFramerate },
 };
 
-static std::vector<std::pair<const char *, uint32_t>> int32Mappings {
-    {
-        { "loop", kKeyAutoLoop },
-        { "time-scale", kKeyTimeScale },
-        { "crypto-mode", kKeyCryptoMode },
-        { "crypto-default-iv-size", kKeyCryptoDefaultIVSize },
-        { "crypto-encrypted-byte-block", kKeyEncryptedByteBlock },
-        { "crypto-skip-byte-block", kKeySkipByteBlock },
-        { "frame-count", kKeyFrameCount },
-        { "max-bitrate", kKeyMaxBitRate },
-        { "pcm-big-endian", kKeyPcmBigEndian },
-        { "temporal-layer-count", kKeyTemporalLayerCount },
-        { "temporal-layer-id", kKeyTemporalLayerId },
-        { "thumbnail-width", kKeyThumbnailWidth },
-        { "thumbnail-height", kKeyThumbnailHeight },
-        { "track-id", kKeyTrackID },
-        { "valid-samples", kKeyValidSamples },
-        { "dvb-component-tag", kKeyDvbComponentTag},
-        { "dvb-audio-description", kKeyDvbAudioDescription},
-        { "dvb-teletext-magazine-number", kKeyDvbTeletextMagazineNumber},
-        { "dvb-teletext-page-number", kKeyDvbTeletextPageNumber},
-        { "profile", kKeyAudioProfile },
-        { "level", kKeyAudioLevel },
-    }
+static constexpr FormatKeyMapping kInt64Mappings[] = {
+    { AMessage::Key("exif-offset"), kKeyExifOffset },
+    { AMessage::Key("exif-size"), kKeyExifSize },
+    { AMessage::Key("xmp-offset"), kKeyXmpOffset },
+    { AMessage::Key("xmp-size"), kKeyXmpSize },
+    { AMessage::Key("target-time"), kKeyTargetTime },
+    { AMessage::Key("thumbnail-time"), kKeyThumbnailTime },
+    { AMessage::Key("timeUs"), kKeyTime },
+    { FormatKeys::kDurationUs, kKeyDuration },
+    { AMessage::Key("sample-file-offset"), kKeySampleFileOffset },
+    { AMessage::Key("last-sample-index-in-chunk"), kKeyLastSampleIndexInChunk },
+    { AMessage::Key("sample-time-before-append"), kKeySampleTimeBeforeAppend },
 };
 
-static std::vector<std::pair<const char *, uint32_t>> bufferMappings {
-    {
-        { "albumart", kKeyAlbumArt },
-        { "audio-presentation-info", kKeyAudioPresentationInfo },
-        { "pssh", kKeyPssh },
-        { "crypto-iv", kKeyCryptoIV },
-        { "crypto-key", kKeyCryptoKey },
-        { "crypto-encrypted-sizes", kKeyEncryptedSizes },
-        { "crypto-plain-sizes", kKeyPlainSizes },
-        { "icc-profile", kKeyIccProfile },
-        { "sei", kKeySEI },
-        { "text-format-data", kKeyTextFormatData },
-        { "thumbnail-csd-hevc", kKeyThumbnailHVCC },
-        { "slow-motion-markers", kKeySlowMotionMarkers },
-        { "thumbnail-csd-av1c", kKeyThumbnailAV1C },
-    }
+static constexpr FormatKeyMapping kInt32Mappings[] = {
+    { AMessage::Key("loop"), kKeyAutoLoop },
+    { AMessage::Key("time-scale"), kKeyTimeScale },
+    { AMessage::Key("crypto-mode"), kKeyCryptoMode },
+    { AMessage::Key("crypto-default-iv-size"), kKeyCryptoDefaultIVSize },
+    { AMessage::Key("crypto-encrypted-byte-block"), kKeyEncryptedByteBlock },
+    { AMessage::Key("crypto-skip-byte-block"), kKeySkipByteBlock },
+    { AMessage::Key("frame-count"), kKeyFrameCount },
+    { FormatKeys::kMaxBitrate, kKeyMaxBitRate },
+    { AMessage::Key("pcm-big-endian"), kKeyPcmBigEndian },
+    { AMessage::Key("temporal-layer-count"), kKeyTemporalLayerCount },
+    { AMessage::Key("temporal-layer-id"), kKeyTemporalLayerId },
+    { AMessage::Key("thumbnail-width"), kKeyThumbnailWidth },
+    { AMessage::Key("thumbnail-height"), kKeyThumbnailHeight },
+    { AMessage::Key("track-id"), kKeyTrackID },
+    { AMessage::Key("valid-samples"), kKeyValidSamples },
+    { FormatKeys::kDvbComponentTag, kKeyDvbComponentTag },
+    { FormatKeys::kDvbAudioDescription, kKeyDvbAudioDescription },
+    { FormatKeys::kDvbTeletextMagazineNumber, kKeyDvbTeletextMagazineNumber },
+    { FormatKeys::kDvbTeletextPageNumber, kKeyDvbTeletextPageNumber },
+    { FormatKeys::kProfile, kKeyAudioProfile },
+    { FormatKeys::kLevel, kKeyAudioLevel },
 };
 
-static std::vector<std::pair<const char *, uint32_t>> CSDMappings {
-    {
-        { "csd-0", kKeyOpaqueCSD0 },
-        { "csd-1", kKeyOpaqueCSD1 },
-        { "csd-2", kKeyOpaqueCSD2 },
-    }
+static constexpr FormatKeyMapping kBufferMappings[] = {
+    { AMessage::Key("albumart"), kKeyAlbumArt },
+    { AMessage::Key("audio-presentation-info"), kKeyAudioPresentationInfo },
+    { AMessage::Key("pssh"), kKeyPssh },
+    { AMessage::Key("crypto-iv"), kKeyCryptoIV },
+    { AMessage::Key("crypto-key"), kKeyCryptoKey },
+    { AMessage::Key("crypto-encrypted-sizes"), kKeyEncryptedSizes },
+    { AMessage::Key("crypto-plain-sizes"), kKeyPlainSizes },
+    { AMessage::Key("icc-profile"), kKeyIccProfile },
+    { AMessage::Key("sei"), kKeySEI },
+    { AMessage::Key("text-format-data"), kKeyTextFormatData },
+    { AMessage::Key("thumbnail-csd-hevc"), kKeyThumbnailHVCC },
+    { AMessage::Key("slow-motion-markers"), kKeySlowMotionMarkers },
+    { AMessage::Key("thumbnail-csd-av1c"), kKeyThumbnailAV1C },
+};
+
+static constexpr FormatKeyMapping kCSDMappings[] = {
+    { FormatKeys::kCsd0, kKeyOpaqueCSD0 },
+    { FormatKeys::kCsd1, kKeyOpaqueCSD1 },
+    { FormatKeys::kCsd2, kKeyOpaqueCSD2 },
+};
+
+// Entries copied for audio tracks.
+static constexpr FormatKeyMapping kAudioInt32Mappings[] = {
+    { FormatKeys::kBitsPerSample, kKeyBitsPerSample },
+    { FormatKeys::kChannelMask, kKeyChannelMask },
+    { FormatKeys::kEncoderDelay, kKeyEncoderDelay },
+    { FormatKeys::kEncoderPadding, kKeyEncoderPadding },
+    { FormatKeys::kIsAdts, kKeyIsADTS },
+    { AMessage::Key(AMEDIAFORMAT_KEY_MPEGH_PROFILE_LEVEL_INDICATION),
+            kKeyMpeghProfileLevelIndication },
+    { AMessage::Key(AMEDIAFORMAT_KEY_MPEGH_REFERENCE_CHANNEL_LAYOUT),
+            kKeyMpeghReferenceChannelLayout },
+    { FormatKeys::kAacProfile, kKeyAACAOT },
+    { FormatKeys::kPcmEncoding, kKeyPcmEncoding },
+    { FormatKeys::kHapticChannelCount, kKeyHapticChannelCount },
+};
+
+// Entries copied for all unscrambled tracks after the track type specific ones.
+static constexpr FormatKeyMapping kTrailingInt32Mappings[] = {
+    { FormatKeys::kMaxInputSize, kKeyMaxInputSize },
+    { FormatKeys::kMaxWidth, kKeyMaxWidth },
+    { FormatKeys::kMaxHeight, kKeyMaxHeight },
 };
 
+template <size_t N>
+static void copyInt32Mappings(
+        const sp<AMessage> &msg, const FormatKeyMapping (&mappings)[N], MetaDataBase *meta) {
+    for (const FormatKeyMapping &elem : mappings) {
+        int32_t value;
+        if (msg->findInt32(elem.name, &value)) {
+            meta->setInt32(elem.key, value);
+        }
+    }
+}
+
+template <size_t N>
+static void copyInt32Mappings(
+        const MetaDataBase *meta, const FormatKeyMapping (&mappings)[N], const sp<AMessage> &msg) {
+    for (const FormatKeyMapping &elem : mappings) {
+        int32_t value;
+        if (meta->findInt32(elem.key, &value)) {
+            msg->setInt32(elem.name, value);
+        }
+    }
+}
+
 void convertMessageToMetaDataFromMappings(const sp<AMessage> &msg, sp<MetaData> &meta) {
-    for (auto elem : stringMappings) {
+    for (const FormatKeyMapping &elem : kStringMappings) {
         AString value;
-        if (msg->findString(elem.first, &value)) {
-            meta->setCString(elem.second, value.c_str());
+        if (msg->findString(elem.name, &value)) {
+            meta->setCString(elem.key, value.c_str());
         }
     }
 
-    for (auto elem : floatMappings) {
+    for (const FormatKeyMapping &elem : kFloatMappings) {
         float value;
-        if (msg->findFloat(elem.first, &value)) {
-            meta->setFloat(elem.second, value);
+        if (msg->findFloat(elem.name, &value)) {
+            meta->setFloat(elem.key, value);
         }
     }
 
-    for (auto elem : int64Mappings) {
+    for (const FormatKeyMapping &elem : kInt64Mappings) {
         int64_t value;
-        if (msg->findInt64(elem.first, &value)) {
-            meta->setInt64(elem.second, value);
+        if (msg->findInt64(elem.name, &value)) {
+            meta->setInt64(elem.key, value);
         }
     }
 
-    for (auto elem : int32Mappings) {
-        int32_t value;
-        if (msg->findInt32(elem.first, &value)) {
-            meta->setInt32(elem.second, value);
-        }
-    }
+    copyInt32Mappings(msg, kInt32Mappings, meta.get());
 
-    for (auto elem : bufferMappings) {
+    for (const FormatKeyMapping &elem : kBufferMappings) {
         sp<ABuffer> value;
-        if (msg->findBuffer(elem.first, &value)) {
-            meta->setData(elem.second,
+        if (msg->findBuffer(elem.name, &value)) {
+            meta->setData(elem.key,
                     MetaDataBase::Type::TYPE_NONE, value->data(), value->size());
         }
     }
 
-    for (auto elem : CSDMappings) {
+    for (const FormatKeyMapping &elem : kCSDMappings) {
         sp<ABuffer> value;
-        if (msg->findBuffer(elem.first, &value)) {
-            meta->setData(elem.second,
+        if (msg->findBuffer(elem.name, &value)) {
+            meta->setData(elem.key,
                     MetaDataBase::Type::TYPE_NONE, value->data(), value->size());
         }
     }
 }
 
 void convertMetaDataToMessageFromMappings(const MetaDataBase *meta, sp<AMessage> format) {
-    for (auto elem : stringMappings) {
+    for (const FormatKeyMapping &elem : kStringMappings) {
         const char *value;
-        if (meta->findCString(elem.second, &value)) {
-            format->setString(elem.first, value, strlen(value));
+        if (meta->findCString(elem.key, &value)) {
+            format->setString(elem.name, value, strlen(value));
         }
     }
 
-    for (auto elem : floatMappings) {
+    for (const FormatKeyMapping &elem : kFloatMappings) {
         float value;
-        if (meta->findFloat(elem.second, &value)) {
-            format->setFloat(elem.first, value);
+        if (meta->findFloat(elem.key, &value)) {
+            format->setFloat(elem.name, value);
         }
     }
 
-    for (auto elem : int64Mappings) {
+    for (const FormatKeyMapping &elem : kInt64Mappings) {
         int64_t value;
-        if (meta->findInt64(elem.second, &value)) {
-            format->setInt64(elem.first, value);
+        if (meta->findInt64(elem.key, &value)) {
+            format->setInt64(elem.name, value);
         }
     }
 
-    for (auto elem : int32Mappings) {
-        int32_t value;
-        if (meta->findInt32(elem.second, &value)) {
-            format->setInt32(elem.first, value);
-        }
-    }
+    copyInt32Mappings(meta, kInt32Mappings, format);
 
-    for (auto elem : bufferMappings) {
+    for (const FormatKeyMapping &elem : kBufferMappings) {
         uint32_t type;
         const void* data;
         size_t size;
-        if (meta->findData(elem.second, &type, &data, &size)) {
+        if (meta->findData(elem.key, &type, &data, &size)) {
             sp<ABuffer> buf = ABuffer::CreateAsCopy(data, size);
-            format->setBuffer(elem.first, buf);
+            format->setBuffer(elem.name, buf);
         }
     }
 
-    for (auto elem : CSDMappings) {
+    for (const FormatKeyMapping &elem : kCSDMappings) {
         uint32_t type;
         const void* data;
         size_t size;
-        if (meta->findData(elem.second, &type, &data, &size)) {
+        if (meta->findData(elem.key, &type, &data, &size)) {
             sp<ABuffer> buf = ABuffer::CreateAsCopy(data, size);
             buf->meta()->setInt32("csd", true);
             buf->meta()->setInt64("timeUs", 0);
-            format->setBuffer(elem.first, buf);
+            format->setBuffer(elem.name, buf);
         }
     }
 }
@@ -948,7 +979,7 @@ status_t convertMetaDataToMessage(
     }
 
     sp<AMessage> msg = new AMessage;
-    msg->setString("mime", mime);
+    msg->setString(FormatKeys::kMime, mime);
 
     convertMetaDataToMessageFromMappings(meta, msg);
 
@@ -961,7 +992,7 @@ status_t convertMetaDataToMessage(
             return NO_MEMORY;
         }
 
-        msg->setBuffer("ca-session-id", buffer);
+        msg->setBuffer(FormatKeys::kCaSessionId, buffer);
         memcpy(buffer->data(), data, size);
     }
 
@@ -971,13 +1002,13 @@ status_t convertMetaDataToMessage(
             return NO_MEMORY;
         }
 
-        msg->setBuffer("ca-private-data", buffer);
+        msg->setBuffer(FormatKeys::kCaPrivateData, buffer);
         memcpy(buffer->data(), data, size);
     }
 
     int32_t systemId;
     if (meta->findInt32(kKeyCASystemID, &systemId)) {
-        msg->setInt32("ca-system-id", systemId);
+        msg->setInt32(FormatKeys::kCaSystemId, systemId);
     }
 
     if (!strncasecmp("video/scrambled", mime, 15)
@@ -987,50 +1018,22 @@ status_t convertMetaDataToMessage(
         return OK;
     }
 
-    int64_t durationUs;
-    if (meta->findInt64(kKeyDuration, &durationUs)) {
-        msg->setInt64("durationUs", durationUs);
-    }
+    // durationUs, max-bitrate and the dvb-* entries were copied with kInt32Mappings and
+    // kInt64Mappings above.
 
     int32_t avgBitRate = 0;
     if (meta->findInt32(kKeyBitRate, &avgBitRate) && avgBitRate > 0) {
-        msg->setInt32("bitrate", avgBitRate);
-    }
-
-    int32_t maxBitRate;
-    if (meta->findInt32(kKeyMaxBitRate, &maxBitRate)
-            && maxBitRate > 0 && maxBitRate >= avgBitRate) {
-        msg->setInt32("max-bitrate", maxBitRate);
+        msg->setInt32(FormatKeys::kBitrate, avgBitRate);
     }
 
     int32_t isSync;
     if (meta->findInt32(kKeyIsSyncFrame, &isSync) && isSync != 0) {
-        msg->setInt32("is-sync-frame", 1);
-    }
-
-    int32_t dvbComponentTag = 0;
-    if (meta->findInt32(kKeyDvbComponentTag, &dvbComponentTag)) {
-        msg->setInt32("dvb-component-tag", dvbComponentTag);
-    }
-
-    int32_t dvbAudioDescription = 0;
-    if (meta->findInt32(kKeyDvbAudioDescription, &dvbAudioDescription)) {
-        msg->setInt32("dvb-audio-description", dvbAudioDescription);
-    }
-
-    int32_t dvbTeletextMagazineNumber = 0;
-    if (meta->findInt32(kKeyDvbTeletextMagazineNumber, &dvbTeletextMagazineNumber)) {
-        msg->setInt32("dvb-teletext-magazine-number", dvbTeletextMagazineNumber);
-    }
-
-    int32_t dvbTeletextPageNumber = 0;
-    if (meta->findInt32(kKeyDvbTeletextPageNumber, &dvbTeletextPageNumber)) {
-        msg->setInt32("dvb-teletext-page-number", dvbTeletextPageNumber);
+        msg->setInt32(FormatKeys::kIsSyncFrame, 1);
     }
 
     const char *lang;
     if (meta->findCString(kKeyMediaLanguage, &lang)) {
-        msg->setString("language", lang);
+        msg->setString(FormatKeys::kLanguage, lang);
     }
 
     if (!strncasecmp("video/", mime, 6) ||
@@ -1041,21 +1044,21 @@ status_t convertMetaDataToMessage(
             return BAD_VALUE;
         }
 
-        msg->setInt32("width", width);
-        msg->setInt32("height", height);
+        msg->setInt32(FormatKeys::kWidth, width);
+        msg->setInt32(FormatKeys::kHeight, height);
 
         int32_t displayWidth, displayHeight;
         if (meta->findInt32(kKeyDisplayWidth, &displayWidth)
                 && meta->findInt32(kKeyDisplayHeight, &displayHeight)) {
-            msg->setInt32("display-width", displayWidth);
-            msg->setInt32("display-height", displayHeight);
+            msg->setInt32(FormatKeys::kDisplayWidth, displayWidth);
+            msg->setInt32(FormatKeys::kDisplayHeight, displayHeight);
         }
 
         int32_t sarWidth, sarHeight;
         if (meta->findInt32(kKeySARWidth, &sarWidth)
                 && meta->findInt32(kKeySARHeight, &sarHeight)) {
-            msg->setInt32("sar-width", sarWidth);
-            msg->setInt32("sar-height", sarHeight);
+            msg->setInt32(FormatKeys::kSarWidth, sarWidth);
+            msg->setInt32(FormatKeys::kSarHeight, sarHeight);
         }
 
         if (!strncasecmp("image/", mime, 6)) {
@@ -1064,20 +1067,20 @@ status_t convertMetaDataToMessage(
                     && meta->findInt32(kKeyTileHeight, &tileHeight)
                     && meta->findInt32(kKeyGridRows, &gridRows)
                     && meta->findInt32(kKeyGridCols, &gridCols)) {
-                msg->setInt32("tile-width", tileWidth);
-                msg->setInt32("tile-height", tileHeight);
-                msg->setInt32("grid-rows", gridRows);
-                msg->setInt32("grid-cols", gridCols);
+                msg->setInt32(FormatKeys::kTileWidth, tileWidth);
+                msg->setInt32(FormatKeys::kTileHeight, tileHeight);
+                msg->setInt32(FormatKeys::kGridRows, gridRows);
+                msg->setInt32(FormatKeys::kGridCols, gridCols);
             }
             int32_t isPrimary;
             if (meta->findInt32(kKeyTrackIsDefault, &isPrimary) && isPrimary) {
-                msg->setInt32("is-default", 1);
+                msg->setInt32(FormatKeys::kIsDefault, 1);
             }
         }
 
         int32_t colorFormat;
         if (meta->findInt32(kKeyColorFormat, &colorFormat)) {
-            msg->setInt32("color-format", colorFormat);
+            msg->setInt32(FormatKeys::kColorFormat, colorFormat);
         }
 
         int32_t cropLeft, cropTop, cropRight, cropBottom;
@@ -1089,11 +1092,6 @@ status_t convertMetaDataToMessage(
             msg->setRect("crop", cropLeft, cropTop, cropRight, cropBottom);
         }
 
-        int32_t rotationDegrees;
-        if (meta->findInt32(kKeyRotation, &rotationDegrees)) {
-            msg->setInt32("rotation-degrees", rotationDegrees);
-        }
-
         uint32_t type;
         const void *data;
         size_t size;
@@ -1109,7 +1107,7 @@ status_t convertMetaDataToMessage(
                 return NO_MEMORY;
             }
             memcpy(buffer->data(), data, size);
-            msg->setBuffer("hdr10-plus-info", buffer);
+            msg->setBuffer(FormatKeys::kHdr10PlusInfo, buffer);
         }
 
         convertMetaDataToMessageColorAspects(meta, msg);
@@ -1120,43 +1118,11 @@ status_t convertMetaDataToMessage(
             return BAD_VALUE;
         }
 
-        msg->setInt32("channel-count", numChannels);
-        msg->setInt32("sample-rate", sampleRate);
-
-        int32_t bitsPerSample;
-        if (meta->findInt32(kKeyBitsPerSample, &bitsPerSample)) {
-            msg->setInt32("bits-per-sample", bitsPerSample);
-        }
-
-        int32_t channelMask;
-        if (meta->findInt32(kKeyChannelMask, &channelMask)) {
-            msg->setInt32("channel-mask", channelMask);
-        }
-
-        int32_t delay = 0;
-        if (meta->findInt32(kKeyEncoderDelay, &delay)) {
-            msg->setInt32("encoder-delay", delay);
-        }
-        int32_t padding = 0;
-        if (meta->findInt32(kKeyEncoderPadding, &padding)) {
-            msg->setInt32("encoder-padding", padding);
-        }
+        msg->setInt32(FormatKeys::kChannelCount, numChannels);
+        msg->setInt32(FormatKeys::kSampleRate, sampleRate);
 
-        int32_t isADTS;
-        if (meta->findInt32(kKeyIsADTS, &isADTS)) {
-            msg->setInt32("is-adts", isADTS);
-        }
+        copyInt32Mappings(meta, kAudioInt32Mappings, msg);
 
-        int32_t mpeghProfileLevelIndication;
-        if (meta->findInt32(kKeyMpeghProfileLevelIndication, &mpeghProfileLevelIndication)) {
-            msg->setInt32(AMEDIAFORMAT_KEY_MPEGH_PROFILE_LEVEL_INDICATION,
-                    mpeghProfileLevelIndication);
-        }
-        int32_t mpeghReferenceChannelLayout;
-        if (meta->findInt32(kKeyMpeghReferenceChannelLayout, &mpeghReferenceChannelLayout)) {
-            msg->setInt32(AMEDIAFORMAT_KEY_MPEGH_REFERENCE_CHANNEL_LAYOUT,
-                    mpeghReferenceChannelLayout);
-        }
         if (meta->findData(kKeyMpeghCompatibleSets, &type, &data, &size)) {
             sp<ABuffer> buffer = new (std::nothrow) ABuffer(size);
             if (buffer.get() == NULL || buffer->base() == NULL) {
@@ -1165,46 +1131,18 @@ status_t convertMetaDataToMessage(
             msg->setBuffer(AMEDIAFORMAT_KEY_MPEGH_COMPATIBLE_SETS, buffer);
             memcpy(buffer->data(), data, size);
         }
-
-        int32_t aacProfile = -1;
-        if (meta->findInt32(kKeyAACAOT, &aacProfile)) {
-            msg->setInt32("aac-profile", aacProfile);
-        }
-
-        int32_t pcmEncoding;
-        if (meta->findInt32(kKeyPcmEncoding, &pcmEncoding)) {
-            msg->setInt32("pcm-encoding", pcmEncoding);
-        }
-
-        int32_t hapticChannelCount;
-        if (meta->findInt32(kKeyHapticChannelCount, &hapticChannelCount)) {
-            msg->setInt32("haptic-channel-count", hapticChannelCount);
-        }
     }
 
-    int32_t maxInputSize;
-    if (meta->findInt32(kKeyMaxInputSize, &maxInputSize)) {
-        msg->setInt32("max-input-size", maxInputSize);
-    }
-
-    int32_t maxWidth;
-    if (meta->findInt32(kKeyMaxWidth, &maxWidth)) {
-        msg->setInt32("max-width", maxWidth);
-    }
-
-    int32_t maxHeight;
-    if (meta->findInt32(kKeyMaxHeight, &maxHeight)) {
-        msg->setInt32("max-height", maxHeight);
-    }
+    copyInt32Mappings(meta, kTrailingInt32Mappings, msg);
 
     int32_t rotationDegrees;
     if (meta->findInt32(kKeyRotation, &rotationDegrees)) {
-        msg->setInt32("rotation-degrees", rotationDegrees);
+        msg->setInt32(FormatKeys::kRotationDegrees, rotationDegrees);
     }
 
     int32_t fps;
     if (meta->findInt32(kKeyFrameRate, &fps) && fps > 0) {
-        msg->setInt32("frame-rate", fps);
+        msg->setInt32(FormatKeys::kFrameRate, fps);
     }
 
     if (meta->findData(kKeyAVCC, &type, &data, &size)) {
@@ -1265,7 +1203,7 @@ status_t convertMetaDataToMessage(
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
 
-        msg->setBuffer("csd-0", buffer);
+        msg->setBuffer(FormatKeys::kCsd0, buffer);
 
         buffer = new (std::nothrow) ABuffer(1024);
         if (buffer.get() == NULL || buffer->base() == NULL) {
@@ -1305,7 +1243,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-1", buffer);
+        msg->setBuffer(FormatKeys::kCsd1, buffer);
     } else if (meta->findData(kKeyHVCC, &type, &data, &size)) {
         const uint8_t *ptr = (const uint8_t *)data;
 
@@ -1372,7 +1310,7 @@ status_t convertMetaDataToMessage(
         }
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-0", buffer);
+        msg->setBuffer(FormatKeys::kCsd0, buffer);
 
         // if we saw VUI color information we know whether this is HDR because VUI trumps other
         // format parameters for HEVC.
@@ -1425,9 +1363,9 @@ status_t convertMetaDataToMessage(
             int32_t standard, transfer, range;
             if (ColorUtils::convertCodecColorAspectsToPlatformAspects(
                     aspects, &range, &standard, &transfer) == OK) {
-                msg->setInt32("color-standard", standard);
-                msg->setInt32("color-transfer", transfer);
-                msg->setInt32("color-range", range);
+                msg->setInt32(FormatKeys::kColorStandard, standard);
+                msg->setInt32(FormatKeys::kColorTransfer, transfer);
+                msg->setInt32(FormatKeys::kColorRange, range);
             }
         }
 
@@ -1441,7 +1379,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-0", buffer);
+        msg->setBuffer(FormatKeys::kCsd0, buffer);
         parseAV1ProfileLevelFromCsd(buffer, msg);
     } else if (meta->findData(kKeyESDS, &type, &data, &size)) {
         ESDS esds((const char *)data, size);
@@ -1464,7 +1402,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-0", buffer);
+        msg->setBuffer(FormatKeys::kCsd0, buffer);
 
         if (!strcasecmp(mime, MEDIA_MIMETYPE_VIDEO_MPEG4)) {
             parseMpeg4ProfileLevelFromCsd(buffer, msg);
@@ -1481,13 +1419,13 @@ status_t convertMetaDataToMessage(
         if (esds.getBitRate(&maxBitrate, &avgBitrate) == OK) {
             if (!meta->hasData(kKeyBitRate)
                     && avgBitrate > 0 && avgBitrate <= INT32_MAX) {
-                msg->setInt32("bitrate", (int32_t)avgBitrate);
+                msg->setInt32(FormatKeys::kBitrate, (int32_t)avgBitrate);
             } else {
-                (void)msg->findInt32("bitrate", (int32_t*)&avgBitrate);
+                (void)msg->findInt32(FormatKeys::kBitrate, (int32_t*)&avgBitrate);
             }
             if (!meta->hasData(kKeyMaxBitRate)
                     && maxBitrate > 0 && maxBitrate <= INT32_MAX && maxBitrate >= avgBitrate) {
-                msg->setInt32("max-bitrate", (int32_t)maxBitrate);
+                msg->setInt32(FormatKeys::kMaxBitrate, (int32_t)maxBitrate);
             }
         }
     } else if (meta->findData(kKeyD263, &type, &data, &size)) {
@@ -1502,7 +1440,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-0", buffer);
+        msg->setBuffer(FormatKeys::kCsd0, buffer);
 
         if (!meta->findData(kKeyOpusCodecDelay, &type, &data, &size)) {
             return -EINVAL;
@@ -1516,7 +1454,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-1", buffer);
+        msg->setBuffer(FormatKeys::kCsd1, buffer);
 
         if (!meta->findData(kKeyOpusSeekPreRoll, &type, &data, &size)) {
             return -EINVAL;
@@ -1530,7 +1468,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-2", buffer);
+        msg->setBuffer(FormatKeys::kCsd2, buffer);
     } else if (meta->findData(kKeyVp9CodecPrivate, &type, &data, &size)) {
         sp<ABuffer> buffer = new (std::nothrow) ABuffer(size);
         if (buffer.get() == NULL || buffer->base() == NULL) {
@@ -1540,7 +1478,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-0", buffer);
+        msg->setBuffer(FormatKeys::kCsd0, buffer);
 
         parseVp9ProfileLevelFromCsd(buffer, msg);
     } else if (meta->findData(kKeyAlacMagicCookie, &type, &data, &size)) {
@@ -1553,7 +1491,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-0", buffer);
+        msg->setBuffer(FormatKeys::kCsd0, buffer);
     }
 
     if (meta->findData(kKeyDVCC, &type, &data, &size)
@@ -1570,7 +1508,7 @@ status_t convertMetaDataToMessage(
 
         buffer->meta()->setInt32("csd", true);
         buffer->meta()->setInt64("timeUs", 0);
-        msg->setBuffer("csd-2", buffer);
+        msg->setBuffer(FormatKeys::kCsd2, buffer);
     }
 
     *format = msg;
@@ -1737,9 +1675,9 @@ static void convertMessageToMetaDataInt32(
 static void convertMessageToMetaDataColorAspects(const sp<AMessage> &msg, sp<MetaData> &meta) {
     // 0 values are unspecified
     int32_t range = 0, standard = 0, transfer = 0;
-    (void)msg->findInt32("color-range", &range);
-    (void)msg->findInt32("color-standard", &standard);
-    (void)msg->findInt32("color-transfer", &transfer);
+    (void)msg->findInt32(FormatKeys::kColorRange, &range);
+    (void)msg->findInt32(FormatKeys::kColorStandard, &standard);
+    (void)msg->findInt32(FormatKeys::kColorTransfer, &transfer);
 
     ColorAspects colorAspects;
     memset(&colorAspects, 0, sizeof(colorAspects));
@@ -1767,7 +1705,7 @@ static void convertMessageToMetaDataColorAspects(const sp<AMessage> &msg, sp<Met
  */
 status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
     AString mime;
-    if (msg->findString("mime", &mime)) {
+    if (msg->findString(FormatKeys::kMime, &mime)) {
         meta->setCString(kKeyMIMEType, mime.c_str());
     } else {
         ALOGV("did not find mime type");
@@ -1777,25 +1715,22 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
     convertMessageToMetaDataFromMappings(msg, meta);
 
     int32_t systemId;
-    if (msg->findInt32("ca-system-id", &systemId)) {
+    if (msg->findInt32(FormatKeys::kCaSystemId, &systemId)) {
         meta->setInt32(kKeyCASystemID, systemId);
 
         sp<ABuffer> caSessionId, caPvtData;
-        if (msg->findBuffer("ca-session-id", &caSessionId)) {
+        if (msg->findBuffer(FormatKeys::kCaSessionId, &caSessionId)) {
             meta->setData(kKeyCASessionID, 0, caSessionId->data(), caSessionId->size());
         }
-        if (msg->findBuffer("ca-private-data", &caPvtData)) {
+        if (msg->findBuffer(FormatKeys::kCaPrivateData, &caPvtData)) {
             meta->setData(kKeyCAPrivateData, 0, caPvtData->data(), caPvtData->size());
         }
     }
 
-    int64_t durationUs;
-    if (msg->findInt64("durationUs", &durationUs)) {
-        meta->setInt64(kKeyDuration, durationUs);
-    }
+    // durationUs was copied with kInt64Mappings above.
 
     int32_t isSync;
-    if (msg->findInt32("is-sync-frame", &isSync) && isSync != 0) {
+    if (msg->findInt32(FormatKeys::kIsSyncFrame, &isSync) && isSync != 0) {
         meta->setInt32(kKeyIsSyncFrame, 1);
     }
 
@@ -1805,44 +1740,22 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         meta->setInt32(isBackgroundMode, 1);
     }
 
+    // max-bitrate and the dvb-* entries were copied with kInt32Mappings above.
     int32_t avgBitrate = 0;
-    int32_t maxBitrate;
-    if (msg->findInt32("bitrate", &avgBitrate) && avgBitrate > 0) {
+    if (msg->findInt32(FormatKeys::kBitrate, &avgBitrate) && avgBitrate > 0) {
         meta->setInt32(kKeyBitRate, avgBitrate);
     }
-    if (msg->findInt32("max-bitrate", &maxBitrate) && maxBitrate > 0 && maxBitrate >= avgBitrate) {
-        meta->setInt32(kKeyMaxBitRate, maxBitrate);
-    }
-
-    int32_t dvbComponentTag = 0;
-    if (msg->findInt32("dvb-component-tag", &dvbComponentTag) && dvbComponentTag > 0) {
-        meta->setInt32(kKeyDvbComponentTag, dvbComponentTag);
-    }
-
-    int32_t dvbAudioDescription = 0;
-    if (msg->findInt32("dvb-audio-description", &dvbAudioDescription)) {
-        meta->setInt32(kKeyDvbAudioDescription, dvbAudioDescription);
-    }
-
-    int32_t dvbTeletextMagazineNumber = 0;
-    if (msg->findInt32("dvb-teletext-magazine-number", &dvbTeletextMagazineNumber)) {
-        meta->setInt32(kKeyDvbTeletextMagazineNumber, dvbTeletextMagazineNumber);
-    }
-
-    int32_t dvbTeletextPageNumber = 0;
-    if (msg->findInt32("dvb-teletext-page-number", &dvbTeletextPageNumber)) {
-        meta->setInt32(kKeyDvbTeletextPageNumber, dvbTeletextPageNumber);
-    }
 
     AString lang;
-    if (msg->findString("language", &lang)) {
+    if (msg->findString(FormatKeys::kLanguage, &lang)) {
         meta->setCString(kKeyMediaLanguage, lang.c_str());
     }
 
     if (mime.startsWith("video/") || mime.startsWith("image/")) {
         int32_t width;
         int32_t height;
-        if (!msg->findInt32("width", &width) || !msg->findInt32("height", &height)) {
+        if (!msg->findInt32(FormatKeys::kWidth, &width)
+                || !msg->findInt32(FormatKeys::kHeight, &height)) {
             ALOGV("did not find width and/or height");
             return BAD_VALUE;
         }
@@ -1855,8 +1768,8 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
 
         int32_t sarWidth = -1, sarHeight = -1;
         bool foundWidth, foundHeight;
-        foundWidth = msg->findInt32("sar-width", &sarWidth);
-        foundHeight = msg->findInt32("sar-height", &sarHeight);
+        foundWidth = msg->findInt32(FormatKeys::kSarWidth, &sarWidth);
+        foundHeight = msg->findInt32(FormatKeys::kSarHeight, &sarHeight);
         if (foundWidth || foundHeight) {
             if (sarWidth <= 0 || sarHeight <= 0) {
                 ALOGE("Invalid value of sarWidth: %d and/or sarHeight: %d", sarWidth, sarHeight);
@@ -1867,8 +1780,8 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         }
 
         int32_t displayWidth = -1, displayHeight = -1;
-        foundWidth = msg->findInt32("display-width", &displayWidth);
-        foundHeight = msg->findInt32("display-height", &displayHeight);
+        foundWidth = msg->findInt32(FormatKeys::kDisplayWidth, &displayWidth);
+        foundHeight = msg->findInt32(FormatKeys::kDisplayHeight, &displayHeight);
         if (foundWidth || foundHeight) {
             if (displayWidth <= 0 || displayHeight <= 0) {
                 ALOGE("Invalid value of displayWidth: %d and/or displayHeight: %d",
@@ -1881,12 +1794,12 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
 
         if (mime.startsWith("image/")){
             int32_t isPrimary;
-            if (msg->findInt32("is-default", &isPrimary) && isPrimary) {
+            if (msg->findInt32(FormatKeys::kIsDefault, &isPrimary) && isPrimary) {
                 meta->setInt32(kKeyTrackIsDefault, 1);
             }
             int32_t tileWidth = -1, tileHeight = -1;
-            foundWidth = msg->findInt32("tile-width", &tileWidth);
-            foundHeight = msg->findInt32("tile-height", &tileHeight);
+            foundWidth = msg->findInt32(FormatKeys::kTileWidth, &tileWidth);
+            foundHeight = msg->findInt32(FormatKeys::kTileHeight, &tileHeight);
             if (foundWidth || foundHeight) {
                 if (tileWidth <= 0 || tileHeight <= 0) {
                     ALOGE("Invalid value of tileWidth: %d and/or tileHeight: %d",
@@ -1898,8 +1811,8 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
             }
             int32_t gridRows = -1, gridCols = -1;
             bool foundRows, foundCols;
-            foundRows = msg->findInt32("grid-rows", &gridRows);
-            foundCols = msg->findInt32("grid-cols", &gridCols);
+            foundRows = msg->findInt32(FormatKeys::kGridRows, &gridRows);
+            foundCols = msg->findInt32(FormatKeys::kGridCols, &gridCols);
             if (foundRows || foundCols) {
                 if (gridRows <= 0 || gridCols <= 0) {
                     ALOGE("Invalid value of gridRows: %d and/or gridCols: %d",
@@ -1912,7 +1825,7 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         }
 
         int32_t colorFormat;
-        if (msg->findInt32("color-format", &colorFormat)) {
+        if (msg->findInt32(FormatKeys::kColorFormat, &colorFormat)) {
             meta->setInt32(kKeyColorFormat, colorFormat);
         }
 
@@ -1934,7 +1847,7 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         }
 
         int32_t rotationDegrees;
-        if (msg->findInt32("rotation-degrees", &rotationDegrees)) {
+        if (msg->findInt32(FormatKeys::kRotationDegrees, &rotationDegrees)) {
             meta->setInt32(kKeyRotation, rotationDegrees);
         }
 
@@ -1946,7 +1859,7 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         }
 
         sp<ABuffer> hdr10PlusInfo;
-        if (msg->findBuffer("hdr10-plus-info", &hdr10PlusInfo)) {
+        if (msg->findBuffer(FormatKeys::kHdr10PlusInfo, &hdr10PlusInfo)) {
             meta->setData(kKeyHdr10PlusInfo, 0,
                     hdr10PlusInfo->data(), hdr10PlusInfo->size());
         }
@@ -1954,7 +1867,7 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         convertMessageToMetaDataColorAspects(msg, meta);
 
         AString tsSchema;
-        if (msg->findString("ts-schema", &tsSchema)) {
+        if (msg->findString(FormatKeys::kTsSchema, &tsSchema)) {
             unsigned int numLayers = 0;
             unsigned int numBLayers = 0;
             char placeholder;
@@ -1968,8 +1881,8 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         }
     } else if (mime.startsWith("audio/")) {
         int32_t numChannels, sampleRate;
-        if (!msg->findInt32("channel-count", &numChannels) ||
-                !msg->findInt32("sample-rate", &sampleRate)) {
+        if (!msg->findInt32(FormatKeys::kChannelCount, &numChannels) ||
+                !msg->findInt32(FormatKeys::kSampleRate, &sampleRate)) {
             ALOGV("did not find channel-count and/or sample-rate");
             return BAD_VALUE;
         }
@@ -1981,82 +1894,24 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         }
         meta->setInt32(kKeyChannelCount, numChannels);
         meta->setInt32(kKeySampleRate, sampleRate);
-        int32_t bitsPerSample;
         // TODO:(b/204430952) add appropriate bound check for bitsPerSample
-        if (msg->findInt32("bits-per-sample", &bitsPerSample)) {
-            meta->setInt32(kKeyBitsPerSample, bitsPerSample);
-        }
-        int32_t channelMask;
-        if (msg->findInt32("channel-mask", &channelMask)) {
-            meta->setInt32(kKeyChannelMask, channelMask);
-        }
-        int32_t delay = 0;
-        if (msg->findInt32("encoder-delay", &delay)) {
-            meta->setInt32(kKeyEncoderDelay, delay);
-        }
-        int32_t padding = 0;
-        if (msg->findInt32("encoder-padding", &padding)) {
-            meta->setInt32(kKeyEncoderPadding, padding);
-        }
-
-        int32_t isADTS;
-        if (msg->findInt32("is-adts", &isADTS)) {
-            meta->setInt32(kKeyIsADTS, isADTS);
-        }
+        copyInt32Mappings(msg, kAudioInt32Mappings, meta.get());
 
-        int32_t mpeghProfileLevelIndication = -1;
-        if (msg->findInt32(AMEDIAFORMAT_KEY_MPEGH_PROFILE_LEVEL_INDICATION,
-                &mpeghProfileLevelIndication)) {
-            meta->setInt32(kKeyMpeghProfileLevelIndication, mpeghProfileLevelIndication);
-        }
-        int32_t mpeghReferenceChannelLayout = -1;
-        if (msg->findInt32(AMEDIAFORMAT_KEY_MPEGH_REFERENCE_CHANNEL_LAYOUT,
-                &mpeghReferenceChannelLayout)) {
-            meta->setInt32(kKeyMpeghReferenceChannelLayout, mpeghReferenceChannelLayout);
-        }
         sp<ABuffer> mpeghCompatibleSets;
         if (msg->findBuffer(AMEDIAFORMAT_KEY_MPEGH_COMPATIBLE_SETS,
                 &mpeghCompatibleSets)) {
             meta->setData(kKeyMpeghCompatibleSets, kTypeHCOS,
                     mpeghCompatibleSets->data(), mpeghCompatibleSets->size());
         }
-
-        int32_t aacProfile = -1;
-        if (msg->findInt32("aac-profile", &aacProfile)) {
-            meta->setInt32(kKeyAACAOT, aacProfile);
-        }
-
-        int32_t pcmEncoding;
-        if (msg->findInt32("pcm-encoding", &pcmEncoding)) {
-            meta->setInt32(kKeyPcmEncoding, pcmEncoding);
-        }
-
-        int32_t hapticChannelCount;
-        if (msg->findInt32("haptic-channel-count", &hapticChannelCount)) {
-            meta->setInt32(kKeyHapticChannelCount, hapticChannelCount);
-        }
     }
 
-    int32_t maxInputSize;
-    if (msg->findInt32("max-input-size", &maxInputSize)) {
-        meta->setInt32(kKeyMaxInputSize, maxInputSize);
-    }
-
-    int32_t maxWidth;
-    if (msg->findInt32("max-width", &maxWidth)) {
-        meta->setInt32(kKeyMaxWidth, maxWidth);
-    }
-
-    int32_t maxHeight;
-    if (msg->findInt32("max-height", &maxHeight)) {
-        meta->setInt32(kKeyMaxHeight, maxHeight);
-    }
+    copyInt32Mappings(msg, kTrailingInt32Mappings, meta.get());
 
     int32_t fps;
     float fpsFloat;
-    if (msg->findInt32("frame-rate", &fps) && fps > 0) {
+    if (msg->findInt32(FormatKeys::kFrameRate, &fps) && fps > 0) {
         meta->setInt32(kKeyFrameRate, fps);
-    } else if (msg->findFloat("frame-rate", &fpsFloat)
+    } else if (msg->findFloat(FormatKeys::kFrameRate, &fpsFloat)
             && fpsFloat >= 1 && fpsFloat <= (float)INT32_MAX) {
         // truncate values to distinguish between e.g. 24 vs 23.976 fps
         meta->setInt32(kKeyFrameRate, (int32_t)fpsFloat);
@@ -2064,11 +1919,11 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
 
     // reassemble the csd data into its original form
     sp<ABuffer> csd0, csd1, csd2;
-    if (msg->findBuffer("csd-0", &csd0)) {
+    if (msg->findBuffer(FormatKeys::kCsd0, &csd0)) {
         int csd0size = csd0->size();
         if (mime == MEDIA_MIMETYPE_VIDEO_AVC) {
             sp<ABuffer> csd1;
-            if (msg->findBuffer("csd-1", &csd1)) {
+            if (msg->findBuffer(FormatKeys::kCsd1, &csd1)) {
                 std::vector<char> avcc(csd0size + csd1->size() + 1024);
                 size_t outsize = reassembleAVCC(csd0, csd1, avcc.data());
                 meta->setData(kKeyAVCC, kTypeAVCC, avcc.data(), outsize);
@@ -2105,18 +1960,18 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
             const ALookup<uint8_t, int32_t> &levels =
                 getDolbyVisionLevelsTable();
 
-            if (!msg->findBuffer("csd-2", &csd2)) {
+            if (!msg->findBuffer(FormatKeys::kCsd2, &csd2)) {
                 // MP4 extractors are expected to generate csd buffer
                 // some encoders might not be generating it, in which
                 // case we populate the track metadata dv (cc|vc|wc)
                 // from the 'profile' and 'level' info.
                 // This is done according to Dolby Vision ISOBMFF spec
 
-                if (!msg->findInt32("profile", &profile)) {
+                if (!msg->findInt32(FormatKeys::kProfile, &profile)) {
                     ALOGE("Dolby Vision profile not found");
                     return BAD_VALUE;
                 }
-                msg->findInt32("level", &level);
+                msg->findInt32(FormatKeys::kLevel, &level);
 
                 if (profile == DolbyVisionProfileDvheSt) {
                     if (!profiles.rlookup(DolbyVisionProfileDvheSt, &profileVal)) { // dvhe.08
@@ -2196,7 +2051,7 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
                 meta->setData(kKeyAV1C, 0, csd0->data(), csd0->size());
             } else {
                 sp<ABuffer> csd1;
-                if (msg->findBuffer("csd-1", &csd1)) {
+                if (msg->findBuffer(FormatKeys::kCsd1, &csd1)) {
                     std::vector<char> avcc(csd0size + csd1->size() + 1024);
                     size_t outsize = reassembleAVCC(csd0, csd1, avcc.data());
                     meta->setData(kKeyAVCC, kTypeAVCC, avcc.data(), outsize);
@@ -2243,11 +2098,11 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
             void *opusHeadBuf = csd0->data();
             void *codecDelayBuf = NULL;
             void *seekPreRollBuf = NULL;
-            if (msg->findBuffer("csd-1", &csd1)) {
+            if (msg->findBuffer(FormatKeys::kCsd1, &csd1)) {
                 codecDelayBufSize = csd1->size();
                 codecDelayBuf = csd1->data();
             }
-            if (msg->findBuffer("csd-2", &csd2)) {
+            if (msg->findBuffer(FormatKeys::kCsd2, &csd2)) {
                 seekPreRollBufSize = csd2->size();
                 seekPreRollBuf = csd2->data();
             }
@@ -2269,26 +2124,27 @@ status_t convertMessageToMetaData(const sp<AMessage> &msg, sp<MetaData> &meta) {
         } else if (mime == MEDIA_MIMETYPE_AUDIO_ALAC) {
             meta->setData(kKeyAlacMagicCookie, 0, csd0->data(), csd0->size());
         }
-    } else if (mime == MEDIA_MIMETYPE_VIDEO_AVC && msg->findBuffer("csd-avc", &csd0)) {
+    } else if (mime == MEDIA_MIMETYPE_VIDEO_AVC && msg->findBuffer(FormatKeys::kCsdAvc, &csd0)) {
         meta->setData(kKeyAVCC, kTypeAVCC, csd0->data(), csd0->size());
     } else if ((mime == MEDIA_MIMETYPE_VIDEO_HEVC || mime == MEDIA_MIMETYPE_IMAGE_ANDROID_HEIC)
-            && msg->findBuffer("csd-hevc", &csd0)) {
+            && msg->findBuffer(FormatKeys::kCsdHevc, &csd0)) {
         meta->setData(kKeyHVCC, kTypeHVCC, csd0->data(), csd0->size());
-    } else if (msg->findBuffer("esds", &csd0)) {
+    } else if (msg->findBuffer(FormatKeys::kEsds, &csd0)) {
         meta->setData(kKeyESDS, kTypeESDS, csd0->data(), csd0->size());
-    } else if (msg->findBuffer("mpeg2-stream-header", &csd0)) {
+    } else if (msg->findBuffer(FormatKeys::kMpeg2StreamHeader, &csd0)) {
         meta->setData(kKeyStreamHeader, 'mdat', csd0->data(), csd0->size());
-    } else if (msg->findBuffer("d263", &csd0)) {
+    } else if (msg->findBuffer(FormatKeys::kD263, &csd0)) {
         meta->setData(kKeyD263, kTypeD263, csd0->data(), csd0->size());
-    } else if (mime == MEDIA_MIMETYPE_VIDEO_DOLBY_VISION && msg->findBuffer("csd-2", &csd2)) {
+    } else if (mime == MEDIA_MIMETYPE_VIDEO_DOLBY_VISION
+            && msg->findBuffer(FormatKeys::kCsd2, &csd2)) {
         meta->setData(kKeyDVCC, kTypeDVCC, csd2->data(), csd2->size());
 
         // Remove CSD-2 from the data here to avoid duplicate data in meta
         meta->remove(kKeyOpaqueCSD2);
 
-        if (msg->findBuffer("csd-avc", &csd0)) {
+        if (msg->findBuffer(FormatKeys::kCsdAvc, &csd0)) {
             meta->setData(kKeyAVCC, kTypeAVCC, csd0->data(), csd0->size());
-        } else if (msg->findBuffer("csd-hevc", &csd0)) {
+        } else if (msg->findBuffer(FormatKeys::kCsdHevc, &csd0)) {
             meta->setData(kKeyHVCC, kTypeHVCC, csd0->data(), csd0->size());
         }
     }
@@ -1741,14 +1741,10 @@ status_t PlaylistFetcher::extractAndQueueAccessUnitsFromTs(const sp<ABuffer> &bu
     }
 
     size_t offset = 0;
-    while (offset + 188 <= buffer->size()) {
-        status_t err = mTSParser->feedTSPacket(buffer->data() + offset, 188);
+    status_t err = mTSParser->feedTSPackets(buffer->data(), buffer->size(), &offset);
 
-        if (err != OK) {
-            return err;
-        }
-
-        offset += 188;
+    if (err != OK) {
+        return err;
     }
     // setRange to indicate consumed bytes.
     buffer->setRange(buffer->offset() + offset, buffer->size() - offset);
@@ -1810,7 +1806,7 @@ status_t PlaylistFetcher::extractAndQueueAccessUnitsFromTs(const sp<ABuffer> &bu
         }
     }
 
-    status_t err = OK;
+    err = OK;
     for (size_t i = mPacketSources.size(); i > 0;) {
         i--;
         sp<AnotherPacketSource> packetSource = mPacketSources.valueAt(i);
@@ -279,6 +279,11 @@ struct CodecBase : public AHandler, /* static */ ColorUtils {
     virtual void signalRequestIDRFrame() = 0;
     virtual void signalSetParameters(const sp<AMessage> &msg) = 0;
     virtual void signalEndOfInputStream() = 0;
+    /**
+     * The resource manager is reclaiming this codec. Called before the codec
+     * is shut down; codecs may give up other resources they hold.
+     */
+    virtual void signalReclaim() {}
 
     /**
      * Query supported parameters from this instance, and fill |names| with the
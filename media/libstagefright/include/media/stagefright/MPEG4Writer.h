@@ -19,10 +19,12 @@
 #define MPEG4_WRITER_H_
 
 #include <stdio.h>
+#include <sys/uio.h>
 
 #include <media/stagefright/MediaWriter.h>
 #include <utils/List.h>
 #include <utils/threads.h>
+#include <atomic>
 #include <map>
 #include <media/stagefright/foundation/AHandlerReflector.h>
 #include <media/stagefright/foundation/ALooper.h>
@@ -62,6 +64,8 @@ public:
     void write(const void *data, size_t size);
     inline size_t write(const void *ptr, size_t size, size_t nmemb);
     // Write to file system by calling ::write() or post error message to looper on failure.
+    // While a chunk is being written, small writes are staged and go out together with
+    // the next large one, or when the chunk is done.
     void writeOrPostError(int fd, const void *buf, size_t count);
     // Seek in the file by calling ::lseek64() or post error message to looper on failure.
     void seekOrPostError(int fd, off64_t offset, int whence);
@@ -134,6 +138,18 @@ private:
                         std::greater<std::chrono::microseconds>> mWriteDurationPQ;
     const uint8_t kWriteDurationsCount = 5;
 
+    // Staging of small writes (length prefixes, small samples) while writing a chunk.
+    static constexpr size_t kMaxStagedWriteSize = 16 * 1024;
+    static constexpr size_t kWriteStagingCapacity = 256 * 1024;
+    bool mStageWrites;
+    std::vector<uint8_t> mWriteStagingBuffer;
+    // Write syscall statistics for the current file, reported in dump().
+    // Updated on the writer thread and read on the dump thread.
+    std::atomic<uint64_t> mNumWriteCalls;
+    std::atomic<uint64_t> mNumBytesWritten;
+    std::atomic<int64_t> mTotalWriteDurationUs;
+    std::atomic<int64_t> mMaxWriteDurationUs;
+
     sp<ALooper> mLooper;
     sp<AHandlerReflector<MPEG4Writer> > mReflector;
 
@@ -160,6 +176,8 @@ private:
     int64_t estimateFileLevelMetaSize(MetaData *params);
     void writeCachedBoxToFile(const char *type);
     void printWriteDurations();
+    void flushStagedWrites();
+    void writevOrPostError(int fd, const struct iovec *iov, int iovcnt);
 
     struct Chunk {
         Track               *mTrack;        // Owner
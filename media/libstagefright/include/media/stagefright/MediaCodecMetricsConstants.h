@@ -25,6 +25,39 @@ namespace android {
 // NB: These are not yet exposed as public Java API constants.
 inline constexpr char kCodecPixelFormat[] =
         "android.media.mediacodec.pixel-format";
+// number of linear input buffers backed by a newly fetched block
+inline constexpr char kCodecInputBlocksFetched[] =
+        "android.media.mediacodec.input-blocks-fetched";
+// number of linear input buffers backed by a recycled block
+inline constexpr char kCodecInputBlocksRecycled[] =
+        "android.media.mediacodec.input-blocks-recycled";
+// number of pipeline depth adjustments made for a low-latency stream
+inline constexpr char kCodecPipelineDepthAdjustments[] =
+        "android.media.mediacodec.pipeline-depth-adjustments";
+// latest pipeline depth adjustments, as "+<ms> <from>-><to> (<observations>)"
+inline constexpr char kCodecPipelineDepthTrace[] =
+        "android.media.mediacodec.pipeline-depth-trace";
+// median and 90th percentile time, in microseconds, the latest frames spent
+// between the client queueing an input buffer and its work item being sent
+// to the component
+inline constexpr char kCodecFrameQueueingLatencyP50Us[] =
+        "android.media.mediacodec.frame-queueing-latency-p50-us";
+inline constexpr char kCodecFrameQueueingLatencyP90Us[] =
+        "android.media.mediacodec.frame-queueing-latency-p90-us";
+// ... between the work item being sent to the component and returned
+inline constexpr char kCodecFrameProcessingLatencyP50Us[] =
+        "android.media.mediacodec.frame-processing-latency-p50-us";
+inline constexpr char kCodecFrameProcessingLatencyP90Us[] =
+        "android.media.mediacodec.frame-processing-latency-p90-us";
+// ... between the work item being returned and the client rendering or
+// releasing the output buffer
+inline constexpr char kCodecFrameOutputLatencyP50Us[] =
+        "android.media.mediacodec.frame-output-latency-p50-us";
+inline constexpr char kCodecFrameOutputLatencyP90Us[] =
+        "android.media.mediacodec.frame-output-latency-p90-us";
+// whether the component instance was reused from the pool of idle instances
+inline constexpr char kCodecComponentReused[] =
+        "android.media.mediacodec.component-reused";
 
 }
 
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef MEDIA_FORMAT_KEYS_H_
+#define MEDIA_FORMAT_KEYS_H_
+
+#include <media/stagefright/MediaCodecConstants.h>
+#include <media/stagefright/foundation/AMessage.h>
+
+namespace android {
+
+// Format keys that are looked up on every track open and codec configure, with their length
+// and hash computed at build time. Use them with the AMessage::Key overloads.
+namespace FormatKeys {
+
+constexpr AMessage::Key kAacProfile(KEY_AAC_PROFILE);
+constexpr AMessage::Key kBitrate(KEY_BIT_RATE);
+constexpr AMessage::Key kBitsPerSample("bits-per-sample");
+constexpr AMessage::Key kCaPrivateData(KEY_CA_PRIVATE_DATA);
+constexpr AMessage::Key kCaSessionId(KEY_CA_SESSION_ID);
+constexpr AMessage::Key kCaSystemId(KEY_CA_SYSTEM_ID);
+constexpr AMessage::Key kChannelCount(KEY_CHANNEL_COUNT);
+constexpr AMessage::Key kChannelMask(KEY_CHANNEL_MASK);
+constexpr AMessage::Key kColorFormat(KEY_COLOR_FORMAT);
+constexpr AMessage::Key kColorRange(KEY_COLOR_RANGE);
+constexpr AMessage::Key kColorStandard(KEY_COLOR_STANDARD);
+constexpr AMessage::Key kColorTransfer(KEY_COLOR_TRANSFER);
+constexpr AMessage::Key kCsd0("csd-0");
+constexpr AMessage::Key kCsd1("csd-1");
+constexpr AMessage::Key kCsd2("csd-2");
+constexpr AMessage::Key kCsdAvc("csd-avc");
+constexpr AMessage::Key kCsdHevc("csd-hevc");
+constexpr AMessage::Key kD263("d263");
+constexpr AMessage::Key kDisplayHeight("display-height");
+constexpr AMessage::Key kDisplayWidth("display-width");
+constexpr AMessage::Key kDurationUs(KEY_DURATION);
+constexpr AMessage::Key kDvbAudioDescription("dvb-audio-description");
+constexpr AMessage::Key kDvbComponentTag("dvb-component-tag");
+constexpr AMessage::Key kDvbTeletextMagazineNumber("dvb-teletext-magazine-number");
+constexpr AMessage::Key kDvbTeletextPageNumber("dvb-teletext-page-number");
+constexpr AMessage::Key kEncoderDelay("encoder-delay");
+constexpr AMessage::Key kEncoderPadding("encoder-padding");
+constexpr AMessage::Key kEsds("esds");
+constexpr AMessage::Key kFrameRate(KEY_FRAME_RATE);
+constexpr AMessage::Key kGridCols(KEY_GRID_COLUMNS);
+constexpr AMessage::Key kGridRows(KEY_GRID_ROWS);
+constexpr AMessage::Key kHapticChannelCount("haptic-channel-count");
+constexpr AMessage::Key kHdr10PlusInfo(KEY_HDR10_PLUS_INFO);
+constexpr AMessage::Key kHeight(KEY_HEIGHT);
+constexpr AMessage::Key kIsAdts(KEY_IS_ADTS);
+constexpr AMessage::Key kIsDefault(KEY_IS_DEFAULT);
+constexpr AMessage::Key kIsSyncFrame("is-sync-frame");
+constexpr AMessage::Key kLanguage(KEY_LANGUAGE);
+constexpr AMessage::Key kLevel(KEY_LEVEL);
+constexpr AMessage::Key kMaxBitrate(KEY_MAX_BIT_RATE);
+constexpr AMessage::Key kMaxHeight(KEY_MAX_HEIGHT);
+constexpr AMessage::Key kMaxInputSize(KEY_MAX_INPUT_SIZE);
+constexpr AMessage::Key kMaxWidth(KEY_MAX_WIDTH);
+constexpr AMessage::Key kMime(KEY_MIME);
+constexpr AMessage::Key kMpeg2StreamHeader("mpeg2-stream-header");
+constexpr AMessage::Key kPcmEncoding(KEY_PCM_ENCODING);
+constexpr AMessage::Key kProfile(KEY_PROFILE);
+constexpr AMessage::Key kRotationDegrees(KEY_ROTATION);
+constexpr AMessage::Key kSampleRate(KEY_SAMPLE_RATE);
+constexpr AMessage::Key kSarHeight(KEY_PIXEL_ASPECT_RATIO_HEIGHT);
+constexpr AMessage::Key kSarWidth(KEY_PIXEL_ASPECT_RATIO_WIDTH);
+constexpr AMessage::Key kTileHeight(KEY_TILE_HEIGHT);
+constexpr AMessage::Key kTileWidth(KEY_TILE_WIDTH);
+constexpr AMessage::Key kTsSchema(KEY_TEMPORAL_LAYERING);
+constexpr AMessage::Key kWidth(KEY_WIDTH);
+
+}  // namespace FormatKeys
+
+}  // namespace android
+
+#endif  // MEDIA_FORMAT_KEYS_H_
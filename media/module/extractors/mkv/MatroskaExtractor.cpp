@@ -38,13 +38,28 @@
 
 #include <arpa/inet.h>
 #include <inttypes.h>
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 namespace android {
 
 struct DataSourceBaseReader : public mkvparser::IMkvReader {
     explicit DataSourceBaseReader(DataSourceHelper *source)
-        : mSource(source) {
+        : mSource(source),
+          mReadAheadEnabled(true),
+          mCacheOffset(0),
+          mCacheSize(0) {
+    }
+
+    // mkvparser reads element headers a few bytes at a time, and frames
+    // that belong to the same cluster back to back. Small reads are served
+    // from a read-ahead window instead of going to the source every time.
+    // This must be disabled for sources that can still grow.
+    void setReadAheadEnabled(bool enabled) {
+        Mutex::Autolock autoLock(mLock);
+        mReadAheadEnabled = enabled;
+        mCacheSize = 0;
     }
 
     virtual int Read(long long position, long length, unsigned char* buffer) {
@@ -55,6 +70,32 @@ struct DataSourceBaseReader : public mkvparser::IMkvReader {
             return 0;
         }
 
+        Mutex::Autolock autoLock(mLock);
+
+        if (readFromCache_l(position, length, buffer)) {
+            return 0;
+        }
+
+        if (mReadAheadEnabled && length < kReadAheadSize) {
+            if (mCache == nullptr) {
+                mCache.reset(new (std::nothrow) uint8_t[kReadAheadSize]);
+            }
+
+            if (mCache != nullptr) {
+                ssize_t n = mSource->readAt(position, mCache.get(), kReadAheadSize);
+                if (n > 0) {
+                    mCacheOffset = position;
+                    mCacheSize = n;
+                } else {
+                    mCacheSize = 0;
+                }
+
+                if (readFromCache_l(position, length, buffer)) {
+                    return 0;
+                }
+            }
+        }
+
         ssize_t n = mSource->readAt(position, buffer, length);
 
         if (n <= 0) {
@@ -89,8 +130,29 @@ struct DataSourceBaseReader : public mkvparser::IMkvReader {
     }
 
 private:
+    enum {
+        kReadAheadSize = 128 * 1024,
+    };
+
     DataSourceHelper *mSource;
 
+    Mutex mLock;
+    bool mReadAheadEnabled;
+    std::unique_ptr<uint8_t[]> mCache;
+    long long mCacheOffset;
+    size_t mCacheSize;
+
+    bool readFromCache_l(long long position, long length, unsigned char *buffer) {
+        if (mCacheSize == 0
+                || position < mCacheOffset
+                || position + length > mCacheOffset + (long long)mCacheSize) {
+            return false;
+        }
+
+        memcpy(buffer, mCache.get() + (position - mCacheOffset), length);
+        return true;
+    }
+
     DataSourceBaseReader(const DataSourceBaseReader &);
     DataSourceBaseReader &operator=(const DataSourceBaseReader &);
 };
@@ -98,6 +160,10 @@ private:
 ////////////////////////////////////////////////////////////////////////////////
 
 struct BlockIterator {
+    // Walking blocks from a cue point to the seek time is only done up to
+    // this distance, beyond that only cluster headers are walked.
+    static const long long kMaxCueWalkNs = 5000000000ll;
+
     BlockIterator(MatroskaExtractor *extractor, unsigned long trackNum, unsigned long index);
 
     bool eos() const;
@@ -123,6 +189,7 @@ private:
 
     unsigned long mTrackType;
     void seekwithoutcue_l(int64_t seekTimeUs, int64_t *actualFrameTimeUs);
+    void loadClustersUpTo_l(long long timeNs);
 
     void advance_l();
 
@@ -552,6 +619,30 @@ void BlockIterator::seek(
     CHECK_GT(pTP->m_block, 0);
     mBlockEntryIndex = pTP->m_block - 1;
 
+    if (thisTrack->GetType() != 1 && !mExtractor->mIsLiveStreaming) {
+        // Tracks other than video walk forward to the seek time, with sparse
+        // cues that can be many clusters. Skip ahead over cluster headers,
+        // starting at the cue point, to the cluster covering the seek time
+        // instead of walking every block in between.
+        const long long clusterSeekTimeNs = std::min<long long>(seekTimeNs, seekTimeUs * 1000ll);
+        if (clusterSeekTimeNs - mCluster->GetTime() > kMaxCueWalkNs) {
+            const mkvparser::Cluster *cluster = mCluster;
+            for (;;) {
+                const mkvparser::Cluster *next = pSegment->GetNext(cluster);
+                if (next == NULL || next->EOS() || next->GetTime() > clusterSeekTimeNs) {
+                    break;
+                }
+                cluster = next;
+            }
+            if (cluster != mCluster) {
+                ALOGV("skipping %lld ns of clusters after the cue point",
+                      cluster->GetTime() - mCluster->GetTime());
+                mCluster = cluster;
+                mBlockEntryIndex = 0;
+            }
+        }
+    }
+
     for (;;) {
         advance_l();
 
@@ -583,7 +674,32 @@ int64_t BlockIterator::blockTimeUs() const {
     return (mBlockEntry->GetBlock()->GetTime(mCluster) + 500ll) / 1000ll;
 }
 
+void BlockIterator::loadClustersUpTo_l(long long timeNs) {
+    if (mExtractor->mIsLiveStreaming) {
+        return;
+    }
+
+    // Segment::FindCluster() binary searches the clusters that have been
+    // loaded so far. Loading a cluster only parses its header, which is a lot
+    // cheaper than walking the blocks of every cluster in between.
+    mkvparser::Segment *segment = mExtractor->mSegment;
+    for (;;) {
+        const mkvparser::Cluster *last = segment->GetLast();
+        if (last != NULL && !last->EOS() && last->GetTime() >= timeNs) {
+            break;
+        }
+
+        long long pos;
+        long len;
+        if (segment->LoadCluster(pos, len) != 0) {
+            // Done, or the data isn't available.
+            break;
+        }
+    }
+}
+
 void BlockIterator::seekwithoutcue_l(int64_t seekTimeUs, int64_t *actualFrameTimeUs) {
+    loadClustersUpTo_l(seekTimeUs * 1000ll);
     mCluster = mExtractor->mSegment->FindCluster(seekTimeUs * 1000ll);
     const long status = mCluster->GetFirst(mBlockEntry);
     if (status < 0) {  // error
@@ -1344,6 +1460,8 @@ MatroskaExtractor::MatroskaExtractor(DataSourceHelper *source)
                 | DataSourceBase::kIsCachingDataSource))
         && mDataSource->getSize(&size) != OK;
 
+    mReader->setReadAheadEnabled(!mIsLiveStreaming);
+
     mkvparser::EBMLHeader ebmlHeader;
     long long pos;
     if (ebmlHeader.Parse(mReader, pos) < 0) {
@@ -1401,13 +1519,14 @@ MatroskaExtractor::MatroskaExtractor(DataSourceHelper *source)
                 }
             }
 
+            // Without cues, the remaining clusters are loaded on demand
+            // when seeking, see BlockIterator::loadClustersUpTo_l().
+            long len;
+            ret = mSegment->LoadCluster(pos, len);
             if (mCues) {
-                long len;
-                ret = mSegment->LoadCluster(pos, len);
                 ALOGV("has Cue data, Cluster num=%ld", mSegment->GetCount());
-            } else  {
-                long status_Load = mSegment->Load();
-                ALOGW("no Cue data,Segment Load status:%ld",status_Load);
+            } else {
+                ALOGW("no Cue data, clusters will be loaded on demand");
             }
         } else if (ret > 0) {
             ret = mkvparser::E_BUFFER_NOT_FULL;
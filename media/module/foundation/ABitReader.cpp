@@ -16,6 +16,8 @@
 
 #include "ABitReader.h"
 
+#include <string.h>
+
 #include <media/stagefright/foundation/ADebug.h>
 
 namespace android {
@@ -31,15 +33,37 @@ ABitReader::ABitReader(const uint8_t *data, size_t size)
 ABitReader::~ABitReader() {
 }
 
+static inline uint64_t loadBigEndian64(const uint8_t *data) {
+    uint64_t x;
+    memcpy(&x, data, sizeof(x));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+// Returns nonzero iff any byte of |x| is zero.
+static inline uint64_t hasZeroByte(uint64_t x) {
+    return (x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull;
+}
+
 bool ABitReader::fillReservoir() {
     if (mSize == 0) {
         mOverRead = true;
         return false;
     }
 
+    if (mSize >= 8) {
+        mReservoir = loadBigEndian64(mData);
+        mData += 8;
+        mSize -= 8;
+        mNumBitsLeft = 64;
+        return true;
+    }
+
     mReservoir = 0;
     size_t i;
-    for (i = 0; mSize > 0 && i < 4; ++i) {
+    for (i = 0; mSize > 0 && i < 8; ++i) {
         mReservoir = (mReservoir << 8) | *mData;
 
         ++mData;
@@ -47,7 +71,7 @@ bool ABitReader::fillReservoir() {
     }
 
     mNumBitsLeft = 8 * i;
-    mReservoir <<= 32 - mNumBitsLeft;
+    mReservoir <<= 64 - mNumBitsLeft;
     return true;
 }
 
@@ -68,12 +92,22 @@ bool ABitReader::getBitsGraceful(size_t n, uint32_t *out) {
         return false;
     }
 
-    uint32_t result = 0;
+    if (n <= mNumBitsLeft) {
+        // All bits are in the reservoir. Shifting by 63 - n and then by 1 avoids a separate
+        // branch for n == 0.
+        *out = (uint32_t)((mReservoir >> (63 - n)) >> 1);
+        mReservoir <<= n;
+        mNumBitsLeft -= n;
+        return true;
+    }
+
+    uint64_t result = 0;
     while (n > 0) {
         if (mNumBitsLeft == 0) {
             if (!fillReservoir()) {
                 return false;
             }
+            continue;
         }
 
         size_t m = n;
@@ -81,32 +115,58 @@ bool ABitReader::getBitsGraceful(size_t n, uint32_t *out) {
             m = mNumBitsLeft;
         }
 
-        result = (result << m) | (mReservoir >> (32 - m));
+        result = (result << m) | (mReservoir >> (64 - m));
         mReservoir <<= m;
         mNumBitsLeft -= m;
 
         n -= m;
     }
 
-    *out = result;
+    *out = (uint32_t)result;
     return true;
 }
 
 bool ABitReader::skipBits(size_t n) {
-    uint32_t dummy;
-    while (n > 32) {
-        if (!getBitsGraceful(32, &dummy)) {
+    // Drop whole reservoirs; fillReservoir() takes care of emulation prevention in subclasses.
+    while (n > mNumBitsLeft) {
+        n -= mNumBitsLeft;
+        mReservoir = 0;
+        mNumBitsLeft = 0;
+        if (!fillReservoir()) {
             return false;
         }
-        n -= 32;
     }
 
-    if (n > 0) {
-        return getBitsGraceful(n, &dummy);
-    }
+    mReservoir = n < 64 ? mReservoir << n : 0;
+    mNumBitsLeft -= n;
     return true;
 }
 
+bool ABitReader::getLeadingZeroBits(size_t *numZeros) {
+    size_t n = 0;
+    for (;;) {
+        if (mNumBitsLeft == 0 && !fillReservoir()) {
+            *numZeros = n;
+            return false;
+        }
+
+        // Bits below the reservoir's valid range may be set after putBits(), so a 1 bit only
+        // counts if it lies within the top mNumBitsLeft bits.
+        size_t zeros = mReservoir == 0 ? 64 : __builtin_clzll(mReservoir);
+        if (zeros < mNumBitsLeft) {
+            *numZeros = n + zeros;
+            // consume the zeros and the 1 bit; zeros + 1 <= 64
+            mReservoir = zeros + 1 < 64 ? mReservoir << (zeros + 1) : 0;
+            mNumBitsLeft -= zeros + 1;
+            return true;
+        }
+
+        n += mNumBitsLeft;
+        mReservoir = 0;
+        mNumBitsLeft = 0;
+    }
+}
+
 void ABitReader::putBits(uint32_t x, size_t n) {
     if (mOverRead) {
         return;
@@ -114,14 +174,16 @@ void ABitReader::putBits(uint32_t x, size_t n) {
 
     CHECK_LE(n, 32u);
 
-    while (mNumBitsLeft + n > 32) {
+    while (mNumBitsLeft + n > 64) {
         mNumBitsLeft -= 8;
         --mData;
         ++mSize;
     }
 
-    mReservoir = (mReservoir >> n) | (x << (32 - n));
-    mNumBitsLeft += n;
+    if (n > 0) {
+        mReservoir = (mReservoir >> n) | ((uint64_t)x << (64 - n));
+        mNumBitsLeft += n;
+    }
 }
 
 size_t ABitReader::numBitsLeft() const {
@@ -175,9 +237,23 @@ bool NALBitReader::fillReservoir() {
         return false;
     }
 
+    if (mSize >= 8) {
+        // Without 0x00 bytes there is no emulation_prevention_three_byte among the next 8
+        // bytes, except for a leading 0x03 that follows two zeros from the previous fill.
+        uint64_t x = loadBigEndian64(mData);
+        if (!hasZeroByte(x) && !(mNumZeros >= 2 && mData[0] == 3)) {
+            mReservoir = x;
+            mData += 8;
+            mSize -= 8;
+            mNumBitsLeft = 64;
+            mNumZeros = 0;
+            return true;
+        }
+    }
+
     mReservoir = 0;
     size_t i = 0;
-    while (mSize > 0 && i < 4) {
+    while (mSize > 0 && i < 8) {
         bool isEmulationPreventionByte = (mNumZeros >= 2 && *mData == 3);
 
         if (*mData == 0) {
@@ -197,7 +273,7 @@ bool NALBitReader::fillReservoir() {
     }
 
     mNumBitsLeft = 8 * i;
-    mReservoir <<= 32 - mNumBitsLeft;
+    mReservoir = mNumBitsLeft == 0 ? 0 : mReservoir << (64 - mNumBitsLeft);
     return true;
 }
 
@@ -25,7 +25,8 @@ namespace android {
 ABuffer::ABuffer(size_t capacity)
     : mRangeOffset(0),
       mInt32Data(0),
-      mOwnsData(true) {
+      mOwnsData(true),
+      mNumSlices(0) {
     mData = malloc(capacity);
     if (mData == NULL) {
         mCapacity = 0;
@@ -42,7 +43,8 @@ ABuffer::ABuffer(void *data, size_t capacity)
       mRangeOffset(0),
       mRangeLength(capacity),
       mInt32Data(0),
-      mOwnsData(false) {
+      mOwnsData(false),
+      mNumSlices(0) {
 }
 
 // static
@@ -63,6 +65,24 @@ ABuffer::~ABuffer() {
             mData = NULL;
         }
     }
+    if (mParent != NULL) {
+        mParent->mNumSlices.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+sp<ABuffer> ABuffer::slice(size_t offset, size_t size) {
+    CHECK_LE(offset, mRangeLength);
+    CHECK_LE(size, mRangeLength - offset);
+
+    sp<ABuffer> res = new ABuffer(data() + offset, size);
+    // slices of slices refer to the owner directly
+    res->mParent = mParent != NULL ? mParent : this;
+    res->mParent->mNumSlices.fetch_add(1, std::memory_order_relaxed);
+    return res;
+}
+
+bool ABuffer::hasSlices() const {
+    return mNumSlices.load(std::memory_order_acquire) > 0;
 }
 
 void ABuffer::setRange(size_t offset, size_t size) {
@@ -23,6 +23,8 @@
 
 #include <sys/time.h>
 
+#include <algorithm>
+
 #include "ALooper.h"
 
 #include "AHandler.h"
@@ -74,7 +76,8 @@ int64_t ALooper::getNowUs() {
 }
 
 ALooper::ALooper()
-    : mRunningLocally(false) {
+    : mNextEventSeq(0),
+      mRunningLocally(false) {
     // clean up stale AHandlers. Doing it here instead of in the destructor avoids
     // the side effect of objects being deleted from the unregister function recursively.
     gLooperRoster.unregisterStaleHandlers();
@@ -181,21 +184,25 @@ void ALooper::post(const sp<AMessage> &msg, int64_t delayUs) {
         whenUs = getNowUs();
     }
 
-    List<Event>::iterator it = mEventQueue.begin();
-    while (it != mEventQueue.end() && (*it).mWhenUs <= whenUs) {
-        ++it;
+    if (queueEvent_l(whenUs, msg, nullptr)) {
+        mQueueChangedCondition.signal();
     }
+}
 
+bool ALooper::queueEvent_l(int64_t whenUs, const sp<AMessage> &msg, const sp<RefBase> &token) {
     Event event;
     event.mWhenUs = whenUs;
+    event.mSeq = mNextEventSeq++;
     event.mMessage = msg;
-    event.mToken = nullptr;
+    event.mToken = token;
 
-    if (it == mEventQueue.begin()) {
-        mQueueChangedCondition.signal();
-    }
+    const uint64_t seq = event.mSeq;
+    mEventQueue.push_back(std::move(event));
+    std::push_heap(mEventQueue.begin(), mEventQueue.end(), EventAfter());
 
-    mEventQueue.insert(it, event);
+    // Sequence numbers are unique, so the new event is at the front iff it is
+    // earlier than everything else.
+    return mEventQueue.front().mSeq == seq;
 }
 
 status_t ALooper::postUnique(const sp<AMessage> &msg, const sp<RefBase> &token, int64_t delayUs) {
@@ -215,28 +222,17 @@ status_t ALooper::postUnique(const sp<AMessage> &msg, const sp<RefBase> &token,
     // We only need to wake the loop up if we're rescheduling to the earliest event in the queue.
     // This needs to be checked now, before we reschedule the message, in case this message is
     // already at the beginning of the queue.
-    bool shouldAwakeLoop = mEventQueue.empty() || whenUs < mEventQueue.begin()->mWhenUs;
+    bool shouldAwakeLoop = mEventQueue.empty() || whenUs < mEventQueue.front().mWhenUs;
 
     // Erase any previously-posted event with this token.
-    for (auto i = mEventQueue.begin(); i != mEventQueue.end();) {
-        if (i->mToken == token) {
-            i = mEventQueue.erase(i);
-        } else {
-            ++i;
-        }
+    auto end = std::remove_if(mEventQueue.begin(), mEventQueue.end(),
+            [&token](const Event &event) { return event.mToken == token; });
+    if (end != mEventQueue.end()) {
+        mEventQueue.erase(end, mEventQueue.end());
+        std::make_heap(mEventQueue.begin(), mEventQueue.end(), EventAfter());
     }
 
-    // Find the insertion point for the rescheduled message.
-    List<Event>::iterator i = mEventQueue.begin();
-    while (i != mEventQueue.end() && i->mWhenUs <= whenUs) {
-        ++i;
-    }
-
-    Event event;
-    event.mWhenUs = whenUs;
-    event.mMessage = msg;
-    event.mToken = token;
-    mEventQueue.insert(i, event);
+    queueEvent_l(whenUs, msg, token);
 
     // If we rescheduled the event to be earlier than the first event, then we need to wake up the
     // looper earlier than it was previously scheduled to be woken up. Otherwise, it can sleep until
@@ -260,7 +256,7 @@ bool ALooper::loop() {
             mQueueChangedCondition.wait(mLock);
             return true;
         }
-        int64_t whenUs = (*mEventQueue.begin()).mWhenUs;
+        int64_t whenUs = mEventQueue.front().mWhenUs;
         int64_t nowUs = getNowUs();
 
         if (whenUs > nowUs) {
@@ -273,8 +269,9 @@ bool ALooper::loop() {
             return true;
         }
 
-        event = *mEventQueue.begin();
-        mEventQueue.erase(mEventQueue.begin());
+        std::pop_heap(mEventQueue.begin(), mEventQueue.end(), EventAfter());
+        event = std::move(mEventQueue.back());
+        mEventQueue.pop_back();
     }
 
     event.mMessage->deliver();
@@ -32,13 +32,13 @@ namespace android {
 static bool verboseStats = false;
 
 ALooperRoster::ALooperRoster()
-    : mNextHandlerID(1) {
+    : mNextHandlerID(1),
+      mNextStaleShard(0) {
 }
 
 ALooper::handler_id ALooperRoster::registerHandler(
         const sp<ALooper> &looper, const sp<AHandler> &handler) {
-    Mutex::Autolock autoLock(mLock);
-
+    Mutex::Autolock registrationLock(mRegistrationLock);
     if (handler->id() != 0) {
         CHECK(!"A handler must only be registered once.");
         return INVALID_OPERATION;
@@ -47,8 +47,11 @@ ALooper::handler_id ALooperRoster::registerHandler(
     HandlerInfo info;
     info.mLooper = looper;
     info.mHandler = handler;
-    ALooper::handler_id handlerID = mNextHandlerID++;
-    mHandlers.add(handlerID, info);
+    ALooper::handler_id handlerID = mNextHandlerID.fetch_add(1, std::memory_order_relaxed);
+
+    Shard &shard = shardFor(handlerID);
+    Mutex::Autolock autoLock(shard.mLock);
+    shard.mHandlers.add(handlerID, info);
 
     handler->setID(handlerID, looper);
 
@@ -56,15 +59,17 @@ ALooper::handler_id ALooperRoster::registerHandler(
 }
 
 void ALooperRoster::unregisterHandler(ALooper::handler_id handlerID) {
-    Mutex::Autolock autoLock(mLock);
+    Mutex::Autolock registrationLock(mRegistrationLock);
+    Shard &shard = shardFor(handlerID);
+    Mutex::Autolock autoLock(shard.mLock);
 
-    ssize_t index = mHandlers.indexOfKey(handlerID);
+    ssize_t index = shard.mHandlers.indexOfKey(handlerID);
 
     if (index < 0) {
         return;
     }
 
-    const HandlerInfo &info = mHandlers.valueAt(index);
+    const HandlerInfo &info = shard.mHandlers.valueAt(index);
 
     sp<AHandler> handler = info.mHandler.promote();
 
@@ -72,23 +77,27 @@ void ALooperRoster::unregisterHandler(ALooper::handler_id handlerID) {
         handler->setID(0, NULL);
     }
 
-    mHandlers.removeItemsAt(index);
+    shard.mHandlers.removeItemsAt(index);
 }
 
 void ALooperRoster::unregisterStaleHandlers() {
+    // This runs whenever an ALooper is created. Sweeping a single shard per call keeps that
+    // cheap and leaves the other shards free for concurrent (un)registration; stale entries
+    // only hold weak references, so collecting them a few looper creations later is fine.
+    Shard &shard = mShards[mNextStaleShard.fetch_add(1, std::memory_order_relaxed) % kNumShards];
 
     Vector<sp<ALooper> > activeLoopers;
     {
-        Mutex::Autolock autoLock(mLock);
+        Mutex::Autolock autoLock(shard.mLock);
 
-        for (size_t i = mHandlers.size(); i > 0;) {
+        for (size_t i = shard.mHandlers.size(); i > 0;) {
             i--;
-            const HandlerInfo &info = mHandlers.valueAt(i);
+            const HandlerInfo &info = shard.mHandlers.valueAt(i);
 
             sp<ALooper> looper = info.mLooper.promote();
             if (looper == NULL) {
-                ALOGV("Unregistering stale handler %d", mHandlers.keyAt(i));
-                mHandlers.removeItemsAt(i);
+                ALOGV("Unregistering stale handler %d", shard.mHandlers.keyAt(i));
+                shard.mHandlers.removeItemsAt(i);
             } else {
                 // At this point 'looper' might be the only sp<> keeping
                 // the object alive. To prevent it from going out of scope
@@ -131,13 +140,21 @@ void ALooperRoster::dump(int fd, const Vector<String16>& args) {
         s.append("(verbose stats collection enabled, stats will be cleared)\n");
     }
 
-    Mutex::Autolock autoLock(mLock);
-    size_t n = mHandlers.size();
+    // Snapshot all shards, in handler id order, so that no shard stays locked while the
+    // handlers are being inspected.
+    KeyedVector<ALooper::handler_id, HandlerInfo> handlers;
+    for (Shard &shard : mShards) {
+        Mutex::Autolock autoLock(shard.mLock);
+        for (size_t i = 0; i < shard.mHandlers.size(); i++) {
+            handlers.add(shard.mHandlers.keyAt(i), shard.mHandlers.valueAt(i));
+        }
+    }
+    size_t n = handlers.size();
     s.appendFormat(" %zu registered handlers:\n", n);
 
     for (size_t i = 0; i < n; i++) {
-        s.appendFormat("  %d: ", mHandlers.keyAt(i));
-        HandlerInfo &info = mHandlers.editValueAt(i);
+        s.appendFormat("  %d: ", handlers.keyAt(i));
+        const HandlerInfo &info = handlers.valueAt(i);
         sp<ALooper> looper = info.mLooper.promote();
         if (looper != NULL) {
             s.append(looper->getName());
@@ -94,6 +94,7 @@ void AMessage::clear() {
         freeItemValue(&item);
     }
     mItems.clear();
+    mItemIndex.clear();
 }
 
 void AMessage::freeItemValue(Item *item) {
@@ -150,20 +151,49 @@ static void reportStats() {
 }
 #endif
 
-inline size_t AMessage::findItemIndex(const char *name, size_t len) const {
+// FNV-1a hash of an item name, cached in Item::mNameHash. Matches AMessage::Key.
+static inline uint32_t hashItemName(const char *name, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+inline size_t AMessage::findItemIndex(const Key &key) const {
 #ifdef DUMP_STATS
     size_t memchecks = 0;
 #endif
-    size_t i = 0;
-    for (; i < mItems.size(); i++) {
-        if (len != mItems[i].mNameLength) {
-            continue;
+    const char *name = key.mName;
+    const size_t len = key.mLength;
+    const uint32_t hash = key.mHash;
+    size_t i = mItems.size();
+    if (!mItemIndex.empty()) {
+        const size_t mask = mItemIndex.size() - 1;
+        for (size_t slot = hash & mask; mItemIndex[slot] != 0; slot = (slot + 1) & mask) {
+            const Item &item = mItems[mItemIndex[slot] - 1];
+            if (item.mNameHash != hash || item.mNameLength != len) {
+                continue;
+            }
+#ifdef DUMP_STATS
+            ++memchecks;
+#endif
+            if (!memcmp(item.mName, name, len)) {
+                i = mItemIndex[slot] - 1;
+                break;
+            }
         }
+    } else {
+        for (i = 0; i < mItems.size(); i++) {
+            if (hash != mItems[i].mNameHash || len != mItems[i].mNameLength) {
+                continue;
+            }
 #ifdef DUMP_STATS
-        ++memchecks;
+            ++memchecks;
 #endif
-        if (!memcmp(mItems[i].mName, name, len)) {
-            break;
+            if (!memcmp(mItems[i].mName, name, len)) {
+                break;
+            }
         }
     }
 #ifdef DUMP_STATS
@@ -179,22 +209,67 @@ inline size_t AMessage::findItemIndex(const char *name, size_t len) const {
     return i;
 }
 
+void AMessage::indexItem(size_t index) {
+    if (mItems.size() < kMinIndexedItems) {
+        return;
+    }
+    // keep the load factor at or below 1/2
+    if (mItemIndex.size() < 2 * mItems.size()) {
+        rebuildItemIndex();
+        return;
+    }
+    const size_t mask = mItemIndex.size() - 1;
+    size_t slot = mItems[index].mNameHash & mask;
+    while (mItemIndex[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    mItemIndex[slot] = index + 1;
+}
+
+void AMessage::rebuildItemIndex() {
+    mItemIndex.clear();
+    if (mItems.size() < kMinIndexedItems) {
+        return;
+    }
+    size_t capacity = 32;
+    while (capacity < 2 * mItems.size()) {
+        capacity <<= 1;
+    }
+    mItemIndex.resize(capacity, 0);
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < mItems.size(); ++i) {
+        size_t slot = mItems[i].mNameHash & mask;
+        while (mItemIndex[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        mItemIndex[slot] = i + 1;
+    }
+}
+
 // assumes item's name was uninitialized or NULL
 void AMessage::Item::setName(const char *name, size_t len) {
     mNameLength = len;
+    mNameHash = hashItemName(name, len);
     mName = new char[len + 1];
     memcpy((void*)mName, name, len + 1);
 }
 
-AMessage::Item::Item(const char *name, size_t len)
+// assumes item's name was uninitialized or NULL
+void AMessage::Item::setName(const Key &key) {
+    mNameLength = key.mLength;
+    mNameHash = key.mHash;
+    mName = new char[key.mLength + 1];
+    memcpy((void*)mName, key.mName, key.mLength + 1);
+}
+
+AMessage::Item::Item(const Key &key)
     : mType(kTypeInt32) {
     // mName and mNameLength are initialized by setName
-    setName(name, len);
+    setName(key);
 }
 
-AMessage::Item *AMessage::allocateItem(const char *name) {
-    size_t len = strlen(name);
-    size_t i = findItemIndex(name, len);
+AMessage::Item *AMessage::allocateItem(const Key &key) {
+    size_t i = findItemIndex(key);
     Item *item;
 
     if (i < mItems.size()) {
@@ -204,7 +279,8 @@ AMessage::Item *AMessage::allocateItem(const char *name) {
         CHECK(mItems.size() < kMaxNumItems);
         i = mItems.size();
         // place a 'blank' item at the end - this is of type kTypeInt32
-        mItems.emplace_back(name, len);
+        mItems.emplace_back(key);
+        indexItem(i);
         item = &mItems[i];
     }
 
@@ -212,8 +288,8 @@ AMessage::Item *AMessage::allocateItem(const char *name) {
 }
 
 const AMessage::Item *AMessage::findItem(
-        const char *name, Type type) const {
-    size_t i = findItemIndex(name, strlen(name));
+        const Key &key, Type type) const {
+    size_t i = findItemIndex(key);
     if (i < mItems.size()) {
         const Item *item = &mItems[i];
         return item->mType == type ? item : NULL;
@@ -223,7 +299,7 @@ const AMessage::Item *AMessage::findItem(
 }
 
 bool AMessage::findAsFloat(const char *name, float *value) const {
-    size_t i = findItemIndex(name, strlen(name));
+    size_t i = findItemIndex(Key(name));
     if (i < mItems.size()) {
         const Item *item = &mItems[i];
         switch (item->mType) {
@@ -250,7 +326,7 @@ bool AMessage::findAsFloat(const char *name, float *value) const {
 }
 
 bool AMessage::findAsInt64(const char *name, int64_t *value) const {
-    size_t i = findItemIndex(name, strlen(name));
+    size_t i = findItemIndex(Key(name));
     if (i < mItems.size()) {
         const Item *item = &mItems[i];
         switch (item->mType) {
@@ -268,13 +344,20 @@ bool AMessage::findAsInt64(const char *name, int64_t *value) const {
 }
 
 bool AMessage::contains(const char *name) const {
-    size_t i = findItemIndex(name, strlen(name));
-    return i < mItems.size();
+    return contains(Key(name));
+}
+
+bool AMessage::contains(const Key &key) const {
+    return findItemIndex(key) < mItems.size();
 }
 
 #define BASIC_TYPE(NAME,FIELDNAME,TYPENAME)                             \
 void AMessage::set##NAME(const char *name, TYPENAME value) {            \
-    Item *item = allocateItem(name);                                    \
+    set##NAME(Key(name), value);                                        \
+}                                                                       \
+                                                                        \
+void AMessage::set##NAME(const Key &key, TYPENAME value) {              \
+    Item *item = allocateItem(key);                                     \
     if (item) {                                                         \
         item->mType = kType##NAME;                                      \
         item->u.FIELDNAME = value;                                      \
@@ -283,7 +366,12 @@ void AMessage::set##NAME(const char *name, TYPENAME value) {            \
                                                                         \
 /* NOLINT added to avoid incorrect warning/fix from clang.tidy */       \
 bool AMessage::find##NAME(const char *name, TYPENAME *value) const {  /* NOLINT */ \
-    const Item *item = findItem(name, kType##NAME);                     \
+    return find##NAME(Key(name), value);                                \
+}                                                                       \
+                                                                        \
+/* NOLINT added to avoid incorrect warning/fix from clang.tidy */       \
+bool AMessage::find##NAME(const Key &key, TYPENAME *value) const {  /* NOLINT */ \
+    const Item *item = findItem(key, kType##NAME);                      \
     if (item) {                                                         \
         *value = item->u.FIELDNAME;                                     \
         return true;                                                    \
@@ -302,7 +390,12 @@ BASIC_TYPE(Pointer,ptrValue,void *)
 
 void AMessage::setString(
         const char *name, const char *s, ssize_t len) {
-    Item *item = allocateItem(name);
+    setString(Key(name), s, len);
+}
+
+void AMessage::setString(
+        const Key &key, const char *s, ssize_t len) {
+    Item *item = allocateItem(key);
     if (item) {
         item->mType = kTypeString;
         item->u.stringValue = new AString(s, len < 0 ? strlen(s) : len);
@@ -311,12 +404,17 @@ void AMessage::setString(
 
 void AMessage::setString(
         const char *name, const AString &s) {
-    setString(name, s.c_str(), s.size());
+    setString(Key(name), s.c_str(), s.size());
+}
+
+void AMessage::setString(
+        const Key &key, const AString &s) {
+    setString(key, s.c_str(), s.size());
 }
 
 void AMessage::setObjectInternal(
-        const char *name, const sp<RefBase> &obj, Type type) {
-    Item *item = allocateItem(name);
+        const Key &key, const sp<RefBase> &obj, Type type) {
+    Item *item = allocateItem(key);
     if (item) {
         item->mType = type;
 
@@ -326,15 +424,19 @@ void AMessage::setObjectInternal(
 }
 
 void AMessage::setObject(const char *name, const sp<RefBase> &obj) {
-    setObjectInternal(name, obj, kTypeObject);
+    setObjectInternal(Key(name), obj, kTypeObject);
 }
 
 void AMessage::setBuffer(const char *name, const sp<ABuffer> &buffer) {
-    setObjectInternal(name, sp<RefBase>(buffer), kTypeBuffer);
+    setObjectInternal(Key(name), sp<RefBase>(buffer), kTypeBuffer);
+}
+
+void AMessage::setBuffer(const Key &key, const sp<ABuffer> &buffer) {
+    setObjectInternal(key, sp<RefBase>(buffer), kTypeBuffer);
 }
 
 void AMessage::setMessage(const char *name, const sp<AMessage> &obj) {
-    Item *item = allocateItem(name);
+    Item *item = allocateItem(Key(name));
     if (item) {
         item->mType = kTypeMessage;
 
@@ -346,7 +448,7 @@ void AMessage::setMessage(const char *name, const sp<AMessage> &obj) {
 void AMessage::setRect(
         const char *name,
         int32_t left, int32_t top, int32_t right, int32_t bottom) {
-    Item *item = allocateItem(name);
+    Item *item = allocateItem(Key(name));
     if (item) {
         item->mType = kTypeRect;
 
@@ -358,7 +460,11 @@ void AMessage::setRect(
 }
 
 bool AMessage::findString(const char *name, AString *value) const {
-    const Item *item = findItem(name, kTypeString);
+    return findString(Key(name), value);
+}
+
+bool AMessage::findString(const Key &key, AString *value) const {
+    const Item *item = findItem(key, kTypeString);
     if (item) {
         *value = *item->u.stringValue;
         return true;
@@ -367,7 +473,7 @@ bool AMessage::findString(const char *name, AString *value) const {
 }
 
 bool AMessage::findObject(const char *name, sp<RefBase> *obj) const {
-    const Item *item = findItem(name, kTypeObject);
+    const Item *item = findItem(Key(name), kTypeObject);
     if (item) {
         *obj = item->u.refValue;
         return true;
@@ -376,7 +482,11 @@ bool AMessage::findObject(const char *name, sp<RefBase> *obj) const {
 }
 
 bool AMessage::findBuffer(const char *name, sp<ABuffer> *buf) const {
-    const Item *item = findItem(name, kTypeBuffer);
+    return findBuffer(Key(name), buf);
+}
+
+bool AMessage::findBuffer(const Key &key, sp<ABuffer> *buf) const {
+    const Item *item = findItem(key, kTypeBuffer);
     if (item) {
         *buf = (ABuffer *)(item->u.refValue);
         return true;
@@ -385,7 +495,7 @@ bool AMessage::findBuffer(const char *name, sp<ABuffer> *buf) const {
 }
 
 bool AMessage::findMessage(const char *name, sp<AMessage> *obj) const {
-    const Item *item = findItem(name, kTypeMessage);
+    const Item *item = findItem(Key(name), kTypeMessage);
     if (item) {
         *obj = static_cast<AMessage *>(item->u.refValue);
         return true;
@@ -396,7 +506,7 @@ bool AMessage::findMessage(const char *name, sp<AMessage> *obj) const {
 bool AMessage::findRect(
         const char *name,
         int32_t *left, int32_t *top, int32_t *right, int32_t *bottom) const {
-    const Item *item = findItem(name, kTypeRect);
+    const Item *item = findItem(Key(name), kTypeRect);
     if (item == NULL) {
         return false;
     }
@@ -491,6 +601,7 @@ bool AMessage::senderAwaitsResponse(sp<AReplyToken> *replyToken) {
 sp<AMessage> AMessage::dup() const {
     sp<AMessage> msg = new AMessage(mWhat, mHandler.promote());
     msg->mItems = mItems;
+    msg->mItemIndex = mItemIndex;
 
 #ifdef DUMP_STATS
     {
@@ -773,6 +884,7 @@ sp<AMessage> AMessage::FromParcel(const Parcel &parcel, size_t maxNestingLevel)
 
         item->setName(name, strlen(name));
     }
+    msg->rebuildItemIndex();
 
     return msg;
 }
@@ -852,7 +964,7 @@ sp<AMessage> AMessage::changesFrom(const sp<const AMessage> &other, bool deep) c
     }
 
     for (const Item &item : mItems) {
-        const Item *oitem = other->findItem(item.mName, item.mType);
+        const Item *oitem = other->findItem(Key(item.mName), item.mType);
         switch (item.mType) {
             case kTypeInt32:
                 if (oitem == NULL || item.u.int32Value != oitem->u.int32Value) {
@@ -1022,13 +1134,14 @@ status_t AMessage::setEntryNameAt(size_t index, const char *name) {
     if (!strcmp(name, mItems[index].mName)) {
         return OK; // name has not changed
     }
-    size_t len = strlen(name);
-    if (findItemIndex(name, len) < mItems.size()) {
+    Key key(name);
+    if (findItemIndex(key) < mItems.size()) {
         return ALREADY_EXISTS;
     }
     delete[] mItems[index].mName;
     mItems[index].mName = nullptr;
-    mItems[index].setName(name, len);
+    mItems[index].setName(key);
+    rebuildItemIndex();
     return OK;
 }
 
@@ -1103,6 +1216,7 @@ status_t AMessage::removeEntryAt(size_t index) {
         mItems[lastIndex].mType = kTypeInt32;
     }
     mItems.pop_back();
+    rebuildItemIndex();
     return OK;
 }
 
@@ -1119,7 +1233,7 @@ status_t AMessage::removeEntryByName(const char *name) {
 
 void AMessage::setItem(const char *name, const ItemData &item) {
     if (item.used()) {
-        Item *it = allocateItem(name);
+        Item *it = allocateItem(Key(name));
         if (it != nullptr) {
             setEntryAt(it - &mItems[0], item);
         }
@@ -1137,7 +1251,7 @@ void AMessage::extend(const sp<AMessage> &other) {
     }
 
     for (size_t ix = 0; ix < other->mItems.size(); ++ix) {
-        Item *it = allocateItem(other->mItems[ix].mName);
+        Item *it = allocateItem(Key(other->mItems[ix].mName));
         if (it != nullptr) {
             ItemData data = other->getEntryAt(ix);
             setEntryAt(it - &mItems[0], data);
@@ -1146,7 +1260,7 @@ void AMessage::extend(const sp<AMessage> &other) {
 }
 
 size_t AMessage::findEntryByName(const char *name) const {
-    return name == nullptr ? countEntries() : findItemIndex(name, strlen(name));
+    return name == nullptr ? countEntries() : findItemIndex(Key(name));
 }
 
 }  // namespace android
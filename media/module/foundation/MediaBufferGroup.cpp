@@ -17,7 +17,8 @@
 #define LOG_TAG "MediaBufferGroup"
 #include <utils/Log.h>
 
-#include <list>
+#include <atomic>
+#include <vector>
 
 #include <binder/MemoryDealer.h>
 #include <media/stagefright/foundation/ADebug.h>
@@ -40,7 +41,23 @@ struct MediaBufferGroup::InternalData {
     Mutex mLock;
     Condition mCondition;
     size_t mGrowthLimit;  // Do not automatically grow group larger than this.
-    std::list<MediaBufferBase *> mBuffers;
+    std::vector<MediaBufferBase *> mBuffers;
+    // Index at which acquire_buffer() starts looking for a free buffer. Buffers are usually
+    // returned in the order they were handed out, so the one after the last acquired buffer
+    // is the most likely to be free.
+    size_t mScanStart = 0;
+    // Number of acquire_buffer() callers blocked on mCondition. Returning a buffer only needs
+    // mLock when this is nonzero.
+    std::atomic<int32_t> mWaiters{0};
+
+    bool hasFreeBuffer_l() const {
+        for (MediaBufferBase *buffer : mBuffers) {
+            if (buffer->refcount() == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 MediaBufferGroup::MediaBufferGroup(size_t growthLimit)
@@ -144,6 +161,7 @@ void MediaBufferGroup::add_buffer(MediaBufferBase *buffer) {
             ++it;
         }
     }
+    mInternal->mScanStart = 0;
 
     buffer->setObserver(this);
     mInternal->mBuffers.emplace_back(buffer);
@@ -169,7 +187,10 @@ status_t MediaBufferGroup::acquire_buffer(
         size_t biggest = requestedSize;
         MediaBufferBase *buffer = nullptr;
         auto free = mInternal->mBuffers.end();
-        for (auto it = mInternal->mBuffers.begin(); it != mInternal->mBuffers.end(); ++it) {
+        const size_t count = mInternal->mBuffers.size();
+        size_t ix = mInternal->mScanStart < count ? mInternal->mScanStart : 0;
+        for (size_t n = 0; n < count; ++n, ix = (ix + 1 == count) ? 0 : ix + 1) {
+            auto it = mInternal->mBuffers.begin() + ix;
             const size_t size = (*it)->size();
             if (size > biggest) {
                 biggest = size;
@@ -177,6 +198,7 @@ status_t MediaBufferGroup::acquire_buffer(
             if ((*it)->refcount() == 0) {
                 if (size >= requestedSize) {
                     buffer = *it;
+                    mInternal->mScanStart = ix + 1;
                     break;
                 }
                 if (size < smallest) {
@@ -221,8 +243,15 @@ status_t MediaBufferGroup::acquire_buffer(
             *out = nullptr;
             return WOULD_BLOCK;
         }
-        // All buffers are in use, block until one of them is returned.
-        mInternal->mCondition.wait(mInternal->mLock);
+        // All buffers are in use, block until one of them is returned. Register as a waiter
+        // before checking once more: a concurrent signalBufferReturned() either sees the
+        // waiter and signals, or returned its buffer early enough for the check to see it.
+        mInternal->mWaiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!mInternal->hasFreeBuffer_l()) {
+            mInternal->mCondition.wait(mInternal->mLock);
+        }
+        mInternal->mWaiters.fetch_sub(1);
     }
     // Never gets here.
 }
@@ -232,6 +261,12 @@ size_t MediaBufferGroup::buffers() const {
 }
 
 void MediaBufferGroup::signalBufferReturned(MediaBufferBase *) {
+    // Pairs with the fence in acquire_buffer(). Nobody is waiting in the common case, so
+    // returning a buffer does not contend on mLock with acquire_buffer().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mInternal->mWaiters.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
     Mutex::Autolock autoLock(mInternal->mLock);
     mInternal->mCondition.signal();
 }
@@ -17,13 +17,15 @@
 //#define LOG_NDEBUG 0
 #define LOG_TAG "MetaDataBase"
 #include <inttypes.h>
-#include <utils/KeyedVector.h>
 #include <utils/Log.h>
 
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AString.h>
@@ -42,6 +44,8 @@ struct MetaDataBase::typed_data {
 
     typed_data(const MetaDataBase::typed_data &);
     typed_data &operator=(const MetaDataBase::typed_data &);
+    typed_data(MetaDataBase::typed_data &&) noexcept;
+    typed_data &operator=(MetaDataBase::typed_data &&) noexcept;
 
     void clear();
     void setData(uint32_t type, const void *data, size_t size);
@@ -53,9 +57,11 @@ private:
     uint32_t mType;
     size_t mSize;
 
+    // Values up to this size (int64_t, pointers, Rect, short strings) are stored inline so that
+    // per-sample metadata does not allocate.
     union {
         void *ext_data;
-        float reservoir;
+        int64_t reservoir[2];
     } u;
 
     bool usesReservoir() const {
@@ -80,8 +86,26 @@ struct MetaDataBase::Rect {
 
 
 struct MetaDataBase::MetaDataInternal {
+    typedef std::pair<uint32_t, MetaDataBase::typed_data> Item;
+
     std::mutex mLock;
-    KeyedVector<uint32_t, MetaDataBase::typed_data> mItems;
+    // Sorted by key. Metadata holds a handful of items, so a flat array is both more compact
+    // and faster to search than a tree, and clear() keeps its capacity for reuse by the next
+    // sample.
+    std::vector<Item> mItems;
+
+    ssize_t indexOfKey(uint32_t key) const {
+        auto it = lowerBound(key);
+        if (it == mItems.end() || it->first != key) {
+            return -1;
+        }
+        return it - mItems.begin();
+    }
+
+    std::vector<Item>::const_iterator lowerBound(uint32_t key) const {
+        return std::lower_bound(mItems.begin(), mItems.end(), key,
+                [](const Item &item, uint32_t k) { return item.first < k; });
+    }
 };
 
 
@@ -106,6 +130,7 @@ MetaDataBase::~MetaDataBase() {
 
 void MetaDataBase::clear() {
     std::lock_guard<std::mutex> guard(mInternalData->mLock);
+    // keeps the array allocated; values stored inline need no freeing
     mInternalData->mItems.clear();
 }
 
@@ -117,7 +142,7 @@ bool MetaDataBase::remove(uint32_t key) {
         return false;
     }
 
-    mInternalData->mItems.removeItemsAt(i);
+    mInternalData->mItems.erase(mInternalData->mItems.begin() + i);
 
     return true;
 }
@@ -258,17 +283,15 @@ bool MetaDataBase::setData(
     bool overwrote_existing = true;
 
     std::lock_guard<std::mutex> guard(mInternalData->mLock);
-    ssize_t i = mInternalData->mItems.indexOfKey(key);
-    if (i < 0) {
-        typed_data item;
-        i = mInternalData->mItems.add(key, item);
+    std::vector<MetaDataInternal::Item> &items = mInternalData->mItems;
+    auto it = items.begin() + (mInternalData->lowerBound(key) - items.cbegin());
+    if (it == items.end() || it->first != key) {
+        it = items.emplace(it, key, typed_data());
 
         overwrote_existing = false;
     }
 
-    typed_data &item = mInternalData->mItems.editValueAt(i);
-
-    item.setData(type, data, size);
+    it->second.setData(type, data, size);
 
     return overwrote_existing;
 }
@@ -282,7 +305,7 @@ bool MetaDataBase::findData(uint32_t key, uint32_t *type,
         return false;
     }
 
-    const typed_data &item = mInternalData->mItems.valueAt(i);
+    const typed_data &item = mInternalData->mItems[i].second;
 
     item.getData(type, data, size);
 
@@ -333,6 +356,27 @@ MetaDataBase::typed_data &MetaDataBase::typed_data::operator=(
     return *this;
 }
 
+MetaDataBase::typed_data::typed_data(typed_data &&from) noexcept
+    : mType(from.mType),
+      mSize(from.mSize),
+      u(from.u) {
+    from.mType = 0;
+    from.mSize = 0;
+}
+
+MetaDataBase::typed_data &MetaDataBase::typed_data::operator=(typed_data &&from) noexcept {
+    if (this != &from) {
+        clear();
+        mType = from.mType;
+        mSize = from.mSize;
+        u = from.u;
+        from.mType = 0;
+        from.mSize = 0;
+    }
+
+    return *this;
+}
+
 void MetaDataBase::typed_data::clear() {
     freeStorage();
 
@@ -341,6 +385,13 @@ void MetaDataBase::typed_data::clear() {
 
 void MetaDataBase::typed_data::setData(
         uint32_t type, const void *data, size_t size) {
+    // overwriting an out-of-line value of the same size (e.g. crypto info) reuses its buffer
+    if (!usesReservoir() && size == mSize && u.ext_data != NULL) {
+        mType = type;
+        memcpy(u.ext_data, data, size);
+        return;
+    }
+
     clear();
 
     mType = type;
@@ -439,10 +490,10 @@ String8 MetaDataBase::toString() const {
     String8 s;
     std::lock_guard<std::mutex> guard(mInternalData->mLock);
     for (int i = mInternalData->mItems.size(); --i >= 0;) {
-        int32_t key = mInternalData->mItems.keyAt(i);
+        int32_t key = mInternalData->mItems[i].first;
         char cc[5];
         MakeFourCCString(key, cc);
-        const typed_data &item = mInternalData->mItems.valueAt(i);
+        const typed_data &item = mInternalData->mItems[i].second;
         s.appendFormat("%s: %s", cc, item.asString(false).c_str());
         if (i != 0) {
             s.append(", ");
@@ -454,10 +505,10 @@ String8 MetaDataBase::toString() const {
 void MetaDataBase::dumpToLog() const {
     std::lock_guard<std::mutex> guard(mInternalData->mLock);
     for (int i = mInternalData->mItems.size(); --i >= 0;) {
-        int32_t key = mInternalData->mItems.keyAt(i);
+        int32_t key = mInternalData->mItems[i].first;
         char cc[5];
         MakeFourCCString(key, cc);
-        const typed_data &item = mInternalData->mItems.valueAt(i);
+        const typed_data &item = mInternalData->mItems[i].second;
         ALOGI("%s: %s", cc, item.asString(true /* verbose */).c_str());
     }
 }
@@ -472,8 +523,8 @@ status_t MetaDataBase::writeToParcel(Parcel &parcel) {
         return ret;
     }
     for (size_t i = 0; i < numItems; i++) {
-        int32_t key = mInternalData->mItems.keyAt(i);
-        const typed_data &item = mInternalData->mItems.valueAt(i);
+        int32_t key = mInternalData->mItems[i].first;
+        const typed_data &item = mInternalData->mItems[i].second;
         uint32_t type;
         const void *data;
         size_t size;
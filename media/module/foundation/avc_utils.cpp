@@ -31,10 +31,8 @@
 namespace android {
 
 unsigned parseUE(ABitReader *br) {
-    unsigned numZeroes = 0;
-    while (br->getBits(1) == 0) {
-        ++numZeroes;
-    }
+    size_t numZeroes;
+    CHECK(br->getLeadingZeroBits(&numZeroes));
 
     unsigned x = br->getBits(numZeroes);
 
@@ -42,9 +40,10 @@ unsigned parseUE(ABitReader *br) {
 }
 
 unsigned parseUEWithFallback(ABitReader *br, unsigned fallback) {
-    unsigned numZeroes = 0;
-    while (br->getBitsWithFallback(1, 1) == 0) {
-        ++numZeroes;
+    size_t numZeroes;
+    if (!br->getLeadingZeroBits(&numZeroes) && numZeroes == 0) {
+        // running out of data before the first bit decodes as 0, as it always has
+        return 0;
     }
     uint32_t x;
     if (numZeroes < 32) {
@@ -288,6 +287,25 @@ void FindAVCDimensions(
     }
 }
 
+const uint8_t *findNextStartCode(const uint8_t *data, size_t size) {
+    // Look for the 0x01 with memchr(), which libc implements with the widest vector
+    // instructions the CPU supports, and only then check the two bytes in front of it.
+    // 0x01 is rare in coded slice data, so most of the stream is skipped in bulk.
+    const uint8_t *end = data + size;
+    for (const uint8_t *p = data + 2; p < end;) {
+        p = (const uint8_t *)memchr(p, 0x01, end - p);
+        if (p == NULL) {
+            break;
+        }
+        if (p[-1] == 0x00 && p[-2] == 0x00) {
+            return p - 2;
+        }
+        // The 0x01 at p rules out start codes ending at p + 1 and p + 2 as well.
+        p += 3;
+    }
+    return NULL;
+}
+
 status_t getNextNALUnit(
         const uint8_t **_data, size_t *_size,
         const uint8_t **nalStart, size_t *nalSize,
@@ -302,43 +320,26 @@ status_t getNextNALUnit(
         return -EAGAIN;
     }
 
-    size_t offset = 0;
-
     // A valid startcode consists of at least two 0x00 bytes followed by 0x01.
-    for (; offset + 2 < size; ++offset) {
-        if (data[offset + 2] == 0x01 && data[offset] == 0x00
-                && data[offset + 1] == 0x00) {
-            break;
-        }
-    }
-    if (offset + 2 >= size) {
-        *_data = &data[offset];
+    const uint8_t *startCode = findNextStartCode(data, size);
+    if (startCode == NULL) {
+        *_data = &data[size - 2];
         *_size = 2;
         return -EAGAIN;
     }
-    offset += 3;
 
+    size_t offset = startCode - data + 3;
     size_t startOffset = offset;
 
-    for (;;) {
-        while (offset < size && data[offset] != 0x01) {
-            ++offset;
-        }
-
-        if (offset == size) {
-            if (startCodeFollows) {
-                offset = size + 2;
-                break;
-            }
-
-            return -EAGAIN;
-        }
-
-        if (data[offset - 1] == 0x00 && data[offset - 2] == 0x00) {
-            break;
-        }
-
-        ++offset;
+    // The NAL unit ends at the next start code, whose 0x01 is at or after startOffset.
+    const uint8_t *nextStartCode =
+            findNextStartCode(&data[startOffset - 2], size - startOffset + 2);
+    if (nextStartCode != NULL) {
+        offset = nextStartCode - data + 2;
+    } else if (startCodeFollows) {
+        offset = size + 2;
+    } else {
+        return -EAGAIN;
     }
 
     size_t endOffset = offset - 2;
@@ -360,18 +361,27 @@ status_t getNextNALUnit(
     return OK;
 }
 
+static bool FindNALUnit(
+        const uint8_t *data, size_t size, unsigned nalType,
+        const uint8_t **nalStart, size_t *nalSize) {
+    while (getNextNALUnit(&data, &size, nalStart, nalSize, true) == OK) {
+        if (*nalSize > 0 && ((*nalStart)[0] & 0x1f) == nalType) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The returned buffer refers to |data| and is only valid as long as it is.
 static sp<ABuffer> FindNAL(const uint8_t *data, size_t size, unsigned nalType) {
     const uint8_t *nalStart;
     size_t nalSize;
-    while (getNextNALUnit(&data, &size, &nalStart, &nalSize, true) == OK) {
-        if (nalSize > 0 && (nalStart[0] & 0x1f) == nalType) {
-            sp<ABuffer> buffer = new ABuffer(nalSize);
-            memcpy(buffer->data(), nalStart, nalSize);
-            return buffer;
-        }
+    if (!FindNALUnit(data, size, nalType, &nalStart, &nalSize)) {
+        return NULL;
     }
 
-    return NULL;
+    return new ABuffer(const_cast<uint8_t *>(nalStart), nalSize);
 }
 
 const char *AVCProfileToString(uint8_t profile) {
@@ -542,10 +552,11 @@ uint32_t FindAVCLayerId(const uint8_t *data, size_t size) {
     // Layer n uses reference frames from layer 0, 1, ..., n-1.
 
     uint32_t layerId = 0;
-    sp<ABuffer> svcNAL = FindNAL(
-            data, size > kSvcNalSearchRange ? kSvcNalSearchRange : size, kSvcNalType);
-    if (svcNAL != NULL && svcNAL->size() >= 4) {
-        layerId = (*(svcNAL->data() + 3) >> 5) & 0x7;
+    const uint8_t *svcNAL;
+    size_t svcNALSize;
+    if (FindNALUnit(data, size > kSvcNalSearchRange ? kSvcNalSearchRange : size, kSvcNalType,
+                    &svcNAL, &svcNALSize) && svcNALSize >= 4) {
+        layerId = (svcNAL[3] >> 5) & 0x7;
     }
     return layerId;
 }
@@ -21,6 +21,8 @@
 #include <sys/types.h>
 #include <stdint.h>
 
+#include <atomic>
+
 #include <media/stagefright/foundation/ABase.h>
 #include <utils/RefBase.h>
 
@@ -43,6 +45,16 @@ struct ABuffer : public RefBase {
     // create buffer from dup of some memory block
     static sp<ABuffer> CreateAsCopy(const void *data, size_t capacity);
 
+    // Creates a buffer that refers to |size| bytes at |offset| into this buffer's
+    // current range, without copying. The slice keeps the underlying memory alive
+    // and has its own range, meta and int32 data; its contents are shared with
+    // this buffer.
+    sp<ABuffer> slice(size_t offset, size_t size);
+
+    // Returns true while slices of this buffer's memory are alive. The owner must
+    // not overwrite their bytes, e.g. by compacting its data in place, until then.
+    bool hasSlices() const;
+
     void setInt32Data(int32_t data) { mInt32Data = data; }
     int32_t int32Data() const { return mInt32Data; }
 
@@ -63,6 +75,11 @@ private:
 
     bool mOwnsData;
 
+    // For slices, the buffer owning the memory.
+    sp<ABuffer> mParent;
+    // For owners, the number of live slices.
+    std::atomic<int32_t> mNumSlices;
+
     DISALLOW_EVIL_CONSTRUCTORS(ABuffer);
 };
 
@@ -26,6 +26,8 @@
 #include <utils/RefBase.h>
 #include <utils/threads.h>
 
+#include <vector>
+
 namespace android {
 
 struct AHandler;
@@ -69,16 +71,27 @@ private:
 
     struct Event {
         int64_t mWhenUs;
+        // Events due at the same time are delivered in the order they were posted.
+        uint64_t mSeq;
         sp<AMessage> mMessage;
         sp<RefBase> mToken;
     };
 
+    // Orders the event queue heap so that the earliest event is at the front.
+    struct EventAfter {
+        bool operator()(const Event &a, const Event &b) const {
+            return a.mWhenUs != b.mWhenUs ? a.mWhenUs > b.mWhenUs : a.mSeq > b.mSeq;
+        }
+    };
+
     Mutex mLock;
     Condition mQueueChangedCondition;
 
     AString mName;
 
-    List<Event> mEventQueue;
+    // Binary min-heap ordered by EventAfter.
+    std::vector<Event> mEventQueue;
+    uint64_t mNextEventSeq;
 
     struct LooperThread;
     sp<LooperThread> mThread;
@@ -110,6 +123,9 @@ private:
 
     // END --- methods used only by AMessage
 
+    // Adds an event to mEventQueue, returns true if it became the earliest one.
+    bool queueEvent_l(int64_t whenUs, const sp<AMessage> &msg, const sp<RefBase> &token);
+
     bool loop();
 
     DISALLOW_EVIL_CONSTRUCTORS(ALooper);
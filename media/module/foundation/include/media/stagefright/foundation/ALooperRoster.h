@@ -22,6 +22,8 @@
 #include <utils/KeyedVector.h>
 #include <utils/String16.h>
 
+#include <atomic>
+
 namespace android {
 
 struct ALooperRoster {
@@ -41,9 +43,28 @@ private:
         wp<AHandler> mHandler;
     };
 
-    Mutex mLock;
-    KeyedVector<ALooper::handler_id, HandlerInfo> mHandlers;
-    ALooper::handler_id mNextHandlerID;
+    enum {
+        // Handlers are spread over this many independently locked shards by id, so that
+        // sessions being created and torn down concurrently rarely contend.
+        kNumShards = 16,
+    };
+
+    struct Shard {
+        Mutex mLock;
+        KeyedVector<ALooper::handler_id, HandlerInfo> mHandlers;
+    };
+
+    // Held while a handler's own id is checked or changed, so that a handler
+    // is registered at most once. Taken before any shard lock.
+    Mutex mRegistrationLock;
+    Shard mShards[kNumShards];
+    std::atomic<ALooper::handler_id> mNextHandlerID;
+    // unregisterStaleHandlers() sweeps one shard per call, starting with this one.
+    std::atomic<uint32_t> mNextStaleShard;
+
+    Shard &shardFor(ALooper::handler_id handlerID) {
+        return mShards[static_cast<uint32_t>(handlerID) % kNumShards];
+    }
 
     DISALLOW_EVIL_CONSTRUCTORS(ALooperRoster);
 };
@@ -100,6 +100,44 @@ struct AMessage : public RefBase {
     // removes all items
     void clear();
 
+    // An item name together with its length and hash. Declaring well-known names as constexpr
+    // Keys (see MediaFormatKeys.h) moves the strlen() and hashing to compile time, so a lookup
+    // only compares integers until the final check of the matching name.
+    struct Key {
+        constexpr explicit Key(const char *name)
+            : mName(name), mLength(0), mHash(2166136261u) {
+            // FNV-1a, as used for Item::mNameHash
+            for (; name[mLength] != '\0'; ++mLength) {
+                mHash = (mHash ^ (uint8_t)name[mLength]) * 16777619u;
+            }
+        }
+
+        const char *mName;
+        size_t mLength;
+        uint32_t mHash;
+    };
+
+    void setInt32(const Key &key, int32_t value);
+    void setInt64(const Key &key, int64_t value);
+    void setSize(const Key &key, size_t value);
+    void setFloat(const Key &key, float value);
+    void setDouble(const Key &key, double value);
+    void setPointer(const Key &key, void *value);
+    void setString(const Key &key, const char *s, ssize_t len = -1);
+    void setString(const Key &key, const AString &s);
+    void setBuffer(const Key &key, const sp<ABuffer> &buffer);
+
+    bool contains(const Key &key) const;
+
+    bool findInt32(const Key &key, int32_t *value) const;
+    bool findInt64(const Key &key, int64_t *value) const;
+    bool findSize(const Key &key, size_t *value) const;
+    bool findFloat(const Key &key, float *value) const;
+    bool findDouble(const Key &key, double *value) const;
+    bool findPointer(const Key &key, void **value) const;
+    bool findString(const Key &key, AString *value) const;
+    bool findBuffer(const Key &key, sp<ABuffer> *buffer) const;
+
     void setInt32(const char *name, int32_t value);
     void setInt64(const char *name, int64_t value);
     void setSize(const char *name, size_t value);
@@ -309,17 +347,28 @@ private:
         } u;
         const char *mName;
         size_t      mNameLength;
+        uint32_t    mNameHash;
         Type mType;
         void setName(const char *name, size_t len);
-        Item() : mName(nullptr), mNameLength(0), mType(kTypeInt32) { }
-        Item(const char *name, size_t length);
+        void setName(const Key &key);
+        Item() : mName(nullptr), mNameLength(0), mNameHash(0), mType(kTypeInt32) { }
+        explicit Item(const Key &key);
     };
 
     enum {
-        kMaxNumItems = 256
+        kMaxNumItems = 256,
+        // messages with at least this many items keep a hash index of their names
+        kMinIndexedItems = 12,
     };
     std::vector<Item> mItems;
 
+    /**
+     * Open-addressed hash table over mItems, keyed by Item::mNameHash. Each slot holds the item
+     * index plus one, or 0 if the slot is empty. The table is empty for small messages, where a
+     * linear scan comparing the cached hashes is faster.
+     */
+    std::vector<uint16_t> mItemIndex;
+
     /**
      * Allocates an item with the given key |name|. If the key already exists, the corresponding
      * item value is freed. Otherwise a new item is added.
@@ -338,18 +387,24 @@ private:
      *
      * @return Item* a pointer to the item.
      */
-    Item *allocateItem(const char *name);
+    Item *allocateItem(const Key &key);
 
     /** Frees the value for the item. */
     void freeItemValue(Item *item);
 
     /** Finds an item with given key |name| and |type|. Returns nullptr if item is not found. */
-    const Item *findItem(const char *name, Type type) const;
+    const Item *findItem(const Key &key, Type type) const;
 
     void setObjectInternal(
-            const char *name, const sp<RefBase> &obj, Type type);
+            const Key &key, const sp<RefBase> &obj, Type type);
+
+    size_t findItemIndex(const Key &key) const;
+
+    /** Adds mItems[index] to mItemIndex, growing the table if needed. */
+    void indexItem(size_t index);
 
-    size_t findItemIndex(const char *name, size_t len) const;
+    /** Rebuilds mItemIndex after items were removed, renamed or bulk-assigned. */
+    void rebuildItemIndex();
 
     void deliver();
 
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <media/stagefright/foundation/ABitReader.h>
+#include <media/stagefright/foundation/avc_utils.h>
+
+using namespace android;
+
+namespace {
+
+constexpr size_t kStreamSize = 64 * 1024;
+
+std::vector<uint8_t> makeRandomStream(size_t size) {
+    std::vector<uint8_t> data(size);
+    srand(0x5eed);
+    for (uint8_t &byte : data) {
+        byte = rand() & 0xff;
+    }
+    return data;
+}
+
+// Packs |count| small Exp-Golomb codes, as found in SPS/PPS and slice headers.
+std::vector<uint8_t> makeExpGolombStream(size_t count) {
+    std::vector<uint8_t> data;
+    uint64_t acc = 0;
+    size_t numBits = 0;
+    srand(0x5eed);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t codeNum = rand() % 64 + 1;
+        size_t len = 0;
+        while ((codeNum >> len) > 1) {
+            ++len;
+        }
+        // |len| zeros followed by the |len| + 1 bits of codeNum
+        acc = (acc << (2 * len + 1)) | codeNum;
+        numBits += 2 * len + 1;
+        while (numBits >= 8) {
+            data.push_back((uint8_t)(acc >> (numBits - 8)));
+            numBits -= 8;
+        }
+    }
+    if (numBits > 0) {
+        data.push_back((uint8_t)(acc << (8 - numBits)));
+    }
+    return data;
+}
+
+}  // namespace
+
+static void BM_ABitReader_GetBits(benchmark::State &state) {
+    std::vector<uint8_t> data = makeRandomStream(kStreamSize);
+    const size_t width = state.range(0);
+    const size_t numReads = data.size() * 8 / width;
+
+    while (state.KeepRunning()) {
+        ABitReader br(data.data(), data.size());
+        for (size_t i = 0; i < numReads; ++i) {
+            benchmark::DoNotOptimize(br.getBits(width));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void BM_ABitReader_SkipBits(benchmark::State &state) {
+    std::vector<uint8_t> data = makeRandomStream(kStreamSize);
+    const size_t width = state.range(0);
+    const size_t numSkips = data.size() * 8 / width;
+
+    while (state.KeepRunning()) {
+        ABitReader br(data.data(), data.size());
+        for (size_t i = 0; i < numSkips; ++i) {
+            br.skipBits(width);
+        }
+        benchmark::DoNotOptimize(br.numBitsLeft());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void BM_ABitReader_ParseUE(benchmark::State &state) {
+    const size_t numCodes = 16 * 1024;
+    std::vector<uint8_t> data = makeExpGolombStream(numCodes);
+
+    while (state.KeepRunning()) {
+        ABitReader br(data.data(), data.size());
+        for (size_t i = 0; i < numCodes; ++i) {
+            benchmark::DoNotOptimize(parseUE(&br));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numCodes);
+}
+
+static void BM_NALBitReader_GetBits(benchmark::State &state) {
+    std::vector<uint8_t> data = makeRandomStream(kStreamSize);
+    if (state.range(0)) {
+        // insert an emulation_prevention_three_byte every 64 bytes
+        for (size_t i = 64; i + 3 <= data.size(); i += 64) {
+            data[i] = 0;
+            data[i + 1] = 0;
+            data[i + 2] = 3;
+        }
+    }
+
+    while (state.KeepRunning()) {
+        NALBitReader br(data.data(), data.size());
+        uint32_t value;
+        while (br.getBitsGraceful(8, &value)) {
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_ABitReader_GetBits)->Arg(1)->Arg(5)->Arg(8)->Arg(16)->Arg(32);
+BENCHMARK(BM_ABitReader_SkipBits)->Arg(3)->Arg(32)->Arg(200);
+BENCHMARK(BM_ABitReader_ParseUE);
+BENCHMARK(BM_NALBitReader_GetBits)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "ABitReader_test"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <media/stagefright/foundation/ABitReader.h>
+
+namespace android {
+
+namespace {
+
+std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed, bool nonZero = false) {
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t &byte : bytes) {
+        seed = seed * 1103515245u + 12345u;
+        byte = seed >> 24;
+        if (nonZero && byte == 0) {
+            byte = 0x5a;
+        }
+    }
+    return bytes;
+}
+
+// Reads one bit at a time; the reference the readers are checked against.
+struct ReferenceReader {
+    explicit ReferenceReader(const std::vector<uint8_t> &bytes) : mBytes(bytes), mPos(0) {}
+
+    size_t numBitsLeft() const {
+        return mBytes.size() * 8 - mPos;
+    }
+
+    uint32_t getBits(size_t n) {
+        uint32_t value = 0;
+        for (size_t i = 0; i < n; ++i, ++mPos) {
+            value = (value << 1) | ((mBytes[mPos / 8] >> (7 - mPos % 8)) & 1);
+        }
+        return value;
+    }
+
+private:
+    std::vector<uint8_t> mBytes;
+    size_t mPos;
+};
+
+// Drops emulation_prevention_three_bytes from |nal|.
+std::vector<uint8_t> ToRbsp(const std::vector<uint8_t> &nal) {
+    std::vector<uint8_t> rbsp;
+    size_t numZeros = 0;
+    for (uint8_t byte : nal) {
+        if (numZeros >= 2 && byte == 3) {
+            numZeros = 0;
+            continue;
+        }
+        numZeros = byte == 0 ? numZeros + 1 : 0;
+        rbsp.push_back(byte);
+    }
+    return rbsp;
+}
+
+// Reads |offset| bits without going through skipBits().
+void Advance(ABitReader *reader, size_t offset) {
+    while (offset > 0) {
+        size_t n = std::min(offset, size_t(32));
+        uint32_t value;
+        ASSERT_TRUE(reader->getBitsGraceful(n, &value));
+        offset -= n;
+    }
+}
+
+}  // namespace
+
+// Reads of every width starting at every bit position up to the third
+// reservoir, which covers refills at 32 and 64 bit boundaries, and the byte
+// by byte refill of the last few bytes.
+TEST(ABitReaderTest, GetBitsAcrossRefills) {
+    for (size_t size : {9u, 12u, 17u, 24u, 31u}) {
+        std::vector<uint8_t> data = RandomBytes(size, size);
+        for (size_t offset = 0; offset <= 8 * size; ++offset) {
+            for (size_t n = 1; n <= 32 && offset + n <= 8 * size; ++n) {
+                ABitReader reader(data.data(), data.size());
+                ReferenceReader reference(data);
+                ASSERT_NO_FATAL_FAILURE(Advance(&reader, offset));
+                reference.getBits(offset);
+
+                uint32_t value;
+                ASSERT_TRUE(reader.getBitsGraceful(n, &value))
+                        << "size " << size << " offset " << offset << " n " << n;
+                EXPECT_EQ(reference.getBits(n), value)
+                        << "size " << size << " offset " << offset << " n " << n;
+                EXPECT_EQ(reference.numBitsLeft(), reader.numBitsLeft());
+                EXPECT_FALSE(reader.overRead());
+            }
+        }
+    }
+}
+
+TEST(ABitReaderTest, SkipBits) {
+    std::vector<uint8_t> data = RandomBytes(40, 1);
+    for (size_t n : {0u, 1u, 31u, 32u, 33u, 63u, 64u, 65u, 100u, 128u, 129u, 200u, 300u}) {
+        for (size_t offset : {0u, 5u, 32u, 60u}) {
+            if (offset + n + 16 > 8 * data.size()) {
+                continue;
+            }
+            ABitReader reader(data.data(), data.size());
+            ReferenceReader reference(data);
+            ASSERT_NO_FATAL_FAILURE(Advance(&reader, offset));
+            reference.getBits(offset);
+
+            ASSERT_TRUE(reader.skipBits(n)) << "offset " << offset << " n " << n;
+            reference.getBits(n);
+            EXPECT_EQ(reference.numBitsLeft(), reader.numBitsLeft())
+                    << "offset " << offset << " n " << n;
+            EXPECT_EQ(reference.getBits(16), reader.getBits(16))
+                    << "offset " << offset << " n " << n;
+        }
+    }
+
+    ABitReader reader(data.data(), data.size());
+    EXPECT_TRUE(reader.skipBits(8 * data.size()));
+    EXPECT_EQ(0u, reader.numBitsLeft());
+
+    ABitReader pastEnd(data.data(), data.size());
+    EXPECT_FALSE(pastEnd.skipBits(8 * data.size() + 1));
+    EXPECT_TRUE(pastEnd.overRead());
+}
+
+// A single 1 bit at every position of buffers around the reservoir size,
+// with and without bits read before.
+TEST(ABitReaderTest, GetLeadingZeroBitsNearEnd) {
+    for (size_t size : {1u, 7u, 8u, 9u, 16u, 17u}) {
+        for (size_t pos = 0; pos < 8 * size; ++pos) {
+            std::vector<uint8_t> data(size, 0);
+            data[pos / 8] = 0x80 >> (pos % 8);
+            for (size_t prefix : {0u, 3u}) {
+                if (prefix > pos) {
+                    continue;
+                }
+                ABitReader reader(data.data(), data.size());
+                ASSERT_NO_FATAL_FAILURE(Advance(&reader, prefix));
+                size_t numZeros = 0;
+                ASSERT_TRUE(reader.getLeadingZeroBits(&numZeros))
+                        << "size " << size << " pos " << pos << " prefix " << prefix;
+                EXPECT_EQ(pos - prefix, numZeros)
+                        << "size " << size << " pos " << pos << " prefix " << prefix;
+                EXPECT_EQ(8 * size - pos - 1, reader.numBitsLeft())
+                        << "size " << size << " pos " << pos << " prefix " << prefix;
+            }
+        }
+
+        // no 1 bit at all
+        std::vector<uint8_t> zeros(size, 0);
+        ABitReader reader(zeros.data(), zeros.size());
+        size_t numZeros = 0;
+        EXPECT_FALSE(reader.getLeadingZeroBits(&numZeros)) << "size " << size;
+        EXPECT_EQ(8 * size, numZeros);
+        EXPECT_EQ(0u, reader.numBitsLeft());
+    }
+}
+
+TEST(ABitReaderTest, GetBitsGraceful) {
+    const uint8_t data[] = { 0xab, 0xcd, 0xef };
+    ABitReader reader(data, sizeof(data));
+
+    uint32_t value = 0x1234;
+    EXPECT_FALSE(reader.getBitsGraceful(33, &value));
+    EXPECT_EQ(0x1234u, value);
+    EXPECT_FALSE(reader.overRead()) << "reading more than 32 bits is not an over-read";
+
+    EXPECT_TRUE(reader.getBitsGraceful(0, &value));
+    EXPECT_EQ(0u, value);
+
+    EXPECT_TRUE(reader.getBitsGraceful(20, &value));
+    EXPECT_EQ(0xabcdeu, value);
+    EXPECT_TRUE(reader.getBitsGraceful(2, &value));
+    EXPECT_EQ(0x3u, value);
+    EXPECT_EQ(2u, reader.numBitsLeft());
+
+    EXPECT_FALSE(reader.getBitsGraceful(8, &value));
+    EXPECT_TRUE(reader.overRead());
+    EXPECT_EQ(0x5678u, reader.getBitsWithFallback(8, 0x5678));
+
+    ABitReader empty(data, 0);
+    EXPECT_EQ(0xffu, empty.getBitsWithFallback(1, 0xff));
+    EXPECT_TRUE(empty.overRead());
+}
+
+// Bits put back are read again, also when they span two reservoirs.
+TEST(ABitReaderTest, PutBitsRoundTrip) {
+    std::vector<uint8_t> data = RandomBytes(24, 2);
+    for (size_t offset = 0; offset <= 80; ++offset) {
+        for (size_t n = 1; n <= 32; ++n) {
+            ABitReader reader(data.data(), data.size());
+            ReferenceReader reference(data);
+            ASSERT_NO_FATAL_FAILURE(Advance(&reader, offset));
+            reference.getBits(offset);
+
+            uint32_t value = reader.getBits(n);
+            reader.putBits(value, n);
+            EXPECT_EQ(reference.numBitsLeft(), reader.numBitsLeft())
+                    << "offset " << offset << " n " << n;
+            EXPECT_EQ(reference.getBits(n), reader.getBits(n))
+                    << "offset " << offset << " n " << n;
+            EXPECT_EQ(reference.getBits(32), reader.getBits(32))
+                    << "offset " << offset << " n " << n;
+        }
+    }
+
+    // 64 bits, the most that can be put back
+    ABitReader reader(data.data(), data.size());
+    ASSERT_NO_FATAL_FAILURE(Advance(&reader, 5));
+    uint32_t first = reader.getBits(32);
+    uint32_t second = reader.getBits(32);
+    reader.putBits(second, 32);
+    reader.putBits(first, 32);
+    EXPECT_EQ(first, reader.getBits(32));
+    EXPECT_EQ(second, reader.getBits(32));
+}
+
+// emulation_prevention_three_bytes at every position around the 8 byte bulk
+// refill, including a 0x03 that follows two zeros from the previous fill.
+TEST(NALBitReaderTest, EmulationPreventionAcrossFills) {
+    for (size_t pos = 0; pos + 3 <= 32; ++pos) {
+        for (size_t width : {1u, 7u, 32u}) {
+            std::vector<uint8_t> nal = RandomBytes(32, pos, true /* nonZero */);
+            nal[pos] = 0;
+            nal[pos + 1] = 0;
+            nal[pos + 2] = 3;
+            std::vector<uint8_t> rbsp = ToRbsp(nal);
+            ASSERT_EQ(nal.size() - 1, rbsp.size());
+
+            NALBitReader reader(nal.data(), nal.size());
+            ReferenceReader reference(rbsp);
+            while (reference.numBitsLeft() > 0) {
+                size_t n = std::min(width, reference.numBitsLeft());
+                ASSERT_TRUE(reader.atLeastNumBitsLeft(n));
+                uint32_t value;
+                ASSERT_TRUE(reader.getBitsGraceful(n, &value))
+                        << "pos " << pos << " width " << width;
+                ASSERT_EQ(reference.getBits(n), value)
+                        << "pos " << pos << " width " << width
+                        << " at bit " << 8 * rbsp.size() - reference.numBitsLeft();
+            }
+            uint32_t value;
+            EXPECT_FALSE(reader.getBitsGraceful(1, &value));
+        }
+    }
+}
+
+// Back to back emulation prevention sequences, which keep the reader on the
+// byte by byte path.
+TEST(NALBitReaderTest, ConsecutiveEmulationPrevention) {
+    std::vector<uint8_t> nal;
+    for (size_t i = 0; i < 8; ++i) {
+        nal.insert(nal.end(), { 0, 0, 3, 1 });
+    }
+    nal.insert(nal.end(), { 0, 0, 3, 0, 0, 3, 0, 0, 3, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa });
+    std::vector<uint8_t> rbsp = ToRbsp(nal);
+
+    NALBitReader reader(nal.data(), nal.size());
+    ReferenceReader reference(rbsp);
+    while (reference.numBitsLeft() >= 12) {
+        ASSERT_EQ(reference.getBits(12), reader.getBits(12));
+    }
+}
+
+}  // namespace android
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "ABuffer_test"
+
+#include <gtest/gtest.h>
+#include <utils/RefBase.h>
+
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/AMessage.h>
+
+using namespace android;
+
+TEST(ABuffer_tests, sliceSharesMemory) {
+  sp<ABuffer> buffer = new ABuffer(16);
+  for (size_t i = 0; i < buffer->size(); ++i) {
+    buffer->data()[i] = i;
+  }
+  buffer->setRange(4, 8);
+  EXPECT_FALSE(buffer->hasSlices());
+
+  sp<ABuffer> slice = buffer->slice(2, 4);
+  EXPECT_TRUE(buffer->hasSlices());
+  EXPECT_EQ(4, slice->size());
+  EXPECT_EQ(4, slice->capacity());
+  EXPECT_EQ(0, slice->offset());
+  EXPECT_EQ(buffer->data() + 2, slice->data());
+  EXPECT_EQ(6, slice->data()[0]);
+
+  // writes are shared
+  slice->data()[1] = 0xff;
+  EXPECT_EQ(0xff, buffer->data()[3]);
+
+  // meta is per buffer
+  slice->meta()->setInt64("timeUs", 1);
+  EXPECT_FALSE(buffer->meta()->contains("timeUs"));
+
+  // slices of slices keep the owner alive and are accounted to it
+  sp<ABuffer> sliceOfSlice = slice->slice(1, 2);
+  EXPECT_FALSE(slice->hasSlices());
+  slice.clear();
+  EXPECT_TRUE(buffer->hasSlices());
+
+  wp<ABuffer> weakOwner = buffer;
+  buffer.clear();
+  EXPECT_TRUE(weakOwner.promote().get() != nullptr);
+  EXPECT_EQ(0xff, sliceOfSlice->data()[0]);
+
+  sliceOfSlice.clear();
+  EXPECT_TRUE(weakOwner.promote().get() == nullptr);
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <media/stagefright/foundation/AHandler.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+
+using namespace android;
+
+namespace {
+
+enum {
+    kWhatPending = 'pend',
+    kWhatPing    = 'ping',
+};
+
+// Pending events are parked this far in the future so that they stay queued
+// for the whole benchmark run.
+constexpr int64_t kPendingDelayUs = 60 * 1000000LL;
+constexpr int64_t kPendingSpreadUs = 1000000LL;
+
+struct CountingHandler : public AHandler {
+    std::atomic<int64_t> mDelivered{0};
+
+protected:
+    void onMessageReceived(const sp<AMessage> &msg) override {
+        if (msg->what() == kWhatPing) {
+            mDelivered.fetch_add(1, std::memory_order_release);
+        }
+    }
+};
+
+struct LooperFixture {
+    explicit LooperFixture(int64_t numPending)
+        : mLooper(new ALooper),
+          mHandler(new CountingHandler),
+          mRandom(numPending) {
+        mLooper->setName("ALooper_benchmark");
+        mLooper->registerHandler(mHandler);
+        mLooper->start();
+
+        for (int64_t i = 0; i < numPending; ++i) {
+            (new AMessage(kWhatPending, mHandler))->post(nextPendingDelayUs());
+        }
+    }
+
+    ~LooperFixture() {
+        mLooper->stop();
+        mLooper->unregisterHandler(mHandler->id());
+    }
+
+    int64_t nextPendingDelayUs() {
+        return kPendingDelayUs + (int64_t)(mRandom() % kPendingSpreadUs);
+    }
+
+    sp<ALooper> mLooper;
+    sp<CountingHandler> mHandler;
+    std::minstd_rand mRandom;
+};
+
+}  // namespace
+
+// Cost of posting a delayed message into a queue that already holds
+// state.range(0) pending events with spread-out deadlines.
+static void BM_ALooper_PostDelayed(benchmark::State &state) {
+    LooperFixture fixture(state.range(0));
+    sp<AMessage> msg = new AMessage(kWhatPending, fixture.mHandler);
+
+    while (state.KeepRunning()) {
+        msg->post(fixture.nextPendingDelayUs());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Round trip of a batch of immediate messages through a looper that also
+// holds state.range(0) pending events.
+static void BM_ALooper_PostAndDeliver(benchmark::State &state) {
+    constexpr int64_t kBatch = 1000;
+    LooperFixture fixture(state.range(0));
+    sp<AMessage> msg = new AMessage(kWhatPing, fixture.mHandler);
+
+    int64_t expected = 0;
+    while (state.KeepRunning()) {
+        for (int64_t i = 0; i < kBatch; ++i) {
+            msg->post();
+        }
+        expected += kBatch;
+        while (fixture.mHandler->mDelivered.load(std::memory_order_acquire) < expected) {
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+}
+
+// Session setup/teardown storm: state.range(0) threads each repeatedly create
+// a looper, register and unregister a handler on it, while state.range(1)
+// other handlers stay registered, as in a busy media server.
+static void BM_ALooper_RegisterUnregister(benchmark::State &state) {
+    constexpr int kSessionsPerThread = 2000;
+    const int numThreads = state.range(0);
+
+    sp<ALooper> residentLooper = new ALooper;
+    std::vector<sp<CountingHandler>> residents;
+    for (int64_t i = 0; i < state.range(1); ++i) {
+        residents.push_back(new CountingHandler);
+        residentLooper->registerHandler(residents.back());
+    }
+
+    while (state.KeepRunning()) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([] {
+                for (int i = 0; i < kSessionsPerThread; ++i) {
+                    sp<ALooper> looper = new ALooper;
+                    sp<CountingHandler> handler = new CountingHandler;
+                    looper->registerHandler(handler);
+                    looper->unregisterHandler(handler->id());
+                }
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numThreads * kSessionsPerThread);
+
+    for (const sp<CountingHandler> &handler : residents) {
+        residentLooper->unregisterHandler(handler->id());
+    }
+}
+
+BENCHMARK(BM_ALooper_PostDelayed)->Arg(1000)->Arg(10000)->Arg(100000)->Iterations(20000);
+BENCHMARK(BM_ALooper_PostAndDeliver)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_ALooper_RegisterUnregister)
+        ->ArgPair(1, 0)->ArgPair(4, 0)->ArgPair(4, 500)->ArgPair(8, 500)
+        ->UseRealTime();
+
+BENCHMARK_MAIN();
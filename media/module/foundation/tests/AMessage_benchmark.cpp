@@ -0,0 +1,159 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/AString.h>
+
+using namespace android;
+
+namespace {
+
+// Builds a format-like message with |numKeys| entries whose names share a
+// common prefix, as codec formats do.
+sp<AMessage> makeFormat(size_t numKeys, std::vector<AString> *keys) {
+    sp<AMessage> format = new AMessage;
+    keys->clear();
+    for (size_t i = 0; i < numKeys; ++i) {
+        keys->push_back(AStringPrintf("vendor.qti-ext-enc.param-%zu", i));
+        format->setInt32(keys->back().c_str(), (int32_t)i);
+    }
+    return format;
+}
+
+}  // namespace
+
+static void BM_AMessage_FindInt32(benchmark::State &state) {
+    std::vector<AString> keys;
+    sp<AMessage> format = makeFormat(state.range(0), &keys);
+
+    size_t ix = 0;
+    int32_t value;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(format->findInt32(keys[ix].c_str(), &value));
+        if (++ix == keys.size()) {
+            ix = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_AMessage_FindMissing(benchmark::State &state) {
+    std::vector<AString> keys;
+    sp<AMessage> format = makeFormat(state.range(0), &keys);
+
+    int32_t value;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(format->findInt32("vendor.qti-ext-enc.missing", &value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_AMessage_FindInt32Key(benchmark::State &state) {
+    std::vector<AString> keys;
+    sp<AMessage> format = makeFormat(state.range(0), &keys);
+    std::vector<AMessage::Key> atoms;
+    for (const AString &key : keys) {
+        atoms.emplace_back(key.c_str());
+    }
+
+    size_t ix = 0;
+    int32_t value;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(format->findInt32(atoms[ix], &value));
+        if (++ix == atoms.size()) {
+            ix = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Looks up the keys of a typical video track format, as done on codec configure, either by
+// name or through build-time Keys.
+static void BM_AMessage_ConfigureLookups(benchmark::State &state) {
+    static constexpr const char *kNames[] = {
+        "mime", "width", "height", "durationUs", "bitrate", "max-bitrate", "frame-rate",
+        "rotation-degrees", "color-format", "color-range", "color-standard", "color-transfer",
+        "max-input-size", "sar-width", "sar-height", "csd-0", "csd-1", "language",
+    };
+    static constexpr AMessage::Key kKeys[] = {
+        AMessage::Key("mime"), AMessage::Key("width"), AMessage::Key("height"),
+        AMessage::Key("durationUs"), AMessage::Key("bitrate"), AMessage::Key("max-bitrate"),
+        AMessage::Key("frame-rate"), AMessage::Key("rotation-degrees"),
+        AMessage::Key("color-format"), AMessage::Key("color-range"),
+        AMessage::Key("color-standard"), AMessage::Key("color-transfer"),
+        AMessage::Key("max-input-size"), AMessage::Key("sar-width"),
+        AMessage::Key("sar-height"), AMessage::Key("csd-0"), AMessage::Key("csd-1"),
+        AMessage::Key("language"),
+    };
+    const bool useKeys = state.range(0);
+
+    sp<AMessage> format = new AMessage;
+    for (size_t i = 0; i < 12; ++i) {
+        format->setInt32(kNames[i], (int32_t)i);
+    }
+
+    int32_t value;
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < sizeof(kNames) / sizeof(kNames[0]); ++i) {
+            if (useKeys) {
+                benchmark::DoNotOptimize(format->findInt32(kKeys[i], &value));
+            } else {
+                benchmark::DoNotOptimize(format->findInt32(kNames[i], &value));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (sizeof(kNames) / sizeof(kNames[0])));
+}
+
+static void BM_AMessage_SetString(benchmark::State &state) {
+    std::vector<AString> keys;
+    sp<AMessage> format = makeFormat(state.range(0), &keys);
+
+    size_t ix = 0;
+    while (state.KeepRunning()) {
+        format->setString(keys[ix].c_str(), "video/avc");
+        if (++ix == keys.size()) {
+            ix = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_AMessage_Build(benchmark::State &state) {
+    std::vector<AString> keys;
+    makeFormat(state.range(0), &keys);
+
+    while (state.KeepRunning()) {
+        sp<AMessage> format = new AMessage;
+        for (const AString &key : keys) {
+            format->setInt32(key.c_str(), 0);
+        }
+        benchmark::DoNotOptimize(format.get());
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+BENCHMARK(BM_AMessage_FindInt32)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_AMessage_FindInt32Key)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_AMessage_ConfigureLookups)->Arg(0)->Arg(1);
+BENCHMARK(BM_AMessage_FindMissing)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_AMessage_SetString)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_AMessage_Build)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK_MAIN();
@@ -24,6 +24,7 @@
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/foundation/AHandler.h>
 #include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AString.h>
 
 using namespace android;
 
@@ -169,6 +170,87 @@ TEST(AMessage_tests, settersAndGetters) {
   EXPECT_NE(OK, m1->removeEntryByName("notpresent"));
 }
 
+TEST(AMessage_tests, findsItemsByKey) {
+  static constexpr AMessage::Key kWidth("width");
+  static_assert(kWidth.mLength == 5, "Key length is computed at compile time");
+
+  sp<AMessage> m1 = new AMessage();
+  m1->setInt32("width", 1920);
+  m1->setString(AMessage::Key("mime"), "video/avc");
+
+  int32_t i32;
+  EXPECT_TRUE(m1->findInt32(kWidth, &i32));
+  EXPECT_EQ(1920, i32);
+  EXPECT_TRUE(m1->contains(kWidth));
+  EXPECT_FALSE(m1->contains(AMessage::Key("height")));
+
+  AString str;
+  EXPECT_TRUE(m1->findString("mime", &str));
+  EXPECT_STREQ("video/avc", str.c_str());
+  EXPECT_FALSE(m1->findString(kWidth, &str));
+
+  // setting through a Key overwrites the entry set by name
+  m1->setInt32(kWidth, 1280);
+  EXPECT_EQ(2, m1->countEntries());
+  EXPECT_TRUE(m1->findInt32("width", &i32));
+  EXPECT_EQ(1280, i32);
+}
+
+TEST(AMessage_tests, findsItemsInLargeMessages) {
+  sp<AMessage> m1 = new AMessage();
+
+  // enough entries for the message to switch to its hashed name index
+  for (int32_t i = 0; i < 64; ++i) {
+    m1->setInt32(AStringPrintf("key-%d", i).c_str(), i);
+  }
+  EXPECT_EQ(64, m1->countEntries());
+
+  int32_t i32;
+  for (int32_t i = 0; i < 64; ++i) {
+    EXPECT_TRUE(m1->findInt32(AStringPrintf("key-%d", i).c_str(), &i32));
+    EXPECT_EQ(i, i32);
+  }
+  EXPECT_FALSE(m1->findInt32("key-64", &i32));
+
+  // overwriting an existing key must not add an entry
+  m1->setString("key-10", "ten");
+  EXPECT_EQ(64, m1->countEntries());
+  AString str;
+  EXPECT_TRUE(m1->findString("key-10", &str));
+  EXPECT_STREQ("ten", str.c_str());
+
+  // removal moves the last entry into the freed slot
+  EXPECT_EQ(OK, m1->removeEntryByName("key-20"));
+  EXPECT_FALSE(m1->findInt32("key-20", &i32));
+  EXPECT_TRUE(m1->findInt32("key-63", &i32));
+  EXPECT_EQ(63, i32);
+
+  // renaming
+  size_t index = m1->findEntryByName("key-30");
+  EXPECT_EQ(OK, m1->setEntryNameAt(index, "renamed"));
+  EXPECT_FALSE(m1->findInt32("key-30", &i32));
+  EXPECT_TRUE(m1->findInt32("renamed", &i32));
+  EXPECT_EQ(30, i32);
+  EXPECT_EQ(ALREADY_EXISTS, m1->setEntryNameAt(index, "key-31"));
+
+  sp<AMessage> m2 = m1->dup();
+  EXPECT_EQ(m1->countEntries(), m2->countEntries());
+  EXPECT_TRUE(m2->findInt32("renamed", &i32));
+  EXPECT_EQ(30, i32);
+  EXPECT_TRUE(m2->findInt32("key-63", &i32));
+  EXPECT_EQ(63, i32);
+
+  // shrinking back below the index threshold
+  while (m2->countEntries() > 2) {
+    EXPECT_EQ(OK, m2->removeEntryAt(0));
+  }
+  AMessage::Type type;
+  for (size_t i = 0; i < m2->countEntries(); ++i) {
+    const char *name = m2->getEntryNameAt(i, &type);
+    EXPECT_EQ(i, m2->findEntryByName(name));
+  }
+}
+
 TEST(AMessage_tests, deliversMultipleMessagesInOrderImmediately) {
   sp<NiceMock<MockHandler>> mockHandler = new NiceMock<MockHandler>;
   sp<LooperWithSettableClock> looper = new LooperWithSettableClock();
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <media/stagefright/foundation/avc_utils.h>
+
+using namespace android;
+
+namespace {
+
+// Builds an Annex B access unit resembling a 4K frame: parameter sets, an
+// SEI and |numSlices| slices of incompressible payload with emulation
+// prevention applied, so start codes only occur at NAL boundaries.
+std::vector<uint8_t> makeAccessUnit(size_t auSize, size_t numSlices) {
+    std::minstd_rand random(auSize);
+    std::vector<uint8_t> au;
+    auto appendNAL = [&](uint8_t header, size_t size) {
+        static const uint8_t kStartCode[] = { 0x00, 0x00, 0x00, 0x01 };
+        au.insert(au.end(), kStartCode, kStartCode + sizeof(kStartCode));
+        au.push_back(header);
+        size_t zeros = 0;
+        for (size_t i = 0; i < size; ++i) {
+            uint8_t byte = random() & 0xff;
+            if (zeros >= 2 && byte <= 0x03) {
+                au.push_back(0x03);
+                zeros = 0;
+            }
+            au.push_back(byte);
+            zeros = byte == 0x00 ? zeros + 1 : 0;
+        }
+    };
+    appendNAL(0x67, 16);    // SPS
+    appendNAL(0x68, 4);     // PPS
+    appendNAL(0x06, 32);    // SEI
+    for (size_t i = 0; i < numSlices; ++i) {
+        appendNAL(0x65, auSize / numSlices);
+    }
+    return au;
+}
+
+}  // namespace
+
+static void BM_GetNextNALUnit(benchmark::State &state) {
+    std::vector<uint8_t> au = makeAccessUnit(state.range(0), state.range(1));
+
+    while (state.KeepRunning()) {
+        const uint8_t *data = au.data();
+        size_t size = au.size();
+        const uint8_t *nalStart;
+        size_t nalSize;
+        size_t numNALs = 0;
+        while (getNextNALUnit(&data, &size, &nalStart, &nalSize, true) == OK) {
+            ++numNALs;
+        }
+        benchmark::DoNotOptimize(numNALs);
+    }
+    state.SetBytesProcessed(state.iterations() * au.size());
+}
+
+static void BM_IsIDR(benchmark::State &state) {
+    std::vector<uint8_t> au = makeAccessUnit(state.range(0), state.range(1));
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(IsIDR(au.data(), au.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * au.size());
+}
+
+// 4K I-frame with 1 and 8 slices, and a typical 4K P-frame.
+BENCHMARK(BM_GetNextNALUnit)->ArgPair(512 * 1024, 1)->ArgPair(512 * 1024, 8)->ArgPair(64 * 1024, 4);
+BENCHMARK(BM_IsIDR)->ArgPair(512 * 1024, 1)->ArgPair(64 * 1024, 4);
+
+BENCHMARK_MAIN();
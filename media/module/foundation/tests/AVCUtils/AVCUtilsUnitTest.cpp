@@ -349,6 +349,27 @@ TEST_P(AVCFrameTest, FrameTest) {
     }
 }
 
+TEST(AVCUtilsStartCodeTest, FindNextStartCodeTest) {
+    const uint8_t data[] = {0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x65, 0x01, 0x00, 0x00, 0x01};
+
+    ASSERT_EQ(findNextStartCode(data, sizeof(data)), data + 3);
+    ASSERT_EQ(findNextStartCode(data + 4, sizeof(data) - 4), data + 8);
+    ASSERT_EQ(findNextStartCode(data + 9, sizeof(data) - 9), nullptr);
+    ASSERT_EQ(findNextStartCode(data, 5), nullptr);
+    ASSERT_EQ(findNextStartCode(data, 0), nullptr);
+
+    // NAL units are delimited by the start codes found
+    const uint8_t *buffer = data;
+    size_t size = sizeof(data);
+    const uint8_t *nalStart;
+    size_t nalSize;
+    ASSERT_EQ(getNextNALUnit(&buffer, &size, &nalStart, &nalSize, true), OK);
+    ASSERT_EQ(nalStart, data + 6);
+    ASSERT_EQ(nalSize, 2u);
+    // the trailing start code has no payload
+    ASSERT_NE(getNextNALUnit(&buffer, &size, &nalStart, &nalSize, true), OK);
+}
+
 INSTANTIATE_TEST_SUITE_P(AVCUtilsTestAll, MpegAudioUnitTest,
                          ::testing::Values(make_tuple(0xFFFB9204, 418, 44100, 2, 128, 1152),
                                            make_tuple(0xFFFB7604, 289, 48000, 2, 96, 1152),
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <media/stagefright/MediaBufferBase.h>
+#include <media/stagefright/MediaBufferGroup.h>
+
+using namespace android;
+
+namespace {
+
+// Small enough to stay below the shared memory threshold.
+constexpr size_t kBufferSize = 1024;
+constexpr int kOpsPerThread = 10000;
+
+}  // namespace
+
+// state.range(0) threads each acquire and release a buffer from a group of
+// state.range(1) buffers.
+static void BM_MediaBufferGroup_AcquireRelease(benchmark::State &state) {
+    const int numThreads = state.range(0);
+    const size_t numBuffers = state.range(1);
+
+    while (state.KeepRunning()) {
+        MediaBufferGroup group(numBuffers, kBufferSize, numBuffers);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&group] {
+                for (int i = 0; i < kOpsPerThread; ++i) {
+                    MediaBufferBase *buffer;
+                    if (group.acquire_buffer(&buffer) == OK) {
+                        buffer->release();
+                    }
+                }
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numThreads * kOpsPerThread);
+}
+
+// state.range(0) producer threads acquire buffers and hand them to as many
+// consumer threads, which release them. This is the extractor/decoder
+// pattern, where buffers are returned on a different thread.
+static void BM_MediaBufferGroup_ProducerConsumer(benchmark::State &state) {
+    const int numPairs = state.range(0);
+    const size_t numBuffers = state.range(1);
+
+    while (state.KeepRunning()) {
+        MediaBufferGroup group(numBuffers, kBufferSize, numBuffers);
+        std::mutex lock;
+        std::condition_variable cond;
+        std::deque<MediaBufferBase *> queue;
+        int producersLeft = numPairs;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numPairs; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < kOpsPerThread; ++i) {
+                    MediaBufferBase *buffer;
+                    if (group.acquire_buffer(&buffer) != OK) {
+                        continue;
+                    }
+                    std::lock_guard<std::mutex> guard(lock);
+                    queue.push_back(buffer);
+                    cond.notify_one();
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                --producersLeft;
+                cond.notify_all();
+            });
+            threads.emplace_back([&] {
+                for (;;) {
+                    MediaBufferBase *buffer;
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        cond.wait(guard, [&] { return !queue.empty() || producersLeft == 0; });
+                        if (queue.empty()) {
+                            return;
+                        }
+                        buffer = queue.front();
+                        queue.pop_front();
+                    }
+                    buffer->release();
+                }
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numPairs * kOpsPerThread);
+}
+
+BENCHMARK(BM_MediaBufferGroup_AcquireRelease)
+        ->ArgPair(1, 4)->ArgPair(4, 4)->ArgPair(4, 16)->ArgPair(8, 4)->ArgPair(8, 32)
+        ->UseRealTime();
+BENCHMARK(BM_MediaBufferGroup_ProducerConsumer)
+        ->ArgPair(1, 4)->ArgPair(2, 8)->ArgPair(4, 4)->ArgPair(4, 16)
+        ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -243,6 +243,59 @@ TEST_F(MetaDataBaseUnitTest, RemoveKeyTest) {
     ASSERT_FALSE(status) << "Overwrite should be false since the metadata was cleared";
 }
 
+TEST_F(MetaDataBaseUnitTest, StorageSizeTest) {
+    MetaDataBase metaData;
+
+    // values of different sizes stored under the same key, in and out of line
+    const uint8_t small[4] = {1, 2, 3, 4};
+    uint8_t large[64];
+    for (size_t i = 0; i < sizeof(large); ++i) {
+        large[i] = i;
+    }
+    uint32_t type;
+    const void *data;
+    size_t size;
+
+    metaData.setData(kKeyCryptoIV, 0, large, sizeof(large));
+    ASSERT_TRUE(metaData.findData(kKeyCryptoIV, &type, &data, &size));
+    ASSERT_EQ(size, sizeof(large));
+    ASSERT_EQ(0, memcmp(data, large, sizeof(large)));
+
+    large[0] = 0xff;
+    metaData.setData(kKeyCryptoIV, 1, large, sizeof(large));
+    ASSERT_TRUE(metaData.findData(kKeyCryptoIV, &type, &data, &size));
+    ASSERT_EQ(type, 1u);
+    ASSERT_EQ(0, memcmp(data, large, sizeof(large)));
+
+    metaData.setData(kKeyCryptoIV, 0, small, sizeof(small));
+    ASSERT_TRUE(metaData.findData(kKeyCryptoIV, &type, &data, &size));
+    ASSERT_EQ(size, sizeof(small));
+    ASSERT_EQ(0, memcmp(data, small, sizeof(small)));
+
+    // keys inserted out of order stay reachable, also in copies and after clear()
+    metaData.setInt64(kKeyTime, kDurationUs);
+    metaData.setRect(kKeyCropRect, kLeft, kTop, kRight, kBottom);
+    metaData.setInt32(kKeyWidth, kWidth1);
+    MetaDataBase copy(metaData);
+    ASSERT_TRUE(metaData.remove(kKeyCryptoIV));
+
+    int64_t timeUs;
+    int32_t width, left, top, right, bottom;
+    ASSERT_TRUE(copy.findData(kKeyCryptoIV, &type, &data, &size));
+    ASSERT_TRUE(copy.findInt64(kKeyTime, &timeUs));
+    ASSERT_EQ(timeUs, kDurationUs);
+    ASSERT_TRUE(metaData.findRect(kKeyCropRect, &left, &top, &right, &bottom));
+    ASSERT_EQ(right, kRight);
+    ASSERT_TRUE(metaData.findInt32(kKeyWidth, &width));
+    ASSERT_EQ(width, kWidth1);
+
+    metaData.clear();
+    ASSERT_FALSE(metaData.hasData(kKeyTime));
+    metaData.setInt64(kKeyTime, 1);
+    ASSERT_TRUE(metaData.findInt64(kKeyTime, &timeUs));
+    ASSERT_EQ(timeUs, 1);
+}
+
 TEST_F(MetaDataBaseUnitTest, ConvertToStringTest) {
     std::unique_ptr<MetaDataBase> metaData(new MetaDataBase());
     ASSERT_NE(metaData, nullptr) << "Failed to create meta data";
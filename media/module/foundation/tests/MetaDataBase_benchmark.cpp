@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <media/stagefright/MetaDataBase.h>
+
+using namespace android;
+
+// The metadata an extractor attaches to every sample it reads.
+static void setSampleMeta(MetaDataBase &meta, int64_t timeUs) {
+    meta.setInt64(kKeyTime, timeUs);
+    meta.setInt64(kKeyDuration, 33333);
+    meta.setInt32(kKeyIsSyncFrame, (timeUs % 30) == 0);
+}
+
+static void BM_MetaDataBase_SampleCycle(benchmark::State &state) {
+    MetaDataBase meta;
+    int64_t timeUs = 0;
+    int64_t value;
+
+    while (state.KeepRunning()) {
+        meta.clear();
+        setSampleMeta(meta, timeUs++);
+        benchmark::DoNotOptimize(meta.findInt64(kKeyTime, &value));
+        benchmark::DoNotOptimize(meta.findInt64(kKeyDuration, &value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MetaDataBase_EncryptedSampleCycle(benchmark::State &state) {
+    MetaDataBase meta;
+    int64_t timeUs = 0;
+    const uint8_t iv[16] = {};
+    const uint8_t key[16] = {};
+    const size_t sizes[8] = {};
+    int64_t value;
+
+    while (state.KeepRunning()) {
+        meta.clear();
+        setSampleMeta(meta, timeUs++);
+        meta.setInt32(kKeyCryptoMode, 1);
+        meta.setData(kKeyCryptoIV, 0, iv, sizeof(iv));
+        meta.setData(kKeyCryptoKey, 0, key, sizeof(key));
+        meta.setData(kKeyPlainSizes, 0, sizes, sizeof(sizes));
+        meta.setData(kKeyEncryptedSizes, 0, sizes, sizeof(sizes));
+        benchmark::DoNotOptimize(meta.findInt64(kKeyTime, &value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MetaDataBase_FindInt64(benchmark::State &state) {
+    MetaDataBase meta;
+    for (int32_t i = 0; i < state.range(0); ++i) {
+        meta.setInt32('k000' + i, i);
+    }
+    meta.setInt64(kKeyTime, 0);
+    int64_t value;
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(meta.findInt64(kKeyTime, &value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MetaDataBase_SampleCycle);
+BENCHMARK(BM_MetaDataBase_EncryptedSampleCycle);
+BENCHMARK(BM_MetaDataBase_FindInt64)->Arg(4)->Arg(16)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -59,6 +59,7 @@ typedef hidl::memory::V1_0::IMemory TMemory;
     do { unsigned tmp = y; ALOGV(x, tmp); } while (0)
 
 static const size_t kTSPacketSize = 188;
+static const uint8_t kTSSyncByte = 0x47;
 
 struct ATSParser::Program : public RefBase {
     Program(ATSParser *parser, unsigned programNumber, unsigned programMapPID,
@@ -2003,8 +2004,56 @@ status_t ATSParser::feedTSPacket(const void *data, size_t size,
         return BAD_VALUE;
     }
 
-    ABitReader br((const uint8_t *)data, kTSPacketSize);
-    return parseTS(&br, event);
+    return parseTS((const uint8_t *)data, event);
+}
+
+// Returns the offset of the next byte at or after "offset" that starts a TS
+// packet, i.e. a sync byte followed by another one a packet later (if the
+// buffer extends that far), or size if there is none.
+static size_t findNextTSSync(const uint8_t *data, size_t offset, size_t size) {
+    while (offset < size) {
+        const uint8_t *sync = (const uint8_t *)memchr(
+                data + offset, kTSSyncByte, size - offset);
+        if (sync == NULL) {
+            return size;
+        }
+
+        offset = sync - data;
+        if (offset + kTSPacketSize >= size
+                || data[offset + kTSPacketSize] == kTSSyncByte) {
+            return offset;
+        }
+
+        ++offset;
+    }
+
+    return size;
+}
+
+status_t ATSParser::feedTSPackets(
+        const void *data, size_t size, size_t *consumed) {
+    const uint8_t *ptr = (const uint8_t *)data;
+
+    size_t offset = 0;
+    status_t err = OK;
+    while (size - offset >= kTSPacketSize) {
+        if (ptr[offset] != kTSSyncByte) {
+            size_t next = findNextTSSync(ptr, offset + 1, size);
+            ALOGW("lost TS sync, skipping %zu bytes", next - offset);
+            offset = next;
+            continue;
+        }
+
+        err = parseTS(ptr + offset, NULL /* event */);
+        if (err != OK) {
+            break;
+        }
+
+        offset += kTSPacketSize;
+    }
+
+    *consumed = offset;
+    return err;
 }
 
 status_t ATSParser::setMediaCas(const sp<ICas> &cas) {
@@ -2346,52 +2395,52 @@ status_t ATSParser::parseAdaptationField(
     return OK;
 }
 
-status_t ATSParser::parseTS(ABitReader *br, SyncEvent *event) {
+status_t ATSParser::parseTS(const uint8_t *packet, SyncEvent *event) {
     ALOGV("---");
 
-    if (br->numBitsLeft() < 32) {
-        ALOGE("Not enough data left in bitreader!");
-        return ERROR_MALFORMED;
-    }
-    unsigned sync_byte = br->getBits(8);
-    if (sync_byte != 0x47u) {
+    // The 4 byte packet header is decoded directly, only the remainder of
+    // the packet goes through the bit reader.
+    unsigned sync_byte = packet[0];
+    if (sync_byte != kTSSyncByte) {
         ALOGE("[error] parseTS: return error as sync_byte=0x%x", sync_byte);
         return BAD_VALUE;
     }
 
-    if (br->getBits(1)) {  // transport_error_indicator
+    if (packet[1] & 0x80) {  // transport_error_indicator
         // silently ignore.
         return OK;
     }
 
-    unsigned payload_unit_start_indicator = br->getBits(1);
+    unsigned payload_unit_start_indicator = (packet[1] >> 6) & 1;
     ALOGV("payload_unit_start_indicator = %u", payload_unit_start_indicator);
 
-    MY_LOGV("transport_priority = %u", br->getBits(1));
+    MY_LOGV("transport_priority = %u", (packet[1] >> 5) & 1);
 
-    unsigned PID = br->getBits(13);
+    unsigned PID = ((packet[1] & 0x1f) << 8) | packet[2];
     ALOGV("PID = 0x%04x", PID);
 
-    unsigned transport_scrambling_control = br->getBits(2);
+    unsigned transport_scrambling_control = packet[3] >> 6;
     ALOGV("transport_scrambling_control = %u", transport_scrambling_control);
 
-    unsigned adaptation_field_control = br->getBits(2);
+    unsigned adaptation_field_control = (packet[3] >> 4) & 3;
     ALOGV("adaptation_field_control = %u", adaptation_field_control);
 
-    unsigned continuity_counter = br->getBits(4);
+    unsigned continuity_counter = packet[3] & 0x0f;
     ALOGV("PID = 0x%04x, continuity_counter = %u", PID, continuity_counter);
 
     // ALOGI("PID = 0x%04x, continuity_counter = %u", PID, continuity_counter);
 
+    ABitReader br(packet + 4, kTSPacketSize - 4);
+
     status_t err = OK;
 
     unsigned random_access_indicator = 0;
     if (adaptation_field_control == 2 || adaptation_field_control == 3) {
-        err = parseAdaptationField(br, PID, &random_access_indicator);
+        err = parseAdaptationField(&br, PID, &random_access_indicator);
     }
     if (err == OK) {
         if (adaptation_field_control == 1 || adaptation_field_control == 3) {
-            err = parsePID(br, PID, continuity_counter,
+            err = parsePID(&br, PID, continuity_counter,
                     payload_unit_start_indicator,
                     transport_scrambling_control,
                     random_access_indicator,
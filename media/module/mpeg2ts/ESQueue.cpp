@@ -34,6 +34,7 @@
 #include <media/hardware/CryptoAPI.h>
 
 #include <inttypes.h>
+#include <algorithm>
 #include <netinet/in.h>
 
 #ifdef ENABLE_CRYPTO
@@ -46,6 +47,7 @@ ElementaryStreamQueue::ElementaryStreamQueue(Mode mode, uint32_t flags)
     : mMode(mode),
       mFlags(flags),
       mEOSReached(false),
+      mSliceEnd(0),
       mCASystemId(0),
       mAUIndex(0) {
 
@@ -96,6 +98,26 @@ void ElementaryStreamQueue::setCasInfo(
     mCasSessionId = sessionId;
 }
 
+// Drops the first "size" bytes of the queued data. Rather than moving the
+// remaining data to the front of the buffer after every access unit, only
+// the buffer's range is advanced; appending data reclaims the space once it
+// runs out of room at the end. The range is only rewound while no access
+// units refer to the buffer's memory.
+static void dropFrontBytes(const sp<ABuffer> &buffer, size_t size) {
+    if (size == buffer->size() && !buffer->hasSlices()) {
+        buffer->setRange(0, 0);
+        return;
+    }
+
+    buffer->setRange(buffer->offset() + size, buffer->size() - size);
+}
+
+sp<ABuffer> ElementaryStreamQueue::sliceAccessUnit(size_t offset, size_t size) {
+    sp<ABuffer> accessUnit = mBuffer->slice(offset, size);
+    mSliceEnd = std::max(mSliceEnd, mBuffer->offset() + offset + size);
+    return accessUnit;
+}
+
 static int32_t readVariableBits(ABitReader &bits, int32_t nbits) {
     int32_t value = 0;
     int32_t more_bits = 1;
@@ -1162,7 +1184,18 @@ status_t ElementaryStreamQueue::appendData(
     }
 
     size_t neededSize = (mBuffer == NULL ? 0 : mBuffer->size()) + size;
-    if (mBuffer == NULL || neededSize > mBuffer->capacity()) {
+    bool sliced = false;
+    if (mBuffer != NULL) {
+        if (!mBuffer->hasSlices()) {
+            mSliceEnd = 0;
+        }
+        // Access units handed out as slices still refer to the bytes below mSliceEnd; rather
+        // than compacting over them or writing after a reset of the range, move the queued
+        // data to a new buffer.
+        sliced = mSliceEnd > 0 && (mBuffer->offset() < mSliceEnd
+                || mBuffer->offset() + neededSize > mBuffer->capacity());
+    }
+    if (mBuffer == NULL || neededSize > mBuffer->capacity() || sliced) {
         neededSize = (neededSize + 65535) & ~65535;
 
         ALOGV("resizing buffer to size %zu", neededSize);
@@ -1176,10 +1209,16 @@ status_t ElementaryStreamQueue::appendData(
         }
 
         mBuffer = buffer;
+        mSliceEnd = 0;
+    } else if (mBuffer->offset() + neededSize > mBuffer->capacity()) {
+        // Dequeued data is only skipped over, reclaim the space in front of
+        // the remaining data now that it is needed.
+        memmove(mBuffer->base(), mBuffer->data(), mBuffer->size());
+        mBuffer->setRange(0, mBuffer->size());
     }
 
     memcpy(mBuffer->data() + mBuffer->size(), data, size);
-    mBuffer->setRange(0, mBuffer->size() + size);
+    mBuffer->setRange(mBuffer->offset(), mBuffer->size() + size);
 
     RangeInfo info;
     info.mLength = size;
@@ -1222,9 +1261,13 @@ void ElementaryStreamQueue::appendScrambledData(
         }
 
         mScrambledBuffer = buffer;
+    } else if (mScrambledBuffer->offset() + neededSize > mScrambledBuffer->capacity()) {
+        memmove(mScrambledBuffer->base(), mScrambledBuffer->data(), mScrambledBuffer->size());
+        mScrambledBuffer->setRange(0, mScrambledBuffer->size());
     }
     memcpy(mScrambledBuffer->data() + mScrambledBuffer->size(), data, size);
-    mScrambledBuffer->setRange(0, mScrambledBuffer->size() + size);
+    mScrambledBuffer->setRange(
+            mScrambledBuffer->offset(), mScrambledBuffer->size() + size);
 
     ScrambledRangeInfo scrambledInfo;
     scrambledInfo.mLength = size;
@@ -1359,11 +1402,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueScrambledAccessUnit() {
     scrambledAccessUnit->meta()->setBuffer("encBytes", encSizes);
     scrambledAccessUnit->meta()->setInt32("pesOffset", pesOffset);
 
-    memmove(mScrambledBuffer->data(),
-            mScrambledBuffer->data() + scrambledLength,
-            mScrambledBuffer->size() - scrambledLength);
-
-    mScrambledBuffer->setRange(0, mScrambledBuffer->size() - scrambledLength);
+    dropFrontBytes(mScrambledBuffer, scrambledLength);
 
     ALOGV("[stream %d] dequeued scrambled AU: timeUs=%lld, size=%zu",
             mMode, (long long)timeUs, scrambledAccessUnit->size());
@@ -1384,15 +1423,10 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnit() {
         RangeInfo info = *mRangeInfos.begin();
         mRangeInfos.erase(mRangeInfos.begin());
 
-        sp<ABuffer> accessUnit = new ABuffer(info.mLength);
-        memcpy(accessUnit->data(), mBuffer->data(), info.mLength);
+        sp<ABuffer> accessUnit = sliceAccessUnit(0, info.mLength);
         accessUnit->meta()->setInt64("timeUs", info.mTimestampUs);
 
-        memmove(mBuffer->data(),
-                mBuffer->data() + info.mLength,
-                mBuffer->size() - info.mLength);
-
-        mBuffer->setRange(0, mBuffer->size() - info.mLength);
+        dropFrontBytes(mBuffer, info.mLength);
 
         if (mFormat == NULL) {
             mFormat = new MetaData;
@@ -1473,18 +1507,12 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitDTSOrDTSHD() {
     }
     mAUIndex++;
 
-    sp<ABuffer> accessUnit = new ABuffer(syncStartPos + payloadSize);
-    memcpy(accessUnit->data(), mBuffer->data(), syncStartPos + payloadSize);
+    sp<ABuffer> accessUnit = sliceAccessUnit(0, syncStartPos + payloadSize);
 
     accessUnit->meta()->setInt64("timeUs", timeUs);
     accessUnit->meta()->setInt32("isSync", 1);
 
-    memmove(
-        mBuffer->data(),
-        mBuffer->data() + syncStartPos + payloadSize,
-        mBuffer->size() - syncStartPos - payloadSize);
-
-    mBuffer->setRange(0, mBuffer->size() - syncStartPos - payloadSize);
+    dropFrontBytes(mBuffer, syncStartPos + payloadSize);
 
     return accessUnit;
 }
@@ -1527,18 +1555,12 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitDTSUHD()
     }
     mAUIndex++;
 
-    sp<ABuffer> accessUnit = new ABuffer(syncStartPos + payloadSize);
-    memcpy(accessUnit->data(), mBuffer->data(), syncStartPos + payloadSize);
+    sp<ABuffer> accessUnit = sliceAccessUnit(0, syncStartPos + payloadSize);
 
     accessUnit->meta()->setInt64("timeUs", timeUs);
     accessUnit->meta()->setInt32("isSync", 1);
 
-    memmove(
-        mBuffer->data(),
-        mBuffer->data() + syncStartPos + payloadSize,
-        mBuffer->size() - syncStartPos - payloadSize);
-
-    mBuffer->setRange(0, mBuffer->size() - syncStartPos - payloadSize);
+    dropFrontBytes(mBuffer, syncStartPos + payloadSize);
 
     return accessUnit;
 }
@@ -1599,18 +1621,12 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitEAC3() {
     }
     mAUIndex++;
 
-    sp<ABuffer> accessUnit = new ABuffer(syncStartPos + payloadSize);
-    memcpy(accessUnit->data(), mBuffer->data(), syncStartPos + payloadSize);
+    sp<ABuffer> accessUnit = sliceAccessUnit(0, syncStartPos + payloadSize);
 
     accessUnit->meta()->setInt64("timeUs", timeUs);
     accessUnit->meta()->setInt32("isSync", 1);
 
-    memmove(
-            mBuffer->data(),
-            mBuffer->data() + syncStartPos + payloadSize,
-            mBuffer->size() - syncStartPos - payloadSize);
-
-    mBuffer->setRange(0, mBuffer->size() - syncStartPos - payloadSize);
+    dropFrontBytes(mBuffer, syncStartPos + payloadSize);
 
     return accessUnit;
 }
@@ -1663,18 +1679,12 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitAC4() {
     }
     mAUIndex++;
 
-    sp<ABuffer> accessUnit = new ABuffer(syncStartPos + payloadSize);
-    memcpy(accessUnit->data(), mBuffer->data(), syncStartPos + payloadSize);
+    sp<ABuffer> accessUnit = sliceAccessUnit(0, syncStartPos + payloadSize);
 
     accessUnit->meta()->setInt64("timeUs", timeUs);
     accessUnit->meta()->setInt32("isSync", 1);
 
-    memmove(
-            mBuffer->data(),
-            mBuffer->data() + syncStartPos + payloadSize,
-            mBuffer->size() - syncStartPos - payloadSize);
-
-    mBuffer->setRange(0, mBuffer->size() - syncStartPos - payloadSize);
+    dropFrontBytes(mBuffer, syncStartPos + payloadSize);
     return accessUnit;
 }
 
@@ -1720,8 +1730,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitPCMAudio() {
         return NULL;
     }
 
-    sp<ABuffer> accessUnit = new ABuffer(payloadSize);
-    memcpy(accessUnit->data(), mBuffer->data() + 4, payloadSize);
+    sp<ABuffer> accessUnit = sliceAccessUnit(4, payloadSize);
 
     int64_t timeUs = fetchTimestamp(payloadSize + 4);
     if (timeUs < 0LL) {
@@ -1736,12 +1745,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitPCMAudio() {
         ptr[i] = ntohs(ptr[i]);
     }
 
-    memmove(
-            mBuffer->data(),
-            mBuffer->data() + 4 + payloadSize,
-            mBuffer->size() - 4 - payloadSize);
-
-    mBuffer->setRange(0, mBuffer->size() - 4 - payloadSize);
+    dropFrontBytes(mBuffer, 4 + payloadSize);
 
     return accessUnit;
 }
@@ -1882,12 +1886,9 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitAAC() {
 
     int64_t timeUs = fetchTimestamp(offset);
 
-    sp<ABuffer> accessUnit = new ABuffer(offset);
-    memcpy(accessUnit->data(), mBuffer->data(), offset);
+    sp<ABuffer> accessUnit = sliceAccessUnit(0, offset);
 
-    memmove(mBuffer->data(), mBuffer->data() + offset,
-            mBuffer->size() - offset);
-    mBuffer->setRange(0, mBuffer->size() - offset);
+    dropFrontBytes(mBuffer, offset);
 
     accessUnit->meta()->setInt64("timeUs", timeUs);
     accessUnit->meta()->setInt32("isSync", 1);
@@ -2072,11 +2073,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitH264() {
             const NALPosition &pos = nals.itemAt(nals.size() - 1);
             size_t nextScan = pos.nalOffset + pos.nalSize;
 
-            memmove(mBuffer->data(),
-                    mBuffer->data() + nextScan,
-                    mBuffer->size() - nextScan);
-
-            mBuffer->setRange(0, mBuffer->size() - nextScan);
+            dropFrontBytes(mBuffer, nextScan);
 
             int64_t timeUs = fetchTimestamp(nextScan);
             if (timeUs < 0LL) {
@@ -2155,14 +2152,9 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitMPEGAudio() {
 
     unsigned layer = 4 - ((header >> 17) & 3);
 
-    sp<ABuffer> accessUnit = new ABuffer(frameSize);
-    memcpy(accessUnit->data(), data, frameSize);
-
-    memmove(mBuffer->data(),
-            mBuffer->data() + frameSize,
-            mBuffer->size() - frameSize);
+    sp<ABuffer> accessUnit = sliceAccessUnit(0, frameSize);
 
-    mBuffer->setRange(0, mBuffer->size() - frameSize);
+    dropFrontBytes(mBuffer, frameSize);
 
     int64_t timeUs = fetchTimestamp(frameSize);
     if (timeUs < 0LL) {
@@ -2285,11 +2277,11 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitMPEGVideo() {
         currentStartCode = data[offset + 3];
 
         if (currentStartCode == 0xb3 && mFormat == NULL) {
-            memmove(mBuffer->data(), mBuffer->data() + offset, size - offset);
+            dropFrontBytes(mBuffer, offset);
+            data = mBuffer->data();
             size -= offset;
             (void)fetchTimestamp(offset);
             offset = 0;
-            mBuffer->setRange(0, size);
         }
 
         if ((prevStartCode == 0xb3 && currentStartCode != 0xb5)
@@ -2318,11 +2310,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitMPEGVideo() {
                 sp<ABuffer> csd = new ABuffer(offset);
                 memcpy(csd->data(), data, offset);
 
-                memmove(mBuffer->data(),
-                        mBuffer->data() + offset,
-                        mBuffer->size() - offset);
-
-                mBuffer->setRange(0, mBuffer->size() - offset);
+                dropFrontBytes(mBuffer, offset);
                 size -= offset;
                 (void)fetchTimestamp(offset);
                 offset = 0;
@@ -2358,14 +2346,9 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitMPEGVideo() {
             if (!sawPictureStart) {
                 sawPictureStart = true;
             } else {
-                sp<ABuffer> accessUnit = new ABuffer(offset);
-                memcpy(accessUnit->data(), data, offset);
-
-                memmove(mBuffer->data(),
-                        mBuffer->data() + offset,
-                        mBuffer->size() - offset);
+                sp<ABuffer> accessUnit = sliceAccessUnit(0, offset);
 
-                mBuffer->setRange(0, mBuffer->size() - offset);
+                dropFrontBytes(mBuffer, offset);
 
                 int64_t timeUs = fetchTimestamp(offset);
                 if (timeUs < 0LL) {
@@ -2557,12 +2540,10 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitMPEG4Video() {
 
                     offset += chunkSize;
 
-                    sp<ABuffer> accessUnit = new ABuffer(offset);
-                    memcpy(accessUnit->data(), data, offset);
+                    sp<ABuffer> accessUnit = sliceAccessUnit(0, offset);
 
-                    memmove(data, &data[offset], size - offset);
+                    dropFrontBytes(mBuffer, offset);
                     size -= offset;
-                    mBuffer->setRange(0, size);
 
                     int64_t timeUs = fetchTimestamp(offset);
                     if (timeUs < 0LL) {
@@ -2598,10 +2579,10 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitMPEG4Video() {
 
         if (discard) {
             (void)fetchTimestamp(offset);
-            memmove(data, &data[offset], size - offset);
+            dropFrontBytes(mBuffer, offset);
+            data = mBuffer->data();
             size -= offset;
             offset = 0;
-            mBuffer->setRange(0, size);
         } else {
             offset += chunkSize;
         }
@@ -122,6 +122,15 @@ struct ATSParser : public RefBase {
     status_t feedTSPacket(
             const void *data, size_t size, SyncEvent *event = NULL);
 
+    // Feed a buffer holding any number of TS packets into the parser.
+    // Packets are parsed in order, if the sync byte is lost the parser skips
+    // ahead to the next position that looks like a packet boundary.
+    // On return, *consumed holds the number of bytes that were parsed or
+    // skipped; a trailing partial packet is left for the next call.
+    // Parsing stops at the first packet that fails to parse, in which case
+    // *consumed is the offset of that packet.
+    status_t feedTSPackets(const void *data, size_t size, size_t *consumed);
+
     void signalDiscontinuity(
             DiscontinuityType type, const sp<AMessage> &extra);
 
@@ -248,8 +257,8 @@ private:
     status_t parseAdaptationField(
             ABitReader *br, unsigned PID, unsigned *random_access_indicator);
 
-    // see feedTSPacket().
-    status_t parseTS(ABitReader *br, SyncEvent *event);
+    // see feedTSPacket(). packet must point to kTSPacketSize bytes.
+    status_t parseTS(const uint8_t *packet, SyncEvent *event);
 
     void updatePCR(unsigned PID, uint64_t PCR, uint64_t byteOffsetFromStart);
 
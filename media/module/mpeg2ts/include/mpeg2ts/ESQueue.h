@@ -104,6 +104,9 @@ private:
 
     sp<ABuffer> mBuffer;
     List<RangeInfo> mRangeInfos;
+    // End of the last access unit handed out as a slice of mBuffer, relative to
+    // mBuffer->base(). Bytes below it must not be overwritten while slices are alive.
+    size_t mSliceEnd;
 
     sp<ABuffer> mScrambledBuffer;
     List<ScrambledRangeInfo> mScrambledRangeInfos;
@@ -119,6 +122,10 @@ private:
         return (mFlags & kFlag_SampleEncryptedData) != 0;
     }
 
+    // Returns |size| queued bytes starting at |offset| as an access unit that
+    // shares mBuffer's memory.
+    sp<ABuffer> sliceAccessUnit(size_t offset, size_t size);
+
     sp<ABuffer> dequeueAccessUnitH264();
     sp<ABuffer> dequeueAccessUnitAAC();
     sp<ABuffer> dequeueAccessUnitEAC3();
@@ -216,6 +216,75 @@ TEST_P(Mpeg2tsUnitTest, MediaInfoTest) {
     }
 }
 
+TEST_P(Mpeg2tsUnitTest, BatchFeedTest) {
+    // Deliberately not a multiple of the packet size so that partial packets
+    // get carried over between calls.
+    constexpr size_t kChunkSize = kTSPacketSize * 64 + 100;
+    uint8_t buffer[kChunkSize + kTSPacketSize];
+    size_t bufferSize = 0;
+    ssize_t numBytesRead = -1;
+
+    while ((numBytesRead = mSource->readAt(mOffset, buffer + bufferSize, kChunkSize)) > 0) {
+        mOffset += numBytesRead;
+        bufferSize += numBytesRead;
+
+        size_t consumed = 0;
+        status_t err = mParser->feedTSPackets(buffer, bufferSize, &consumed);
+        ASSERT_EQ(err, (status_t)OK) << "Unable to feed TS packets!";
+        ASSERT_LE(consumed, bufferSize) << "Consumed more data than available!";
+        ASSERT_LT(bufferSize - consumed, kTSPacketSize) << "Complete packets left unparsed!";
+
+        memmove(buffer, buffer + consumed, bufferSize - consumed);
+        bufferSize -= consumed;
+    }
+
+    ASSERT_EQ(mParser->hasSource(ATSParser::VIDEO), bool(mMediaType & kVideoPresent))
+            << "Video source mismatch!";
+    ASSERT_EQ(mParser->hasSource(ATSParser::AUDIO), bool(mMediaType & kAudioPresent))
+            << "Audio source mismatch!";
+    ASSERT_EQ(mParser->hasSource(ATSParser::META), bool(mMediaType & kMetaDataPresent))
+            << "Meta data source mismatch!";
+}
+
+// Garbage between packets is skipped and the packets after it are parsed, the
+// way feedTSPackets() recovers from a lost sync byte.
+TEST_P(Mpeg2tsUnitTest, BatchFeedResyncTest) {
+    constexpr size_t kPacketsPerChunk = 64;
+    constexpr size_t kJunkSize = 7;
+    constexpr size_t kChunkSize = kTSPacketSize * kPacketsPerChunk;
+    uint8_t buffer[kJunkSize + kChunkSize + kTSPacketSize];
+    size_t bufferSize = 0;
+    ssize_t numBytesRead = -1;
+
+    for (;;) {
+        // 0xFF never matches the sync byte, so all of the junk must be skipped.
+        memset(buffer + bufferSize, 0xFF, kJunkSize);
+        bufferSize += kJunkSize;
+        numBytesRead = mSource->readAt(mOffset, buffer + bufferSize, kChunkSize);
+        if (numBytesRead <= 0) {
+            break;
+        }
+        mOffset += numBytesRead;
+        bufferSize += numBytesRead;
+
+        size_t consumed = 0;
+        status_t err = mParser->feedTSPackets(buffer, bufferSize, &consumed);
+        ASSERT_EQ(err, (status_t)OK) << "Unable to feed TS packets after junk!";
+        ASSERT_LE(consumed, bufferSize) << "Consumed more data than available!";
+        ASSERT_LT(bufferSize - consumed, kTSPacketSize) << "Complete packets left unparsed!";
+
+        memmove(buffer, buffer + consumed, bufferSize - consumed);
+        bufferSize -= consumed;
+    }
+
+    ASSERT_EQ(mParser->hasSource(ATSParser::VIDEO), bool(mMediaType & kVideoPresent))
+            << "Video source mismatch!";
+    ASSERT_EQ(mParser->hasSource(ATSParser::AUDIO), bool(mMediaType & kAudioPresent))
+            << "Audio source mismatch!";
+    ASSERT_EQ(mParser->hasSource(ATSParser::META), bool(mMediaType & kMetaDataPresent))
+            << "Meta data source mismatch!";
+}
+
 INSTANTIATE_TEST_SUITE_P(
         infoTest, Mpeg2tsUnitTest,
         ::testing::Values(make_tuple("crowd_1920x1080_25fps_6700kbps_h264.ts", 0x01, 1),
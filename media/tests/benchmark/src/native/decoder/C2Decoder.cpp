@@ -51,6 +51,10 @@ int32_t C2Decoder::createCodec2Component(string compName, AMediaFormat *format)
         C2StreamPictureSizeInfo::input inputSize(0u, width, height);
         configParam.push_back(&inputSize);
     }
+    C2ProcessBatchSizeTuning batchSize(mProcessBatchSize);
+    if (mProcessBatchSize > 1) {
+        configParam.push_back(&batchSize);
+    }
 
     int64_t sTime = mStats->getCurTime();
     if (mClient->CreateComponentByName(compName.c_str(), mListener, &mComponent, &mClient) !=
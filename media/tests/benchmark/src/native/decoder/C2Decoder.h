@@ -23,7 +23,11 @@
 
 class C2Decoder : public BenchmarkC2Common {
   public:
-    C2Decoder() : mOffset(0), mNumInputFrame(0), mComponent(nullptr) {}
+    C2Decoder() : mOffset(0), mNumInputFrame(0), mProcessBatchSize(1), mComponent(nullptr) {}
+
+    // Asks the component to return completed work in batches of up to |batchSize|. Must be
+    // called before createCodec2Component().
+    void setProcessBatchSize(uint32_t batchSize) { mProcessBatchSize = batchSize; }
 
     int32_t createCodec2Component(string codecName, AMediaFormat *format);
 
@@ -39,6 +43,7 @@ class C2Decoder : public BenchmarkC2Common {
   private:
     int32_t mOffset;
     int32_t mNumInputFrame;
+    uint32_t mProcessBatchSize;
     vector<AMediaCodecBufferInfo> mFrameMetaData;
 
     std::shared_ptr<android::Codec2Client::Listener> mListener;
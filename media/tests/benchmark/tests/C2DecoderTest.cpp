@@ -61,6 +61,39 @@ void C2DecoderTest::setupC2DecoderTest() {
     ASSERT_GT(mCodecList.size(), 0) << "Codec2 client didn't recognise any component";
 }
 
+// Copies the CSD and frame samples of the current track of |extractor| to |inputBuffer|.
+static void readSamples(Extractor *extractor, uint8_t *inputBuffer, size_t bufferSize,
+                        vector<AMediaCodecBufferInfo> *frameInfo) {
+    AMediaCodecBufferInfo info;
+    uint32_t inputBufferOffset = 0;
+    int32_t idx = 0;
+
+    // Get CSD data
+    while (1) {
+        void *csdBuffer = extractor->getCSDSample(info, idx);
+        if (!csdBuffer || !info.size) break;
+        // copy the meta data and buffer to be passed to decoder
+        ASSERT_LE(inputBufferOffset + info.size, bufferSize) << "Memory allocated not sufficient";
+
+        memcpy(inputBuffer + inputBufferOffset, csdBuffer, info.size);
+        frameInfo->push_back(info);
+        inputBufferOffset += info.size;
+        idx++;
+    }
+
+    // Get frame data
+    while (1) {
+        int32_t status = extractor->getFrameSample(info);
+        if (status || !info.size) break;
+        // copy the meta data and buffer to be passed to decoder
+        ASSERT_LE(inputBufferOffset + info.size, bufferSize) << "Memory allocated not sufficient";
+
+        memcpy(inputBuffer + inputBufferOffset, extractor->getFrameBuf(), info.size);
+        frameInfo->push_back(info);
+        inputBufferOffset += info.size;
+    }
+}
+
 TEST_P(C2DecoderTest, Codec2Decode) {
     ALOGV("Decode the samples given by extractor using codec2");
     string inputFile = gEnv->getRes() + GetParam().first;
@@ -90,34 +123,8 @@ TEST_P(C2DecoderTest, Codec2Decode) {
         ASSERT_NE(inputBuffer, nullptr) << "Insufficient memory";
 
         vector<AMediaCodecBufferInfo> frameInfo;
-        AMediaCodecBufferInfo info;
-        uint32_t inputBufferOffset = 0;
-        int32_t idx = 0;
-
-        // Get CSD data
-        while (1) {
-            void *csdBuffer = extractor->getCSDSample(info, idx);
-            if (!csdBuffer || !info.size) break;
-            // copy the meta data and buffer to be passed to decoder
-            ASSERT_LE(inputBufferOffset + info.size, fileSize) << "Memory allocated not sufficient";
-
-            memcpy(inputBuffer.get() + inputBufferOffset, csdBuffer, info.size);
-            frameInfo.push_back(info);
-            inputBufferOffset += info.size;
-            idx++;
-        }
-
-        // Get frame data
-        while (1) {
-            status = extractor->getFrameSample(info);
-            if (status || !info.size) break;
-            // copy the meta data and buffer to be passed to decoder
-            ASSERT_LE(inputBufferOffset + info.size, fileSize) << "Memory allocated not sufficient";
-
-            memcpy(inputBuffer.get() + inputBufferOffset, extractor->getFrameBuf(), info.size);
-            frameInfo.push_back(info);
-            inputBufferOffset += info.size;
-        }
+        ASSERT_NO_FATAL_FAILURE(
+                readSamples(extractor.get(), inputBuffer.get(), fileSize, &frameInfo));
 
         AMediaFormat *format = extractor->getFormat();
         // Decode the given input stream for all C2 codecs supported by device
@@ -149,6 +156,76 @@ TEST_P(C2DecoderTest, Codec2Decode) {
     }
 }
 
+// Decodes small-frame audio with the components returning several works per callback, to
+// compare against Codec2Decode, which completes one work per callback.
+class C2DecoderBatchTest
+    : public ::testing::TestWithParam<std::tuple<pair<string, string>, uint32_t>> {};
+
+TEST_P(C2DecoderBatchTest, Codec2BatchedDecode) {
+    const pair<string, string> &clip = std::get<0>(GetParam());
+    uint32_t batchSize = std::get<1>(GetParam());
+    string inputFile = gEnv->getRes() + clip.first;
+    FILE *inputFp = fopen(inputFile.c_str(), "rb");
+    ASSERT_NE(inputFp, nullptr) << "Unable to open " << inputFile << " file for reading";
+
+    std::unique_ptr<Extractor> extractor(new (std::nothrow) Extractor());
+    ASSERT_NE(extractor, nullptr) << "Extractor creation failed";
+
+    struct stat buf;
+    stat(inputFile.c_str(), &buf);
+    size_t fileSize = buf.st_size;
+    ASSERT_LE(fileSize, kMaxBufferSize)
+            << "Input file size is greater than the threshold memory dedicated to the test";
+
+    int32_t trackCount = extractor->initExtractor(fileno(inputFp), fileSize);
+    ASSERT_GT(trackCount, 0) << "initExtractor failed";
+    int32_t status = extractor->setupTrackFormat(0);
+    ASSERT_EQ(status, 0) << "Track Format invalid";
+
+    std::unique_ptr<uint8_t[]> inputBuffer(new (std::nothrow) uint8_t[fileSize]);
+    ASSERT_NE(inputBuffer, nullptr) << "Insufficient memory";
+    vector<AMediaCodecBufferInfo> frameInfo;
+    ASSERT_NO_FATAL_FAILURE(
+            readSamples(extractor.get(), inputBuffer.get(), fileSize, &frameInfo));
+
+    std::unique_ptr<C2Decoder> decoder(new (std::nothrow) C2Decoder());
+    ASSERT_NE(decoder, nullptr) << "C2Decoder creation failed";
+    ASSERT_EQ(decoder->setupCodec2(), 0) << "Codec2 setup failed";
+    decoder->setProcessBatchSize(batchSize);
+
+    for (const string &codecName : decoder->getSupportedComponentList(false /* isEncoder */)) {
+        if (codecName.find(clip.second) == string::npos ||
+            codecName.find("secure") != string::npos) {
+            continue;
+        }
+        status = decoder->createCodec2Component(codecName, extractor->getFormat());
+        ASSERT_EQ(status, 0) << "Create component failed for " << codecName;
+
+        status = decoder->decodeFrames(inputBuffer.get(), frameInfo);
+        ASSERT_EQ(status, 0) << "Decoder failed for " << codecName;
+
+        decoder->waitOnInputConsumption();
+        ASSERT_TRUE(decoder->mEos) << "Test Failed. Didn't receive EOS \n";
+
+        decoder->deInitCodec();
+        decoder->dumpStatistics(clip.first, extractor->getClipDuration(),
+                                codecName + "-batch" + std::to_string(batchSize),
+                                gEnv->getStatsFile());
+        decoder->resetDecoder();
+    }
+    fclose(inputFp);
+    extractor->deInitExtractor();
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        SmallFrameAudioDecoderTest, C2DecoderBatchTest,
+        ::testing::Combine(
+                ::testing::Values(make_pair(string("bbb_8000hz_1ch_8kbps_amrnb_30sec.3gp"),
+                                            string("amrnb")),
+                                  make_pair(string("bbb_48000hz_2ch_100kbps_opus_30sec.webm"),
+                                            string("opus"))),
+                ::testing::Values(1u, 4u, 8u)));
+
 // TODO: (b/140549596)
 // Add wav files
 INSTANTIATE_TEST_SUITE_P(
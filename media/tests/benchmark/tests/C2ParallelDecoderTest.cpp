@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "C2ParallelDecoderTest"
+
+#include <memory>
+#include <thread>
+
+#include "BenchmarkTestEnvironment.h"
+#include "C2Decoder.h"
+#include "Extractor.h"
+
+static BenchmarkTestEnvironment *gEnv = nullptr;
+
+// Decodes the same clip on several codec2 components at once, as a media.swcodec process
+// serving many concurrent audio sessions does. Comparing runs with
+// debug.codec2.sw_shared_executor set and unset shows the cost of one looper thread per
+// software component against the shared executor.
+class C2ParallelDecoderTest
+    : public ::testing::TestWithParam<std::tuple<string, string, int32_t>> {};
+
+TEST_P(C2ParallelDecoderTest, Codec2ParallelDecode) {
+    string inputFile = gEnv->getRes() + std::get<0>(GetParam());
+    string codecSuffix = std::get<1>(GetParam());
+    int32_t numStreams = std::get<2>(GetParam());
+
+    FILE *inputFp = fopen(inputFile.c_str(), "rb");
+    ASSERT_NE(inputFp, nullptr) << "Unable to open " << inputFile << " file for reading";
+
+    std::unique_ptr<Extractor> extractor(new (std::nothrow) Extractor());
+    ASSERT_NE(extractor, nullptr) << "Extractor creation failed";
+
+    struct stat buf;
+    stat(inputFile.c_str(), &buf);
+    size_t fileSize = buf.st_size;
+    int32_t fd = fileno(inputFp);
+
+    ASSERT_LE(fileSize, kMaxBufferSize)
+            << "Input file size is greater than the threshold memory dedicated to the test";
+
+    int32_t trackCount = extractor->initExtractor(fd, fileSize);
+    ASSERT_GT(trackCount, 0) << "initExtractor failed";
+    int32_t status = extractor->setupTrackFormat(0);
+    ASSERT_EQ(status, 0) << "Track Format invalid";
+
+    std::unique_ptr<uint8_t[]> inputBuffer(new (std::nothrow) uint8_t[fileSize]);
+    ASSERT_NE(inputBuffer, nullptr) << "Insufficient memory";
+
+    vector<AMediaCodecBufferInfo> frameInfo;
+    AMediaCodecBufferInfo info;
+    uint32_t inputBufferOffset = 0;
+    for (int32_t idx = 0;; ++idx) {
+        void *csdBuffer = extractor->getCSDSample(info, idx);
+        if (!csdBuffer || !info.size) break;
+        ASSERT_LE(inputBufferOffset + info.size, fileSize) << "Memory allocated not sufficient";
+        memcpy(inputBuffer.get() + inputBufferOffset, csdBuffer, info.size);
+        frameInfo.push_back(info);
+        inputBufferOffset += info.size;
+    }
+    while (1) {
+        status = extractor->getFrameSample(info);
+        if (status || !info.size) break;
+        ASSERT_LE(inputBufferOffset + info.size, fileSize) << "Memory allocated not sufficient";
+        memcpy(inputBuffer.get() + inputBufferOffset, extractor->getFrameBuf(), info.size);
+        frameInfo.push_back(info);
+        inputBufferOffset += info.size;
+    }
+
+    std::vector<std::unique_ptr<C2Decoder>> decoders;
+    string codecName;
+    for (int32_t i = 0; i < numStreams; ++i) {
+        decoders.emplace_back(new (std::nothrow) C2Decoder());
+        ASSERT_NE(decoders.back(), nullptr) << "C2Decoder creation failed";
+        ASSERT_EQ(decoders.back()->setupCodec2(), 0) << "Codec2 setup failed";
+        if (codecName.empty()) {
+            for (const string &name : decoders.back()->getSupportedComponentList(false)) {
+                if (name.find(codecSuffix) != string::npos &&
+                    name.find("secure") == string::npos) {
+                    codecName = name;
+                    break;
+                }
+            }
+            if (codecName.empty()) {
+                GTEST_SKIP() << "No decoder for " << codecSuffix;
+            }
+        }
+        status = decoders.back()->createCodec2Component(codecName, extractor->getFormat());
+        ASSERT_EQ(status, 0) << "Create component failed for " << codecName;
+    }
+
+    std::vector<int32_t> results(numStreams, 0);
+    std::vector<std::thread> threads;
+    // Times the whole set, from the first queued input to the last stream reaching EOS.
+    Stats parallelStats;
+    parallelStats.setStartTime();
+    for (int32_t i = 0; i < numStreams; ++i) {
+        threads.emplace_back([&, i] {
+            results[i] = decoders[i]->decodeFrames(inputBuffer.get(), frameInfo);
+            decoders[i]->waitOnInputConsumption();
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    parallelStats.addOutputTime();
+    parallelStats.addFrameSize(inputBufferOffset * numStreams);
+
+    int64_t durationUs = extractor->getClipDuration();
+    for (int32_t i = 0; i < numStreams; ++i) {
+        EXPECT_EQ(results[i], 0) << "Decoder " << i << " failed for " << codecName;
+        EXPECT_TRUE(decoders[i]->mEos) << "Decoder " << i << " didn't receive EOS";
+        decoders[i]->deInitCodec();
+        decoders[i]->dumpStatistics(std::get<0>(GetParam()), durationUs, codecName,
+                                    gEnv->getStatsFile());
+    }
+    ALOGV("%s: %d streams decoded in %lld ms", codecName.c_str(), numStreams,
+          (long long)(parallelStats.getTotalTime() / 1000000));
+    parallelStats.dumpStatistics("c2paralleldecode", std::get<0>(GetParam()),
+                                 durationUs * numStreams,
+                                 codecName + "x" + std::to_string(numStreams), "async",
+                                 gEnv->getStatsFile());
+
+    fclose(inputFp);
+    extractor->deInitExtractor();
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        AacDecoderTest, C2ParallelDecoderTest,
+        ::testing::Combine(::testing::Values(string("bbb_44100hz_2ch_128kbps_aac_30sec.mp4")),
+                           ::testing::Values(string("aac")), ::testing::Values(1, 4, 16, 32)));
+
+INSTANTIATE_TEST_SUITE_P(
+        OpusDecoderTest, C2ParallelDecoderTest,
+        ::testing::Combine(::testing::Values(string("bbb_48000hz_2ch_100kbps_opus_30sec.webm")),
+                           ::testing::Values(string("opus")), ::testing::Values(1, 4, 16, 32)));
+
+int main(int argc, char **argv) {
+    gEnv = new (std::nothrow) BenchmarkTestEnvironment();
+    ::testing::AddGlobalTestEnvironment(gEnv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int status = gEnv->initFromOptions(argc, argv);
+    if (status == 0) {
+        gEnv->setStatsFile("C2ParallelDecoder.csv");
+        status = gEnv->writeStatsHeader();
+        ALOGV("Stats file = %d\n", status);
+        status = RUN_ALL_TESTS();
+        ALOGV("C2 Parallel Decoder Test result = %d\n", status);
+    }
+    return status;
+}
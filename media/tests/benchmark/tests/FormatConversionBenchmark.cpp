@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures convertMetaDataToMessage() and convertMessageToMetaData(), which run on every
+// track open and codec configure.
+
+#include <benchmark/benchmark.h>
+
+#include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/MetaData.h>
+#include <media/stagefright/Utils.h>
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/AMessage.h>
+
+using namespace android;
+
+namespace {
+
+// avcC with one SPS and one PPS (Baseline profile, level 3.0)
+const uint8_t kAvcc[] = {
+    0x01, 0x42, 0xc0, 0x1e, 0xff, 0xe1,
+    0x00, 0x0a, 0x67, 0x42, 0xc0, 0x1e, 0xda, 0x02, 0x80, 0xbf, 0xe5, 0x84,
+    0x01,
+    0x00, 0x04, 0x68, 0xce, 0x3c, 0x80,
+};
+
+// AudioSpecificConfig for AAC-LC, 44.1 kHz, stereo
+const uint8_t kAacCsd[] = { 0x12, 0x10 };
+
+sp<MetaData> makeVideoMeta() {
+    sp<MetaData> meta = new MetaData;
+    meta->setCString(kKeyMIMEType, MEDIA_MIMETYPE_VIDEO_AVC);
+    meta->setInt32(kKeyWidth, 1920);
+    meta->setInt32(kKeyHeight, 1080);
+    meta->setInt32(kKeyDisplayWidth, 1920);
+    meta->setInt32(kKeyDisplayHeight, 1080);
+    meta->setInt64(kKeyDuration, 60000000ll);
+    meta->setInt32(kKeyBitRate, 8000000);
+    meta->setInt32(kKeyFrameRate, 30);
+    meta->setInt32(kKeyRotation, 90);
+    meta->setInt32(kKeyMaxInputSize, 1 << 20);
+    meta->setInt32(kKeyTrackID, 1);
+    meta->setInt32(kKeyColorRange, 2);
+    meta->setInt32(kKeyColorPrimaries, 1);
+    meta->setInt32(kKeyTransferFunction, 3);
+    meta->setInt32(kKeyColorMatrix, 1);
+    meta->setCString(kKeyMediaLanguage, "und");
+    meta->setData(kKeyAVCC, kTypeAVCC, kAvcc, sizeof(kAvcc));
+    return meta;
+}
+
+sp<MetaData> makeAudioMeta() {
+    sp<MetaData> meta = new MetaData;
+    meta->setCString(kKeyMIMEType, MEDIA_MIMETYPE_AUDIO_AAC);
+    meta->setInt32(kKeyChannelCount, 2);
+    meta->setInt32(kKeySampleRate, 44100);
+    meta->setInt32(kKeyBitsPerSample, 16);
+    meta->setInt32(kKeyAACAOT, 2);
+    meta->setInt64(kKeyDuration, 60000000ll);
+    meta->setInt32(kKeyBitRate, 128000);
+    meta->setInt32(kKeyMaxInputSize, 8192);
+    meta->setInt32(kKeyTrackID, 2);
+    meta->setCString(kKeyMediaLanguage, "eng");
+    meta->setData(kKeyOpaqueCSD0, 0, kAacCsd, sizeof(kAacCsd));
+    return meta;
+}
+
+sp<MetaData> makeMeta(int64_t type) {
+    return type == 0 ? makeVideoMeta() : makeAudioMeta();
+}
+
+void setLabel(benchmark::State &state) {
+    state.SetLabel(state.range(0) == 0 ? "video/avc" : "audio/aac");
+}
+
+}  // namespace
+
+static void BM_ConvertMetaDataToMessage(benchmark::State &state) {
+    sp<MetaData> meta = makeMeta(state.range(0));
+
+    while (state.KeepRunning()) {
+        sp<AMessage> format;
+        if (convertMetaDataToMessage(meta, &format) != OK) {
+            state.SkipWithError("convertMetaDataToMessage failed");
+            break;
+        }
+        benchmark::DoNotOptimize(format.get());
+    }
+    setLabel(state);
+}
+
+static void BM_ConvertMessageToMetaData(benchmark::State &state) {
+    sp<AMessage> format;
+    if (convertMetaDataToMessage(makeMeta(state.range(0)), &format) != OK) {
+        state.SkipWithError("convertMetaDataToMessage failed");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        sp<MetaData> meta = new MetaData;
+        if (convertMessageToMetaData(format, meta) != OK) {
+            state.SkipWithError("convertMessageToMetaData failed");
+            break;
+        }
+        benchmark::DoNotOptimize(meta.get());
+    }
+    setLabel(state);
+}
+
+BENCHMARK(BM_ConvertMetaDataToMessage)->Arg(0)->Arg(1);
+BENCHMARK(BM_ConvertMessageToMetaData)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();